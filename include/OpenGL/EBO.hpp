@@ -7,7 +7,9 @@ class EBO {
     public:
         GLuint ID;
 
-        EBO(GLuint* indicies, GLsizeiptr size) {
+        GLenum indexType;
+
+        EBO(const void* indicies, GLsizeiptr size, GLenum indexType = GL_UNSIGNED_INT) : indexType(indexType) {
             glGenBuffers(1, &ID);
             glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ID);
             glBufferData(GL_ELEMENT_ARRAY_BUFFER, size, indicies, GL_STATIC_DRAW);
@@ -0,0 +1,46 @@
+#ifndef SSBO_CLASS_HEADER
+#define SSBO_CLASS_HEADER
+
+#include <glad/glad.h>
+
+class SSBO {
+    public:
+        GLuint ID;
+        GLsizeiptr size = 0;
+
+        SSBO(GLsizeiptr size = 0, const void* data = nullptr, GLenum usage = GL_DYNAMIC_DRAW) : usage(usage) {
+            glGenBuffers(1, &ID);
+            allocate(size, data);
+        }
+
+        void bind(GLuint bindingPoint) const {
+            glBindBufferBase(GL_SHADER_STORAGE_BUFFER, bindingPoint, ID);
+        }
+
+        // replaces the whole contents; storage only gets reallocated when it has to grow
+        void upload(GLsizeiptr dataSize, const void* data) {
+            if (dataSize > size) {
+                allocate(dataSize, data);
+                return;
+            }
+
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, ID);
+            glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, dataSize, data);
+        }
+
+        ~SSBO() {
+            glDeleteBuffers(1, &ID);
+        }
+
+    private:
+        GLenum usage;
+
+        void allocate(GLsizeiptr newSize, const void* data) {
+            size = newSize;
+
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, ID);
+            glBufferData(GL_SHADER_STORAGE_BUFFER, size, data, usage);
+        }
+};
+
+#endif // SSBO_CLASS_HEADER
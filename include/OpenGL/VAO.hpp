@@ -13,14 +13,20 @@ class VAO {
             glGenVertexArrays(1, &ID);
         }
 
-        void linkAttrib(VBO& VBO, GLuint layout, GLuint numComponents, GLenum type, GLsizeiptr stride, void* offset) {
+        // normalized -> integer types are mapped to [0, 1] / [-1, 1] instead of being converted as they are
+        void linkAttrib(VBO& VBO, GLuint layout, GLuint numComponents, GLenum type, GLsizeiptr stride, void* offset, GLboolean normalized = GL_FALSE) {
             VBO.bind();
             // stride => number of bytes per vertex
-            glVertexAttribPointer(layout, numComponents, type, GL_FALSE, stride, offset);
+            glVertexAttribPointer(layout, numComponents, type, normalized, stride, offset);
             glEnableVertexAttribArray(layout);
             VBO.unbind();
         }
 
+        // divisor 1 -> attribute advances once per instance instead of once per vertex
+        void setAttribDivisor(GLuint layout, GLuint divisor) {
+            glVertexAttribDivisor(layout, divisor);
+        }
+
         void bind() {
             glBindVertexArray(ID);
         }
@@ -6,11 +6,18 @@
 class VBO {
     public:
         GLuint ID;
+        GLenum usage;
         
-        VBO(GLfloat* vertices, GLsizeiptr size) {
+        VBO(const void* vertices, GLsizeiptr size, GLenum usage = GL_STATIC_DRAW) : usage(usage) {
             glGenBuffers(1, &ID);
             glBindBuffer(GL_ARRAY_BUFFER, ID);
-            glBufferData(GL_ARRAY_BUFFER, size, vertices, GL_STATIC_DRAW);
+            glBufferData(GL_ARRAY_BUFFER, size, vertices, usage);
+        }
+
+        // re-specifies the whole buffer; the old storage gets orphaned so the driver doesn't have to wait for it
+        void update(const void* data, GLsizeiptr size) {
+            glBindBuffer(GL_ARRAY_BUFFER, ID);
+            glBufferData(GL_ARRAY_BUFFER, size, data, usage);
         }
 
         void bind() {
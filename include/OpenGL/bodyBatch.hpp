@@ -0,0 +1,88 @@
+#ifndef BODY_BATCH_CLASS_HEADER
+#define BODY_BATCH_CLASS_HEADER
+
+#include <vector>
+#include <cstddef>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <VAO.hpp>
+#include <VBO.hpp>
+#include <shader.hpp>
+
+// per-body data shared by the impostor and point tiers
+struct BodyInstance {
+    glm::vec4 body;      // xyz - center (vertex units), w - radius
+    glm::vec4 color;     // rgb - surface color, a - 1.0 for emissive bodies (stars)
+};
+
+/**
+ * @brief Collects bodies that are too small on screen for a mesh and draws all of them in a single call.
+ *
+ * Impostor batches draw an instanced camera-facing quad per body (corners come from gl_VertexID),
+ * point batches draw one point per body.
+ */
+class BodyBatch {
+    public:
+        enum Type {
+            impostors,
+            points
+        };
+
+        std::vector<BodyInstance> instances;
+
+        BodyBatch(Type type) : type(type) {
+            vao = new VAO();
+            vbo = new VBO(nullptr, 0, GL_STREAM_DRAW);
+
+            vao->bind();
+            vao->linkAttrib(*vbo, 0, 4, GL_FLOAT, sizeof(BodyInstance), (void*)offsetof(BodyInstance, body));
+            vao->linkAttrib(*vbo, 1, 4, GL_FLOAT, sizeof(BodyInstance), (void*)offsetof(BodyInstance, color));
+
+            if (type == Type::impostors) {
+                vao->setAttribDivisor(0, 1);
+                vao->setAttribDivisor(1, 1);
+            }
+            vao->unbind();
+        }
+
+        void clear() { instances.clear(); }
+
+        static BodyInstance instance(const glm::vec3& position, const float& radius, const glm::vec3& color, const bool& emissive) {
+            return { glm::vec4(position, radius), glm::vec4(color, emissive ? 1.0f : 0.0f) };
+        }
+
+        void add(const glm::vec3& position, const float& radius, const glm::vec3& color, const bool& emissive) {
+            instances.push_back(instance(position, radius, color, emissive));
+        }
+
+        void draw(Shader* shader) {
+            if (instances.empty()) { return; }
+
+            shader->activate();
+
+            vbo->update(instances.data(), instances.size() * sizeof(BodyInstance));
+
+            vao->bind();
+            if (type == Type::impostors) { glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, instances.size()); }
+            else { glDrawArrays(GL_POINTS, 0, instances.size()); }
+            vao->unbind();
+        }
+
+        ~BodyBatch() {
+            delete vao;
+            delete vbo;
+
+            vao = nullptr;
+            vbo = nullptr;
+        }
+
+    private:
+        Type type;
+
+        VAO* vao;
+        VBO* vbo;
+};
+
+#endif // BODY_BATCH_CLASS_HEADER
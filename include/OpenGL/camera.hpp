@@ -42,6 +42,12 @@ class Camera {
             this->position = position;
         }
 
+        // matrices only - the render thread hands them to the shaders with the frame
+        void updateMatrices() {
+            viewMatrix = glm::lookAt(position, position + orientation, UP);
+            projectionMatrix = glm::perspective(glm::radians(FOVdeg), width/(float)height, nearClipPlane, farClipPlane);
+        }
+
         void updateProjection(Shader* shader) {
             shader->activate();
 
@@ -0,0 +1,148 @@
+#ifndef PROGRAM_BINARY_CACHE_HEADER
+#define PROGRAM_BINARY_CACHE_HEADER
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <glad/glad.h>
+
+#include <hash.hpp>
+
+/**
+ * @brief Keeps linked programs on disk (glGetProgramBinary) so later launches can skip the driver compile.
+ *
+ * Binaries are keyed by the final module sources (includes resolved, defines injected) together with the
+ * driver's vendor, renderer and version - a driver update or a shader edit simply produces a new key.
+ * Binaries the driver refuses (e.g. after a driver update with the same version string) are ignored.
+ */
+class ProgramBinaryCache {
+    public:
+        std::filesystem::path directory;
+
+        unsigned int hits = 0, misses = 0;
+
+        ProgramBinaryCache(const std::filesystem::path& directory) : directory(directory) {
+            GLint formatCount = 0;
+            glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+
+            std::error_code error;
+            std::filesystem::create_directories(directory, error);
+
+            supported = formatCount > 0 && !error;
+
+            for (GLenum name : { GL_VENDOR, GL_RENDERER, GL_VERSION }) {
+                const GLubyte* value = glGetString(name);
+                if (value) { driver += (const char*)value; }
+                driver += '\n';
+            }
+        }
+
+        bool isSupported() const { return supported; }
+
+        uint64_t makeKey(const std::vector<std::string>& moduleSources) const {
+            uint64_t key = fnv1a(driver);
+            for (const auto& source : moduleSources) {
+                key = fnv1a(source, key);
+            }
+            return key;
+        }
+
+        // returns 0 when there is no usable binary - the program has to be compiled from source then
+        GLuint load(const uint64_t& key) {
+            std::ifstream file(binaryPath(key), std::ios::binary);
+            if (!supported || !file.is_open()) {
+                misses++;
+                return 0;
+            }
+
+            Header header;
+            file.read((char*)&header, sizeof(Header));
+
+            if (!file || std::memcmp(header.magic, MAGIC, sizeof(header.magic)) != 0 || header.version != VERSION || header.key != key) {
+                misses++;
+                return 0;
+            }
+
+            std::vector<char> binary(header.size);
+            file.read(binary.data(), binary.size());
+
+            if (!file) {
+                misses++;
+                return 0;
+            }
+
+            GLuint program = glCreateProgram();
+            glProgramBinary(program, header.format, binary.data(), binary.size());
+
+            int success;
+            glGetProgramiv(program, GL_LINK_STATUS, &success);
+            if (!success) {
+                glDeleteProgram(program);
+                misses++;
+                return 0;
+            }
+
+            hits++;
+            return program;
+        }
+
+        // the program has to be linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT set
+        void store(const uint64_t& key, const GLuint& program) {
+            if (!supported) { return; }
+
+            GLint length = 0;
+            glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+            if (length <= 0) { return; }
+
+            Header header;
+            std::memcpy(header.magic, MAGIC, sizeof(header.magic));
+            header.version = VERSION;
+            header.key = key;
+
+            std::vector<char> binary(length);
+            glGetProgramBinary(program, length, nullptr, &header.format, binary.data());
+            header.size = length;
+
+            // written next to the final file first - a crash mid-write never leaves a truncated binary behind
+            std::filesystem::path path = binaryPath(key), temporaryPath = path;
+            temporaryPath += ".tmp";
+            {
+                std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+                if (!file.is_open()) { return; }
+
+                file.write((const char*)&header, sizeof(Header));
+                file.write(binary.data(), binary.size());
+                if (!file) { return; }
+            }
+
+            std::error_code error;
+            std::filesystem::rename(temporaryPath, path, error);
+        }
+
+    private:
+        static constexpr char MAGIC[4] = { 'S', 'P', 'B', 'C' };
+        static constexpr uint32_t VERSION = 1;
+
+        struct Header {
+            char magic[4];
+            uint32_t version;
+            uint64_t key;
+            GLenum format;
+            uint32_t size;
+        };
+
+        bool supported = false;
+        std::string driver;
+
+        std::filesystem::path binaryPath(const uint64_t& key) const {
+            char name[17];
+            std::snprintf(name, sizeof(name), "%016llx", (unsigned long long)key);
+            return directory / (std::string(name) + ".bin");
+        }
+};
+
+#endif // PROGRAM_BINARY_CACHE_HEADER
@@ -0,0 +1,196 @@
+#ifndef RENDER_THREAD_CLASS_HEADER
+#define RENDER_THREAD_CLASS_HEADER
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <GLFW/glfw3.h>
+
+/**
+ * @brief Thread owning the GL context - draws the frames the main thread hands over, one frame behind it.
+ *
+ * The main thread keeps GLFW events, input and everything the frame is built from; the render thread only sees
+ * the packets. Anything else that needs the context goes through post() (runs before the next frame) or invoke()
+ * (waits for it). Before start() and after stop() everything runs on the calling thread, which then holds the context.
+ *
+ * Packets come back through recycle() once drawn, so their buffers are reused and they are never freed on the render thread.
+ */
+template <typename Packet>
+class RenderThread {
+    public:
+        using DrawFunction = std::function<void(Packet&)>;
+
+        RenderThread() = default;
+        RenderThread(const RenderThread&) = delete;
+        RenderThread& operator=(const RenderThread&) = delete;
+
+        // the context moves from the calling thread to the render thread
+        void start(GLFWwindow* window, DrawFunction draw) {
+            if (active()) { return; }
+
+            this->window = window;
+            this->draw = std::move(draw);
+
+            running = true;
+
+            glfwMakeContextCurrent(nullptr);
+            thread = std::thread([this]() { work(); });
+        }
+
+        // tasks already posted still run, a frame that wasn't picked up yet is dropped; the context comes back to the calling thread
+        void stop() {
+            if (!active()) { return; }
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                running = false;
+            }
+            changed.notify_all();
+
+            thread.join();
+            glfwMakeContextCurrent(window);
+
+            spares.clear();
+            queued = false;
+        }
+
+        bool active() const { return thread.joinable(); }
+        bool onRenderThread() const { return std::this_thread::get_id() == thread.get_id(); }
+
+        // a drawn packet to build the next frame into - its contents are left as they were
+        Packet recycle() {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (spares.empty()) { return Packet(); }
+
+            Packet packet = std::move(spares.back());
+            spares.pop_back();
+
+            return packet;
+        }
+
+        // waits while the previous frame hasn't been picked up yet - the main thread is never more than one frame ahead
+        void submit(Packet&& packet) {
+            if (!active()) {
+                draw(packet);
+                spares.push_back(std::move(packet));
+                return;
+            }
+
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                changed.wait(lock, [this]() { return !queued; });
+
+                pending = std::move(packet);
+                queued = true;
+            }
+            changed.notify_all();
+        }
+
+        // runs on the render thread before the next frame is drawn
+        void post(std::function<void()> task) {
+            if (!active() || onRenderThread()) {
+                task();
+                return;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                tasks.push_back(std::move(task));
+                postedTasks++;
+            }
+            changed.notify_all();
+        }
+
+        /**
+         * @brief Runs the task on the render thread and waits for it.
+         *
+         * The frame in flight is finished first and the one waiting to be picked up is dropped - it was built from
+         * state the task may change or free. The next frame is built after the task, so nothing is lost but one frame's latency.
+         */
+        void invoke(std::function<void()> task) {
+            if (!active() || onRenderThread()) {
+                task();
+                return;
+            }
+
+            std::unique_lock<std::mutex> lock(mutex);
+
+            if (queued) {
+                spares.push_back(std::move(pending));
+                queued = false;
+            }
+
+            tasks.push_back(std::move(task));
+            uint64_t ticket = ++postedTasks;
+
+            changed.notify_all();
+            changed.wait(lock, [this, ticket]() { return finishedTasks >= ticket; });
+        }
+
+        ~RenderThread() { stop(); }
+
+    private:
+        GLFWwindow* window = nullptr;
+        DrawFunction draw;
+
+        std::thread thread;
+
+        std::mutex mutex;
+        std::condition_variable changed;
+        bool running = false;
+
+        Packet pending;
+        bool queued = false;
+        std::vector<Packet> spares; // drawn or dropped, waiting to be reused by the main thread
+
+        std::vector<std::function<void()>> tasks;
+        uint64_t postedTasks = 0, finishedTasks = 0;
+
+        void work() {
+            glfwMakeContextCurrent(window);
+
+            std::vector<std::function<void()>> ready;
+
+            while (true) {
+                std::unique_lock<std::mutex> lock(mutex);
+                changed.wait(lock, [this]() { return !running || queued || !tasks.empty(); });
+
+                if (!tasks.empty()) {
+                    ready.swap(tasks);
+
+                    lock.unlock();
+                    for (auto& task : ready) { task(); }
+                    lock.lock();
+
+                    finishedTasks += ready.size();
+                    ready.clear();
+
+                    lock.unlock();
+                    changed.notify_all();
+                    continue;
+                }
+
+                if (!running) { break; }
+
+                Packet frame = std::move(pending);
+                queued = false;
+
+                lock.unlock();
+                changed.notify_all();
+
+                draw(frame);
+
+                lock.lock();
+                spares.push_back(std::move(frame));
+            }
+
+            glfwMakeContextCurrent(nullptr);
+        }
+};
+
+#endif // RENDER_THREAD_CLASS_HEADER
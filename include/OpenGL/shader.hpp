@@ -13,19 +13,31 @@
 #include <sstream>
 #include <fstream>
 #include <string>
+#include <map>
 #include <unordered_map>
 
 // custom libraries
 #include <FormatConsole.hpp>
+#include <programCache.hpp>
 #include <paths.hpp>
 
 #include <json.hpp> // external library - likely to cause an error if used separately
 
+// GL_KHR_parallel_shader_compile isn't part of the generated loader
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+// preprocessor definitions injected right after '#version' in every module of a variant (name -> value)
+using ShaderDefines = std::map<std::string, std::string>;
+
 class Shader {
 	public:
 
 		GLuint ID;
 
+		ShaderDefines defines; // of the currently selected variant
+
 		std::unordered_map<const char*, int> otherUniforms;
 
 		int modelMatrixUniform, projectionMatrixUniform, viewMatrixUniform;
@@ -36,23 +48,109 @@ class Shader {
 		glm::mat4 viewMatrix = glm::mat4(1.0f);
 		glm::mat4 projectionMatrix = glm::mat4(1.0f);
 
-		Shader(const std::filesystem::path& vertexFilepath, const std::filesystem::path& fragmentFilepath, bool throwErrors = false, const char* modelMatrixUniformName = "model", const char* viewMatrixUniformName = "view", const char* projectionMatrixUniformName = "projection") {
-			ID = makeShader(vertexFilepath, fragmentFilepath);
+		Shader(const std::filesystem::path& vertexFilepath, const std::filesystem::path& fragmentFilepath, const ShaderDefines& defines = {}, bool throwErrors = false, const char* modelMatrixUniformName = "model", const char* viewMatrixUniformName = "view", const char* projectionMatrixUniformName = "projection")
+			: vertexFilepath(vertexFilepath), fragmentFilepath(fragmentFilepath), modelMatrixUniformName(modelMatrixUniformName), viewMatrixUniformName(viewMatrixUniformName), projectionMatrixUniformName(projectionMatrixUniformName) {
+			// only submitted to the driver here - the program gets checked and its uniforms looked up on first activation
+			ID = compileVariant(defines);
+			this->defines = defines;
+		}
+
+		// compiles a variant ahead of time so selecting it later doesn't stall
+		void precompileVariant(const ShaderDefines& variantDefines) {
+			compileVariant(variantDefines);
+		}
+
+		/**
+		 * @brief Switches to the program built with the given defines, compiling it on first use.
+		 *
+		 * Uniforms live in the program, so anything that isn't set every frame has to be set again after a switch
+		 * (the view and projection matrices are taken care of here).
+		 *
+		 * @return Whether the active program changed.
+		 */
+		bool selectVariant(const ShaderDefines& variantDefines) {
+			GLuint program = compileVariant(variantDefines);
+			if (program == ID) { return false; }
 
-			hasModelMatrixUniform = hasProjectionMatrixUniform = hasViewMatrixUniform = false;
+			ID = program;
+			defines = variantDefines;
+
+			otherUniforms.clear();
+			linked = false;
 
 			activate();
+			applyViewMatrix();
+			applyProjectionMatrix();
 
-			modelMatrixUniform = glGetUniformLocation(ID, modelMatrixUniformName);
-			if (modelMatrixUniform != -1) { hasModelMatrixUniform = true; }
+			return true;
+		}
 
-			viewMatrixUniform = glGetUniformLocation(ID, viewMatrixUniformName);
-			if (viewMatrixUniform != -1) { hasViewMatrixUniform = true; }
+		size_t variantCount() const { return variants.size(); }
 
-			projectionMatrixUniform = glGetUniformLocation(ID, projectionMatrixUniformName);
-			if (projectionMatrixUniform != -1) { hasProjectionMatrixUniform = true; }
+		// frees every variant except the active one - they get compiled again (or read from the binary cache) when selected
+		size_t releaseInactiveVariants() {
+			size_t released = 0;
+
+			for (auto variant = variants.begin(); variant != variants.end();) {
+				if (variant->second == ID) {
+					++variant;
+					continue;
+				}
+
+				auto pendingProgram = pending.find(variant->second);
+				if (pendingProgram != pending.end()) {
+					for (GLuint shaderModule : pendingProgram->second.modules) { glDeleteShader(shaderModule); }
+					pending.erase(pendingProgram);
+				}
+
+				glDeleteProgram(variant->second);
+				variant = variants.erase(variant);
+				released++;
+			}
+
+			return released;
+		}
+
+		// driver memory of the finished variants, approximated by the size of their program binaries
+		size_t residentMemory() const {
+			size_t total = 0;
+			for (const auto& [name, program] : variants) {
+				if (pending.find(program) != pending.end()) { continue; } // querying would wait for the compile
+
+				GLint binaryLength = 0;
+				glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &binaryLength);
+				total += binaryLength;
+			}
+			return total;
+		}
+
+		// whether the driver is done with the program - always true without GL_KHR_parallel_shader_compile
+		bool isReady(GLuint program) const {
+			if (pending.find(program) == pending.end() || !parallelCompile) { return true; }
+
+			GLint completed = GL_TRUE;
+			glGetProgramiv(program, GL_COMPLETION_STATUS_KHR, &completed);
+			return completed == GL_TRUE;
 		}
 
+		// checks the variants the driver has finished in the background; returns whether any are still compiling
+		bool finishReadyVariants() {
+			std::vector<GLuint> ready;
+			for (const auto& [program, pendingProgram] : pending) {
+				if (isReady(program)) { ready.push_back(program); }
+			}
+
+			for (GLuint program : ready) { finishProgram(program); }
+
+			return !pending.empty();
+		}
+
+		// shared by all shaders, programs are compiled from source while it's not set
+		static inline ProgramBinaryCache* binaryCache = nullptr;
+
+		// set once GL_KHR_parallel_shader_compile is enabled - compiles run on driver threads
+		static inline bool parallelCompile = false;
+
 		GLuint getUniformID(const char* name, bool structMode) {
 			if (otherUniforms.find(name) == otherUniforms.end() || structMode) {
 				otherUniforms[name] = glGetUniformLocation(ID, name);
@@ -163,86 +261,236 @@ class Shader {
         }
 
 		void activate() {
+			if (!linked) { finishLink(); }
 			glUseProgram(ID);
 		}
 
 		~Shader() {
-			glDeleteProgram(ID);
+			for (const auto& [program, pendingProgram] : pending) {
+				for (GLuint shaderModule : pendingProgram.modules) { glDeleteShader(shaderModule); }
+			}
+
+			for (const auto& variant : variants) {
+				glDeleteProgram(variant.second);
+			}
 		}
 
 	private:
-		GLuint makeModule(const std::filesystem::path& filepath, GLuint module_type) {
-			std::ifstream file;
-			std::stringstream bufferedLines;
-		
-			if (debugMode) { std::cout << formatProcess("Compiling") << " module '" << formatPath(getFileName(filepath.string())) << "' ... "; }
-		
-			file.open(filepath);
-			if (file.is_open()) {
-				bufferedLines << file.rdbuf();
+		std::filesystem::path vertexFilepath, fragmentFilepath;
+		const char* modelMatrixUniformName;
+		const char* viewMatrixUniformName;
+		const char* projectionMatrixUniformName;
+
+		std::map<std::string, GLuint> variants; // compiled programs by their defines (see variantName)
+
+		// submitted programs whose compile / link status hasn't been checked yet
+		struct PendingProgram {
+			std::vector<GLuint> modules;
+			std::string description;
+			uint64_t cacheKey;
+			bool storeBinary;
+		};
+		std::unordered_map<GLuint, PendingProgram> pending;
+
+		bool linked = false; // whether the active program was checked and its matrix uniforms looked up
+
+		static std::string variantName(const ShaderDefines& variantDefines) {
+			std::string name;
+			for (const auto& [define, value] : variantDefines) {
+				name += (name.empty() ? "" : " ") + define + "=" + value;
 			}
-			else {
-				if (debugMode) { std::cout << formatError("FAILED") << "\n"; }
+			return name;
+		}
+
+		GLuint compileVariant(const ShaderDefines& variantDefines) {
+			std::string name = variantName(variantDefines);
+
+			auto found = variants.find(name);
+			if (found != variants.end()) { return found->second; }
+
+			GLuint program = makeShader(vertexFilepath, fragmentFilepath, variantDefines);
+			variants[name] = program;
+
+			return program;
+		}
+
+		void finishLink() {
+			linked = true;
+
+			if (pending.find(ID) != pending.end()) { finishProgram(ID); }
+			findMatrixUniforms();
+		}
+
+		void findMatrixUniforms() {
+			hasModelMatrixUniform = hasProjectionMatrixUniform = hasViewMatrixUniform = false;
+
+			modelMatrixUniform = glGetUniformLocation(ID, modelMatrixUniformName);
+			if (modelMatrixUniform != -1) { hasModelMatrixUniform = true; }
+
+			viewMatrixUniform = glGetUniformLocation(ID, viewMatrixUniformName);
+			if (viewMatrixUniform != -1) { hasViewMatrixUniform = true; }
+
+			projectionMatrixUniform = glGetUniformLocation(ID, projectionMatrixUniformName);
+			if (projectionMatrixUniform != -1) { hasProjectionMatrixUniform = true; }
+		}
+
+		// '#version' has to stay the first statement - definitions go on the line after it
+		std::string injectDefines(const std::string& source, const ShaderDefines& variantDefines) {
+			if (variantDefines.empty()) { return source; }
+
+			size_t version = source.find("#version");
+			size_t insertAt = (version == std::string::npos) ? 0 : source.find('\n', version);
+			insertAt = (insertAt == std::string::npos) ? source.size() : insertAt + 1;
+
+			std::string definitions;
+			for (const auto& [define, value] : variantDefines) {
+				definitions += "#define " + define + " " + value + "\n";
+			}
+
+			return source.substr(0, insertAt) + definitions + source.substr(insertAt);
+		}
+
+		// GLSL has no includes - replaces '#include "file"' lines with the file's contents (relative to the including file)
+		std::string resolveIncludes(const std::string& source, const std::filesystem::path& directory, const unsigned int depth = 0) {
+			if (depth > 8) {
+				std::cerr << formatError("ERROR") << ": shader includes nested too deep in '" << formatPath(directory.string()) << "'" << std::endl;
+				return source;
+			}
+
+			std::stringstream input(source), output;
+			std::string line;
+
+			while (std::getline(input, line)) {
+				size_t directive = line.find("#include");
+				size_t nameStart = line.find('"', directive);
+				size_t nameEnd = line.find('"', nameStart + 1);
+
+				if (directive == std::string::npos || line.find_first_not_of(" \t") != directive || nameEnd == std::string::npos) {
+					output << line << '\n';
+					continue;
+				}
+
+				std::filesystem::path includePath = directory / line.substr(nameStart + 1, nameEnd - nameStart - 1);
+				std::ifstream includeFile(includePath);
+
+				if (!includeFile.is_open()) {
+					std::cerr << "unable to open included " << formatPath(includePath.string()) << "\n" << std::endl;
+					continue;
+				}
+
+				std::stringstream includeSource;
+				includeSource << includeFile.rdbuf();
+				output << resolveIncludes(includeSource.str(), includePath.parent_path(), depth + 1) << '\n';
+			}
+
+			return output.str();
+		}
+
+		// final source of a module - includes resolved and the variant's defines injected; empty if the file can't be read
+		std::string loadModuleSource(const std::filesystem::path& filepath, const ShaderDefines& variantDefines) {
+			std::ifstream file(filepath);
+			std::stringstream bufferedLines;
+
+			if (!file.is_open()) {
 				std::cerr << "unable to open " << formatPath(filepath.string()) << "\n" << std::endl;
-				return 0;
+				return "";
 			}
-		
-			std::string shaderSource = bufferedLines.str();
+			bufferedLines << file.rdbuf();
+
+			return injectDefines(resolveIncludes(bufferedLines.str(), filepath.parent_path()), variantDefines);
+		}
+
+		// submits the compile, its status is checked in finishProgram
+		GLuint makeModule(const std::string& shaderSource, GLuint module_type) {
+			if (shaderSource.empty()) { return 0; }
+
 			const char* shaderSrc = shaderSource.c_str();
-			bufferedLines.str("");
-			file.close();
 		
 			GLuint shaderModule = glCreateShader(module_type);
 			glShaderSource(shaderModule, 1, &shaderSrc, NULL);
 			glCompileShader(shaderModule);
 		
-			int success;
-			glGetShaderiv(shaderModule, GL_COMPILE_STATUS, &success);
-			if (!success) {
-				char errorLog[1024];
-				glGetShaderInfoLog(shaderModule, 1024, NULL, errorLog);
-				if (debugMode) { std::cout << formatError("FAILED") << "\n"; }
-				std::cerr << "Shader Module compilation error:\n" << colorText(errorLog, ANSII_YELLOW) << std::endl;
-			}
-			else if (debugMode && success) { std::cout << formatSuccess("Done") << std::endl; }
-		
 			return shaderModule;
 		}
 		
-		GLuint makeShader(const std::filesystem::path& vertexFilepath, const std::filesystem::path& fragmentFilepath) {
-			//To store all the shader modules
-			std::vector<GLuint> modules;
-		
-			// add modules to be attached to the shader
-			modules.push_back(makeModule(vertexFilepath,  GL_VERTEX_SHADER));
-			modules.push_back(makeModule(fragmentFilepath, GL_FRAGMENT_SHADER));
-		
-			if (debugMode) { std::cout << formatProcess("Making shader") << " from '" << formatPath(getFileName(vertexFilepath.string())) << "' and '" << formatPath(getFileName(fragmentFilepath.string())) << "' ... "; }
+		GLuint makeShader(const std::filesystem::path& vertexFilepath, const std::filesystem::path& fragmentFilepath, const ShaderDefines& variantDefines) {
+			std::string vertexSource = loadModuleSource(vertexFilepath, variantDefines);
+			std::string fragmentSource = loadModuleSource(fragmentFilepath, variantDefines);
+
+			std::string description = "'" + formatPath(getFileName(vertexFilepath.string())) + "' and '" + formatPath(getFileName(fragmentFilepath.string())) + "'" + (variantDefines.empty() ? "" : " [" + variantName(variantDefines) + "]");
+
+			// previously linked binary of the exact same sources
+			bool useCache = binaryCache && binaryCache->isSupported() && !vertexSource.empty() && !fragmentSource.empty();
+			uint64_t cacheKey = useCache ? binaryCache->makeKey({ vertexSource, fragmentSource }) : 0;
+
+			if (useCache) {
+				GLuint cached = binaryCache->load(cacheKey);
+				if (cached) {
+					if (debugMode) { std::cout << formatProcess("Loaded shader") << " from " << description << " " << formatRole("(cached binary)") << std::endl; }
+					return cached;
+				}
+			}
+
+			PendingProgram pendingProgram = { {}, description, cacheKey, useCache };
+
+			// compile and link are only submitted - querying their status right away would wait for the driver
+			if (debugMode) { std::cout << formatProcess("Submitting shader") << " " << description << std::endl; }
+
+			pendingProgram.modules.push_back(makeModule(vertexSource, GL_VERTEX_SHADER));
+			pendingProgram.modules.push_back(makeModule(fragmentSource, GL_FRAGMENT_SHADER));
 		
 			//Attach all the modules then link the program
 			GLuint shader = glCreateProgram();
-			for (GLuint shaderModule : modules) {
-				glAttachShader(shader, shaderModule);
+			for (GLuint shaderModule : pendingProgram.modules) {
+				if (shaderModule) { glAttachShader(shader, shaderModule); }
 			}
+			if (useCache) { glProgramParameteri(shader, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE); }
 			glLinkProgram(shader);
+
+			pending[shader] = std::move(pendingProgram);
 		
-			//Check the linking worked
+			return shader;
+		}
+
+		// status checks of a submitted program - blocks until the driver is done with it
+		void finishProgram(const GLuint& program) {
+			auto found = pending.find(program);
+			if (found == pending.end()) { return; }
+
+			PendingProgram& pendingProgram = found->second;
+
+			if (debugMode) { std::cout << formatProcess("Making shader") << " from " << pendingProgram.description << " ... "; }
+
 			int success;
-			glGetProgramiv(shader, GL_LINK_STATUS, &success);
+			for (GLuint shaderModule : pendingProgram.modules) {
+				if (!shaderModule) { continue; }
+
+				glGetShaderiv(shaderModule, GL_COMPILE_STATUS, &success);
+				if (!success) {
+					char errorLog[1024];
+					glGetShaderInfoLog(shaderModule, 1024, NULL, errorLog);
+					std::cerr << "\nShader Module compilation error:\n" << colorText(errorLog, ANSII_YELLOW) << std::endl;
+				}
+			}
+		
+			//Check the linking worked
+			glGetProgramiv(program, GL_LINK_STATUS, &success);
 			if (!success) {
 				char errorLog[1024];
-				glGetProgramInfoLog(shader, 1024, NULL, errorLog);
+				glGetProgramInfoLog(program, 1024, NULL, errorLog);
 				if (debugMode) { std::cout << formatError("FAILED") << "\n"; }
 				std::cerr << "Shader linking error:\n" << colorText(errorLog, ANSII_YELLOW) << '\n';
 			}
 			else if (debugMode && success) { std::cout << formatSuccess("Done") << std::endl; }
+
+			if (success && pendingProgram.storeBinary) { binaryCache->store(pendingProgram.cacheKey, program); }
 		
 			//Modules are now unneeded and can be freed
-			for (GLuint shaderModule : modules) {
+			for (GLuint shaderModule : pendingProgram.modules) {
 				glDeleteShader(shaderModule);
 			}
-		
-			return shader;
+
+			pending.erase(found);
 		}
 };
 
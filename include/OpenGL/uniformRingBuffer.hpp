@@ -0,0 +1,109 @@
+#ifndef UNIFORM_RING_BUFFER_CLASS_HEADER
+#define UNIFORM_RING_BUFFER_CLASS_HEADER
+
+#include <cstring>
+#include <vector>
+
+#include <glad/glad.h>
+
+/**
+ * @brief Uniform buffer that is only written to when its contents actually change.
+ *
+ * With GL 4.4+ the buffer is persistently mapped and split into several regions used round-robin;
+ * a fence guards every region so the CPU never overwrites data the GPU might still be reading.
+ * Older contexts fall back to glBufferSubData on a single region.
+ */
+class UniformRingBuffer {
+    public:
+        GLuint ID;
+
+        UniformRingBuffer(GLsizeiptr size, GLuint bindingPoint, unsigned int regionCount = 3) : size(size), bindingPoint(bindingPoint) {
+            persistent = GLAD_GL_VERSION_4_4;
+            if (!persistent) { regionCount = 1; }
+
+            GLint alignment = 256;
+            glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+            regionSize = ((size + alignment - 1) / alignment) * alignment;
+
+            fences.assign(regionCount, nullptr);
+            shadow.assign(size, 0);
+
+            glGenBuffers(1, &ID);
+            glBindBuffer(GL_UNIFORM_BUFFER, ID);
+
+            if (persistent) {
+                GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+                glBufferStorage(GL_UNIFORM_BUFFER, regionSize * regionCount, nullptr, flags);
+                mapping = (unsigned char*)glMapBufferRange(GL_UNIFORM_BUFFER, 0, regionSize * regionCount, flags);
+            }
+            else {
+                glBufferData(GL_UNIFORM_BUFFER, regionSize, nullptr, GL_DYNAMIC_DRAW);
+            }
+        }
+
+        // returns whether anything had to be written
+        bool write(const void* data) {
+            if (written && std::memcmp(shadow.data(), data, size) == 0) { return false; }
+
+            std::memcpy(shadow.data(), data, size);
+            written = true;
+
+            if (!persistent) {
+                glBindBuffer(GL_UNIFORM_BUFFER, ID);
+                glBufferSubData(GL_UNIFORM_BUFFER, 0, size, data);
+                glBindBufferBase(GL_UNIFORM_BUFFER, bindingPoint, ID);
+                return true;
+            }
+
+            // everything using the current region has been submitted by now
+            fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            region = (region + 1) % fences.size();
+
+            waitForRegion(region);
+
+            std::memcpy(mapping + region * regionSize, data, size);
+            glBindBufferRange(GL_UNIFORM_BUFFER, bindingPoint, ID, region * regionSize, size);
+
+            return true;
+        }
+
+        ~UniformRingBuffer() {
+            for (GLsync& fence : fences) {
+                if (fence) { glDeleteSync(fence); }
+            }
+
+            if (mapping) {
+                glBindBuffer(GL_UNIFORM_BUFFER, ID);
+                glUnmapBuffer(GL_UNIFORM_BUFFER);
+            }
+
+            glDeleteBuffers(1, &ID);
+        }
+
+    private:
+        GLsizeiptr size;
+        GLsizeiptr regionSize;
+        GLuint bindingPoint;
+
+        bool persistent = false;
+        bool written = false;
+
+        unsigned char* mapping = nullptr;
+        unsigned int region = 0;
+
+        std::vector<GLsync> fences;
+        std::vector<unsigned char> shadow; // last written contents, for skipping identical writes
+
+        void waitForRegion(unsigned int regionIndex) {
+            GLsync& fence = fences[regionIndex];
+            if (!fence) { return; }
+
+            // practically never blocks - the region was last used frames ago
+            while (glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1'000'000) == GL_TIMEOUT_EXPIRED) {}
+
+            glDeleteSync(fence);
+            fence = nullptr;
+        }
+};
+
+#endif // UNIFORM_RING_BUFFER_CLASS_HEADER
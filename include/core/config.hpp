@@ -23,8 +23,8 @@
 #include <shader.hpp>
 #include <model.hpp>
 
-using ShaderList = std::unordered_map<std::string, Shader*>;
-using ModelList = std::unordered_map<std::string, Model*>;
+using ShaderList = Registry<Shader*>;
+using ModelList = Registry<Model*>;
 
 using namespace std;
 using namespace chrono;
@@ -43,6 +43,16 @@ inline const std::filesystem::path modelPath = resourcePath/"models";
 inline const std::filesystem::path settingsPath = resourcePath/"settings.conf";
 inline const std::filesystem::path simObjectsConfigPath = resourcePath/"objects.json";
 inline const std::filesystem::path physicsScenesPath = resourcePath/"scenes.json";
+inline const std::filesystem::path physicsScenesBinaryPath = resourcePath/"scenes.simscene"; // made by --convert-scenes, used over the JSON while it's newer
+
+// generated at runtime, safe to delete
+inline const std::filesystem::path cachePath = "cache/";
+inline const std::filesystem::path shaderCachePath = cachePath/"shaders";
+inline const std::filesystem::path modelCachePath = cachePath/"models";
+inline const std::filesystem::path catalogTileCachePath = cachePath/"catalogs";
+
+// settings.conf changes are applied while running (Linux)
+inline bool hotReload = true;
 
 
 // window settings
@@ -59,10 +69,16 @@ inline const char* windowName = "Simulacrum project";
 // render settings
 inline int maxFrameRate = 60;
 inline int VSync = 1;
+inline bool renderOnDemand = true; // a paused scene without input stops drawing until something changes
+inline unsigned int idleDelayMS = 500; // frames keep coming this long after the last change (GUI hover and fades)
 
 inline bool doPostProcess = true;
 inline bool doFXAA = true;
 inline bool inverseColors = false;
+inline bool useShaderCache = true;
+inline bool useModelCache = true;
+inline unsigned int resourceBudgetMB = 512; // models and shader variants no scene uses are freed above this
+inline unsigned int sceneCacheMB = 256; // recently used scenes keep their models resident and stay prepared up to this; 0 disables
 inline bool renderUnsimulated = false;
 inline bool assumeModleIsScaled = true;
 
@@ -71,12 +87,9 @@ inline float ambientStrength = 0.2;
 // flag signaling whether the main window is or is not fullscreened. DO NOT MODIFY - handled by enter / exit fullscreen functions.
 inline bool fullscreen = false;
 
-inline float staticDelayFraction = 0.65f;
+inline float loadingFrameFraction = 0.25f; // share of a frame background scene loading may spend on GPU uploads
 inline bool simulateObjectRotation = true;
 
-inline nanoseconds spinDelay(375); // about 350 - 400 ns
-inline TinyInt lightUpdateFrameSkip = 2;
-
 inline float renderDistance = 1'000.0f;
 
 inline float cameraSpeed = 12.5f;
@@ -103,6 +116,15 @@ inline float maxScale = 6.0f;
 inline double currentScale; // kilometers per vertex - only for distances; use already present values for all else (especially for simplified mode)
 inline double renderScaleDistortion = 1.0; // 1.0 -> no distortion; less -> greater distances; more -> smaller distances
 
+// level of detail
+inline unsigned int icosphereSubdivisions = 6; // finest procedural sphere level; 20 * 4^n triangles -> 6 = 81 920
+inline float lodTargetEdgePixels = 6.0f; // desired on-screen length of a triangle edge
+inline float lodHysteresis = 0.25f; // fraction of a level the projected size has to overshoot before switching
+
+inline bool useRenderTiers = true; // draw small bodies as impostors / points instead of meshes
+inline float impostorPixelRadius = 16.0f; // projected radius below which a body becomes a ray-cast impostor
+inline float pointPixelRadius = 0.5f; // projected radius below which a body becomes a single point (under one pixel across)
+
 
 inline unsigned int phyiscsSubsteps = 2;
 
@@ -117,8 +139,11 @@ inline std::string projectPath(const std::filesystem::path& path) {
 
 // physics
 inline float physicsSteps = 60.0f; // amount of physics steps per second
+inline bool interpolatePhysics = true; // bodies are drawn between the last two physics states - smooth even with few steps per second
 inline bool gravityInInitialVel = false;
 inline bool trackSimTime = true;
+inline unsigned int catalogMemoryBudgetMB = 512; // catalogs whose bodies wouldn't fit are paged by tiles, keeping the ones around the camera
+inline unsigned int catalogTileBodies = 4096; // bodies per tile of a paged catalog
 
 #define PI 3.141592653589793
 #define GRAVITATIONAL_CONSTANT 6.6743e-11 // m³ kg⁻¹ s⁻²
@@ -1,24 +1,41 @@
 #ifndef GLOBAL_PROJECT_VARIABLE_HEADER
 #define GLOBAL_PROJECT_VARIABLE_HEADER
 
+#include <atomic>
 #include <chrono>
 #include <config.hpp>
 #include <types.hpp>
 
 #include <string>
 #include <lightObject.hpp>
+#include <threadPool.hpp>
 
 inline GLFWwindow* mainWindow;
 
 inline ShaderList Shaders;
 inline ModelList Models;
 
-inline std::unordered_map<std::string, LightObject*> lightQue;
+// asset decoding and parsing; results that need the GL context come back through mainThreadCompletions
+inline ThreadPool* workerPool = nullptr;
+inline CompletionQueue mainThreadCompletions;
+
+// light of a body in the current scene - bound by the body's index in the scene's object list
+struct SceneLight {
+    size_t objectIndex;
+    LightObject* light;
+};
+
+inline std::vector<SceneLight> lightQue;
 
 inline double deltaTime;
 inline nanoseconds frameDuration(1'000'000'000 / maxFrameRate); // 1,000,000 μs / 60 = 16666 μs = 16.666 m
 
 inline bool isMinimized = false;
+
+// something on screen may have changed since the last frame - set by GLFW callbacks and background work (see frameNeeded)
+inline std::atomic<bool> redrawRequested(true);
+inline void requestRedraw() { redrawRequested = true; }
+
 inline bool supressCameraControls = false;
 inline bool showMenu = false;
 inline bool showFPS = false;
@@ -2,26 +2,68 @@
 #define RENDER_DEFINITIONS
 
 #include <config.hpp>
-#include <UBO.hpp>
+#include <uniformRingBuffer.hpp>
+#include <SSBO.hpp>
 #include <camera.hpp>
 #include <FBO.hpp>
+#include <bodyBatch.hpp>
+#include <lightClusters.hpp>
+#include <renderThread.hpp>
 #include <unordered_map>
+#include <utility>
+
+#include <imgui/imgui.h>
+
+class Model;
 
 using FBOList = unordered_map<std::string, FBO*>;
 
 // global shader settings
 inline float lightFalloff = 0.001f;
-#define MAX_LIGHTS 4 // Define MAX_LIGHTS to match the shader
+inline float lightCutoff = 0.005f; // attenuated intensity below which a light is left out of a cluster
 
-// Global UBO for light properties
-inline UBO* lightBlockUBO = nullptr;
+// Global UBO for light properties - only written when the block changes
+inline UniformRingBuffer* lightBlockUBO = nullptr;
 
 const GLuint LIGHT_UBO_BINDING_POINT = 0; // Choose a binding point for the LightBlock UBO
 
+// clustered lighting - light list, per-cluster ranges and the light indices they point into (bindings match shaders/lighting.glsl)
+inline SSBO* lightSSBO = nullptr;
+inline SSBO* lightClusterSSBO = nullptr;
+inline SSBO* lightIndexSSBO = nullptr;
+
+const GLuint LIGHT_SSBO_BINDING_POINT = 1;
+const GLuint LIGHT_CLUSTER_SSBO_BINDING_POINT = 2;
+const GLuint LIGHT_INDEX_SSBO_BINDING_POINT = 3;
+
+const glm::uvec3 LIGHT_CLUSTER_GRID(16, 9, 24); // tiles on screen (x, y) and depth slices (z)
+
+inline LightClusterGrid lightClusters(LIGHT_CLUSTER_GRID);
+
+// scenes with up to this many lights use shader variants with the count baked in (LIGHT_COUNT) instead of clusters
+const unsigned int MAX_UNROLLED_LIGHTS = 4;
+
+inline bool clusteredLighting = true;
+inline std::vector<Shader*> litShaders; // shaders using the LightBlock - they get a variant per scene
+
 inline Camera* currentCamera;
 
 inline FBOList FBOs;
 
+// shaders and buffers the renderer uses every frame - looked up by name once at setup
+inline ShaderID postProcessShaderID, impostorShaderID, pointShaderID;
+inline FBO* postProcessFBO = nullptr;
+
+// how a body gets drawn, picked every frame from its size on screen
+enum class renderTier : unsigned char {
+    mesh,       // full model with level of detail
+    impostor,   // ray-cast sphere on a camera-facing quad
+    point       // single pixel
+};
+
+inline BodyBatch* impostorBatch = nullptr;
+inline BodyBatch* pointBatch = nullptr;
+
 struct ShaderLight {
     glm::vec3 position;
     float padding1;
@@ -31,12 +73,130 @@ struct ShaderLight {
 };
 
 struct LightBlockData {
-    ShaderLight lights[MAX_LIGHTS]; // Array of lights
     int lightCount;
     float lightFallOff;
+    float clusterNear;
+    float clusterFar;
+    glm::uvec4 clusterGrid;
+    glm::vec2 viewportSize;
     float padding[2];
 };
 
+// GUI draw lists copied out of the ImGui context - it starts on the next frame while the render thread draws this one
+class GuiDrawData {
+    public:
+        ImDrawData data;
+
+        GuiDrawData() = default;
+        GuiDrawData(const GuiDrawData&) = delete;
+        GuiDrawData& operator=(const GuiDrawData&) = delete;
+
+        // moves swap - packets are moved on the render thread, where nothing may go through ImGui's allocator
+        GuiDrawData(GuiDrawData&& other) noexcept { swap(other); }
+        GuiDrawData& operator=(GuiDrawData&& other) noexcept {
+            if (this != &other) { swap(other); } // the old lists go with other and are released where it is
+            return *this;
+        }
+
+        // textures aren't carried over - their updates have to be uploaded before the copy is drawn
+        void capture(const ImDrawData* source) {
+            release();
+            if (!source || !source->Valid) { return; }
+
+            data.Valid = true;
+            data.DisplayPos = source->DisplayPos;
+            data.DisplaySize = source->DisplaySize;
+            data.FramebufferScale = source->FramebufferScale;
+
+            for (const ImDrawList* list : source->CmdLists) {
+                data.CmdLists.push_back(list->CloneOutput());
+                data.TotalVtxCount += list->VtxBuffer.Size;
+                data.TotalIdxCount += list->IdxBuffer.Size;
+            }
+            data.CmdListsCount = data.CmdLists.Size;
+        }
+
+        // ImGui's allocator counts on its context - only release on the main thread
+        void release() {
+            for (ImDrawList* list : data.CmdLists) { IM_DELETE(list); }
+            data.Clear();
+        }
+
+        ~GuiDrawData() { release(); }
+
+    private:
+        // ImDrawData's own assignment copies CmdLists (allocates) - only the pointers change hands here
+        void swap(GuiDrawData& other) noexcept {
+            data.CmdLists.swap(other.data.CmdLists);
+
+            std::swap(data.Valid, other.data.Valid);
+            std::swap(data.CmdListsCount, other.data.CmdListsCount);
+            std::swap(data.TotalVtxCount, other.data.TotalVtxCount);
+            std::swap(data.TotalIdxCount, other.data.TotalIdxCount);
+            std::swap(data.DisplayPos, other.data.DisplayPos);
+            std::swap(data.DisplaySize, other.data.DisplaySize);
+            std::swap(data.FramebufferScale, other.data.FramebufferScale);
+            std::swap(data.OwnerViewport, other.data.OwnerViewport);
+            std::swap(data.Textures, other.data.Textures);
+        }
+};
+
+/**
+ * @brief Everything the render thread draws a frame from.
+ *
+ * Built by the main thread and not touched by it once submitted. Bodies are resolved to the model that gets drawn
+ * (a master or one of its detail levels) - instances belong to the scene and may be gone by the time the frame is drawn.
+ */
+struct FramePacket {
+    struct MeshDraw {
+        Model* mesh;
+        Shader* shader;
+        glm::mat4 modelMatrix;
+        glm::vec3 color;
+    };
+
+    // camera
+    glm::mat4 viewMatrix = glm::mat4(1.0f);
+    glm::mat4 projectionMatrix = glm::mat4(1.0f);
+    glm::vec3 cameraPosition = glm::vec3(0.0f);
+    float nearClipPlane = 0.1f, farClipPlane = 100.0f;
+    glm::vec2 viewportSize = glm::vec2(0.0f);
+
+    glm::vec4 clearColor = glm::vec4(0.0f);
+    bool drawScene = false;
+    bool postProcess = false;
+    bool waitForGPU = false; // benchmark frames are timed including the GPU work
+
+    std::vector<MeshDraw> meshes;
+    std::vector<BodyInstance> impostors, points;
+
+    std::vector<ShaderLight> lights;
+    std::vector<ClusterLight> clusterLights;
+    float lightFalloff = 0.0f;
+
+    GuiDrawData gui;
+
+    // keeps the buffers for the next frame
+    void clear() {
+        drawScene = false;
+        meshes.clear();
+        impostors.clear();
+        points.clear();
+        lights.clear();
+        clusterLights.clear();
+    }
+};
+
+// owns the GL context while the main loop runs
+inline RenderThread<FramePacket> renderThread;
+
+// framebuffer size on the render thread's side - set at setup and on resize
+inline glm::ivec2 framebufferSize(0);
+
+inline std::vector<ShaderLight> shaderLights;
+inline std::vector<ClusterLight> clusterLights;
+inline LightBlockData lightBlockData;
+
 inline std::map<char, glm::vec3> starTypeCartoonEmissions = {
     {'O', {0.10f, 0.30f, 1.00f}},
     {'B', {0.20f, 0.60f, 1.00f}},
@@ -50,4 +210,7 @@ inline std::map<char, glm::vec3> starTypeCartoonEmissions = {
 void enterFullscreen();
 void exitFullscreen();
 
+void selectLightingVariants(const size_t& lightCount);
+void selectPostProcessVariant();
+
 #endif // RENDER_DEFINITIONS
\ No newline at end of file
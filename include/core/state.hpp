@@ -33,6 +33,7 @@ inline void transitionState(state newState) {
     else if (mainState == state::paused) {
         if (newState == state::running) {
             pausePhysicsThread = false;
+            physicsCV.notify_all();
             mainState = state::running;
         }
         else if (newState == state::loading) {
@@ -41,8 +42,13 @@ inline void transitionState(state newState) {
         }
     }
     else if (mainState == state::loading) {
-        if (newState == state::running || newState == state::paused) {
+        if (newState == state::running) {
             pausePhysicsThread = false;
+            physicsCV.notify_all();
+            mainState = state::running;
+        }
+        else if (newState == state::paused) {
+            mainState = state::paused;
         }
     }
     else if (mainState == state::starting) {
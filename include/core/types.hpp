@@ -8,11 +8,18 @@
 #include <glad/glad.h>
 #include <color.hpp>
 #include <units.hpp>
+#include <handles.hpp>
 
-using ShaderID = std::string;
-using ModelID = std::string;
-using SimObjectID = std::string;
-using SceneID = std::string;
+class Shader;
+class Model;
+class simulationObject;
+struct scene;
+
+// names only exist at load time and in the GUI - everything else refers to registry entries by handle
+using ShaderID = Handle<Shader*>;
+using ModelID = Handle<Model*>;
+using SimObjectID = Handle<simulationObject*>;
+using SceneID = Handle<scene*>;
 
 
 using TinyInt = unsigned char; // 0-255
@@ -26,6 +33,24 @@ struct ModelData {
     std::vector<float> vertices; // Stores vertex positions (x, y, z)
     std::vector<float> normals;  // Stores vertex normals (nx, ny, nz)
     std::vector<unsigned int> indices;   // Stores indices for indexed drawing
+
+    // axis aligned bounds of the vertices - kept up to date by whoever fills or changes them
+    glm::vec3 boundsMin = glm::vec3(0.0f);
+    glm::vec3 boundsMax = glm::vec3(0.0f);
+
+    void computeBounds() {
+        if (vertices.size() < 3) {
+            boundsMin = boundsMax = glm::vec3(0.0f);
+            return;
+        }
+
+        boundsMin = boundsMax = glm::vec3(vertices[0], vertices[1], vertices[2]);
+        for (size_t i = 3; i + 2 < vertices.size(); i += 3) {
+            glm::vec3 vertex(vertices[i], vertices[i + 1], vertices[i + 2]);
+            boundsMin = glm::min(boundsMin, vertex);
+            boundsMax = glm::max(boundsMax, vertex);
+        }
+    }
 };
 
 // --- ENUMS ---
@@ -18,6 +18,7 @@
 #include <EBO.hpp>
 #include <shader.hpp> // For the Shader class
 #include <3DModelImport.hpp> // For ModelData and loadSTLData
+#include <meshOptimizer.hpp> // For packMesh
 #include <debug.hpp>
 
 /**
@@ -27,11 +28,12 @@
 class Model {
 private:
     VAO* vao;                  // Vertex Array Object
-    VBO* vboPositions;         // VBO for vertex positions
-    VBO* vboNormals;           // VBO for vertex normals
-    VBO* vboColors;            // VBO for vertex colors
+    VBO* vboVertices;          // interleaved, quantized positions and normals (see packMesh)
     EBO* ebo;                  // Element Buffer Object (indices)
 
+    GLsizei indexCount = 0;
+    size_t bufferedSize = 0;   // bytes of vertex and index data on the GPU
+
     void handleFlags(const unsigned int flags) {
         if (flags & Model::Flags::MAKE_INSTANCE) {
             isDerived = true;
@@ -64,17 +66,20 @@ public:
     bool isDerived = false;
     glm::mat4 transform;
 
+    // coarser variants of this model ordered from the coarsest; the model itself is the finest level
+    std::vector<Model*> detailLevels;
+    // for instances - which of the master's levels gets drawn
+    unsigned int detailLevel = 0;
+
 
     Model(ModelData data, const glm::vec3& color, const unsigned int flags = 0)
-        : modelData(data), color(color), vao(nullptr), vboPositions(nullptr),
-          vboNormals(nullptr), vboColors(nullptr), ebo(nullptr)
+        : modelData(std::move(data)), color(color), vao(nullptr), vboVertices(nullptr), ebo(nullptr)
     {
         // Pointers are initialized to nullptr, the OpenGL objects are not created here.
         handleFlags(flags);
     }
 
-    Model(Model& master, const unsigned int flags = 0) : color(master.color), vao(nullptr), vboPositions(nullptr),
-          vboNormals(nullptr), vboColors(nullptr), ebo(nullptr)
+    Model(Model& master, const unsigned int flags = 0) : color(master.color), vao(nullptr), vboVertices(nullptr), ebo(nullptr)
     {
         // Pointers are initialized to nullptr, the OpenGL objects are not created here.
         handleFlags(flags);
@@ -92,7 +97,42 @@ public:
         
         // model data gets automatically deleted
         clearBufferedData();
-        
+
+        for (Model* level : detailLevels) { delete level; }
+        detailLevels.clear();
+    }
+
+    // GPU memory of this model and all of its levels of detail; instances share their master's buffers
+    size_t bufferedMemory() const {
+        size_t total = bufferedSize;
+        for (const Model* level : detailLevels) { total += level->bufferedMemory(); }
+        return total;
+    }
+
+    // CPU side copy of the mesh (kept for scaling and bounds), including the levels of detail
+    size_t cpuMemory() const {
+        size_t total = (modelData.vertices.capacity() + modelData.normals.capacity()) * sizeof(float) + modelData.indices.capacity() * sizeof(unsigned int);
+        for (const Model* level : detailLevels) { total += level->cpuMemory(); }
+        return total;
+    }
+
+    // whether there is a mesh to draw - models can be registered before their data is read
+    bool isResident() const { return !modelData.indices.empty(); }
+
+    // drops the mesh on both sides; the model itself stays valid, so instances keep pointing at it
+    void releaseData() {
+        clearBufferedData();
+        modelData = ModelData();
+
+        for (Model* level : detailLevels) { level->releaseData(); }
+    }
+
+    unsigned int levelsOfDetail() const { return detailLevels.size() + 1; }
+
+    // returns the model used for drawing the given level; anything past the coarser levels is the model itself
+    Model* getDetailLevel(const unsigned int level) {
+        if (level >= detailLevels.size()) { return this; }
+        return detailLevels[level];
     }
 
     void clearBufferedData() {
@@ -100,22 +140,18 @@ public:
             delete vao;
             vao = nullptr;
         }
-        if (vboPositions) {
-            delete vboPositions;
-            vboPositions = nullptr;
-        }
-        if (vboNormals) {
-            delete vboNormals;
-            vboNormals = nullptr;
-        }
-        if (vboColors) {
-            delete vboColors;
-            vboColors = nullptr;
+        if (vboVertices) {
+            delete vboVertices;
+            vboVertices = nullptr;
         }
         if (ebo) {
             delete ebo;
             ebo = nullptr;
         }
+        indexCount = 0;
+        bufferedSize = 0;
+
+        for (Model* level : detailLevels) { level->clearBufferedData(); }
     }
     
     void ensureMasterIsBuffered() {
@@ -141,26 +177,33 @@ public:
             clearBufferedData();
         }
 
+        // packed from the current vertices, so scaling done before buffering is included
+        uploadPacked(packMesh(modelData));
+
+        for (Model* level : detailLevels) { level->sendBufferedVertices(); }
+    }
+
+    // GPU upload of an already packed mesh - packing is CPU only, so it can be done on a worker beforehand
+    void uploadPacked(const PackedMesh& packed) {
+        if (vao) { clearBufferedData(); }
+
         // Create VAO and bind it
         vao = new VAO();
         vao->bind();
 
-        // --- Vertex Positions (location = 0) ---
-        vboPositions = new VBO(modelData.vertices.data(), modelData.vertices.size() * sizeof(GLfloat));
-        vao->linkAttrib(*vboPositions, 0, 3, GL_FLOAT, 3 * sizeof(GLfloat), (void*)0);
-
-        // --- Normals (location = 1) ---
-        vboNormals = new VBO(modelData.normals.data(), modelData.normals.size() * sizeof(GLfloat));
-        vao->linkAttrib(*vboNormals, 1, 3, GL_FLOAT, 3 * sizeof(GLfloat), (void*)0);
+        // --- Interleaved vertices: position (location = 0), octahedral normal (location = 1) ---
+        vboVertices = new VBO(packed.vertices.data(), packed.vertices.size());
+        vao->linkAttrib(*vboVertices, 0, 3, packed.positionType, packed.stride, (void*)0);
+        vao->linkAttrib(*vboVertices, 1, 2, GL_BYTE, packed.stride, (void*)packed.normalOffset, GL_TRUE);
 
         // --- EBO (Indices) ---
-        ebo = new EBO(modelData.indices.data(), modelData.indices.size() * sizeof(GLuint));
+        ebo = new EBO(packed.indices.data(), packed.indices.size(), packed.indexType);
+        indexCount = packed.indexCount;
+        bufferedSize = packed.vertices.size() + packed.indices.size();
 
-        // Unbind everything
+        // Unbind everything - the EBO binding is part of the VAO state, so the VAO goes first
         vao->unbind();
-        vboPositions->unbind();
-        vboColors->unbind();
-        vboNormals->unbind();
+        vboVertices->unbind();
         ebo->unbind();
     }
 
@@ -183,14 +226,14 @@ public:
         if (!isDerived) {
             vao->bind(); // Bind the VAO
 
-            glDrawElements(GL_TRIANGLES, modelData.indices.size(), GL_UNSIGNED_INT, 0);
+            glDrawElements(GL_TRIANGLES, indexCount, ebo->indexType, 0);
 
             // Unbind the VAO
             vao->unbind();
         }
         else {
             if (!skipDerivedMatrix) { shader->applyModelMatrix(transform); }
-            master->draw(shader, true, true);
+            master->getDetailLevel(detailLevel)->draw(shader, true, true);
         }
     }
 };
@@ -12,6 +12,10 @@
 #include <globals.hpp>
 #include <renderDefinitions.hpp>
 
+// interned up front - objects are also made on worker threads (catalog tiles), which mustn't touch the interner
+inline const StringID STAR_OBJECT_TYPE = internedStrings.intern("star");
+inline const StringID PLANET_OBJECT_TYPE = internedStrings.intern("planet");
+
 class simulationObject {
     private:
         ShaderID shaderID;
@@ -25,6 +29,8 @@ class simulationObject {
     public:
         // vertex position - scaled
         glm::vec3 vertPosition = glm::vec3(0.0f);
+        // one physics step earlier - bodies are drawn in between, see physicsStateFraction
+        glm::vec3 previousVertPosition = glm::vec3(0.0f);
 
         // real-world position - km
         glm::dvec3 position = glm::dvec3(0.0f);
@@ -52,8 +58,10 @@ class simulationObject {
 
         glm::mat4 modelMatrix = glm::mat4(1);
         std::string objectType = "planet";
+        StringID objectTypeID = PLANET_OBJECT_TYPE; // objectType interned - what the per frame checks compare
         bool simulate = true;
         bool firstPass = true;
+        bool testParticle = false; // in one of its scene's testParticles groups
 
         LightObject* light = nullptr;
 
@@ -66,7 +74,7 @@ class simulationObject {
                 model = new Model(*Models[modelID]);
             }
         }
-        simulationObject(const simulationObject& original, bool deriveModel = true) {
+        simulationObject(const simulationObject& original, bool deriveModel = true) : objectType(original.objectType), objectTypeID(original.objectTypeID) {
             this->shader = original.shader;
             if (deriveModel) {
                 this->model = new Model(*original.model, Model::Flags::MAKE_INSTANCE);
@@ -77,7 +85,6 @@ class simulationObject {
 
             this->mass = original.mass;
             this->light = original.light;
-            this->objectType = original.objectType;
 
             this->position = original.position;
             this->velocity = original.velocity;
@@ -111,38 +118,18 @@ class simulationObject {
             originalAcceleration = acceleration;
         }
 
-        void calculateAproximateRadius() {
-
-            std::vector<float> vertices;
-
-            if (model->isDerived) {
-                vertices = model->master->modelData.vertices;
-            }
-            else {
-                vertices = model->modelData.vertices;
-            }
-            // vertices passed will be render-ready so x, y, z, x, y, z, ...
-
-            float minX = vertices[0]; float MaxX = vertices[0];
-            float minY = vertices[1]; float MaxY = vertices[1];
-            float minZ = vertices[2]; float MaxZ = vertices[2];
-
-            for (auto vertex = vertices.begin() + 3; /* 3 items per vertex; x, y, z*/ vertex != vertices.end(); vertex += 3) {
-                minX = std::min( *vertex, minX);
-                MaxX = std::max( *vertex, MaxX);
-
-                minY = std::min( *(vertex + 1), minY);
-                MaxY = std::max( *(vertex + 1), MaxY);
+        // same starting state - a hot reload keeps simulating bodies whose start didn't change
+        bool startsLike(const simulationObject& other) const {
+            return name == other.name && originalPosition == other.originalPosition && originalvelocity == other.originalvelocity;
+        }
 
-                minZ = std::min( *(vertex + 2), minZ);
-                MaxZ = std::max( *(vertex + 2), MaxZ);
-            }
+        void calculateAproximateRadius() {
+            // bounds come with the model data (computed on import or read from the mesh cache)
+            const ModelData& modelData = model->isDerived ? model->master->modelData : model->modelData;
 
-            float DifferenceX = std::abs(MaxX - minX);
-            float DifferenceY = std::abs(MaxY - minY);
-            float DifferenceZ = std::abs(MaxZ - minZ);
+            glm::vec3 difference = glm::abs(modelData.boundsMax - modelData.boundsMin);
 
-            vertexModelRadius = std::max(DifferenceX, std::max(DifferenceY, DifferenceZ)) * 0.5f;
+            vertexModelRadius = std::max(difference.x, std::max(difference.y, difference.z)) * 0.5f;
         }
         
         void normalizeVertices(const float normalizedRadius) {
@@ -167,11 +154,24 @@ class simulationObject {
                 for (auto& verticeAxee : model->modelData.vertices) {
                     verticeAxee *= scaleFactor;
                 }
+                model->modelData.boundsMin *= scaleFactor;
+                model->modelData.boundsMax *= scaleFactor;
             }
         }
 
+        // where the body is drawn - fraction of the way from the previous physics state to the current one
+        glm::vec3 renderPosition(const float& fraction) const { return glm::mix(previousVertPosition, vertPosition, fraction); }
+
+        bool isEmissive() const { return objectTypeID == STAR_OBJECT_TYPE; }
+
+        // color the object is drawn with - stars use their type's color in cartoon mode
+        glm::vec3 getDisplayColor() {
+            if (cartoonColorMode && isEmissive() && light) { return starTypeCartoonEmissions[light->starType]; }
+            return model->color;
+        }
+
         void draw(bool skipDerivedMatrix = false) {
-            bool skipColor = cartoonColorMode && objectType == "star";
+            bool skipColor = cartoonColorMode && isEmissive();
             if (skipColor) {
                 shader->setUniform("color", starTypeCartoonEmissions[light->starType]);
             }
@@ -181,7 +181,7 @@ class simulationObject {
 
 };
 
-using SimObjectList = std::unordered_map<std::string, simulationObject*>;
+using SimObjectList = Registry<simulationObject*>;
 
 inline SimObjectList SimObjects;
 
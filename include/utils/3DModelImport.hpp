@@ -4,6 +4,7 @@
 #include <iostream>
 #include <vector>
 #include <string>
+#include <sstream>
 #include <filesystem>
 
 #include <debug.hpp>
@@ -23,6 +24,20 @@
 
 #include <set>
 
+// Post-processing flags:
+// aiProcess_Triangulate: Ensures all faces are triangles.
+// aiProcess_GenSmoothNormals: Generates smooth per-vertex normals if the model doesn't have them.
+// aiProcess_JoinIdenticalVertices: Joins duplicate vertices, allowing for indexed drawing (EBO).
+// aiProcess_PreTransformVertices: Applies the root node's transformation matrix to the vertices.
+// This is useful for compensating for different coordinate systems (e.g., Z-up vs Y-up).
+// also part of the mesh cache key - changing them invalidates cached meshes
+inline const unsigned int MODEL_IMPORT_FLAGS =
+    aiProcess_Triangulate |
+    aiProcess_GenSmoothNormals |
+    aiProcess_JoinIdenticalVertices |
+    aiProcess_PreTransformVertices |
+    aiProcess_ImproveCacheLocality;  // Optimizes vertex cache (helps with interpolation)
+
 /**
  * @brief Loads an STL model from the specified file path and extracts its vertex positions, normals, and indices.
  *
@@ -38,19 +53,7 @@
  */
 ModelData loadSTLData(const std::filesystem::path& filePath) {
     Assimp::Importer importer;
-    // Post-processing flags:
-    // aiProcess_Triangulate: Ensures all faces are triangles.
-    // aiProcess_GenSmoothNormals: Generates smooth per-vertex normals if the model doesn't have them.
-    // aiProcess_JoinIdenticalVertices: Joins duplicate vertices, allowing for indexed drawing (EBO).
-    // aiProcess_PreTransformVertices: Applies the root node's transformation matrix to the vertices.
-    // This is useful for compensating for different coordinate systems (e.g., Z-up vs Y-up).
-    const aiScene* scene = importer.ReadFile(filePath.string(),
-        aiProcess_Triangulate |
-        aiProcess_GenSmoothNormals |
-        aiProcess_JoinIdenticalVertices |
-        aiProcess_PreTransformVertices |
-        aiProcess_ImproveCacheLocality  // Optimizes vertex cache (helps with interpolation)
-    );
+    const aiScene* scene = importer.ReadFile(filePath.string(), MODEL_IMPORT_FLAGS);
 
     aiMesh* mesh = scene->mMeshes[0];
 
@@ -113,10 +116,15 @@ ModelData loadSTLData(const std::filesystem::path& filePath) {
         }
     }
 
+    modelData.computeBounds();
+
+    // one write - models are imported on several threads at once
     if (debugMode) {
-        std::cout << '\n' << formatProcess("Loaded") << " 3D model data from: '" << formatPath(getFileName(filePath)) << "'" << std::endl;
-        std::cout << formatProcess("Extracted ") << mesh->mNumVertices << " " << formatRole("vertices") << " and "
-                << modelData.indices.size() << formatRole(" indices") << std::endl;
+        std::stringstream message;
+        message << '\n' << formatProcess("Loaded") << " 3D model data from: '" << formatPath(getFileName(filePath)) << "'\n"
+                << formatProcess("Extracted ") << mesh->mNumVertices << " " << formatRole("vertices") << " and "
+                << modelData.indices.size() << formatRole(" indices") << '\n';
+        std::cout << message.str() << std::flush;
     }
     return modelData;
 }
@@ -0,0 +1,111 @@
+#ifndef ARENA_ALLOCATOR_HEADER
+#define ARENA_ALLOCATOR_HEADER
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Bump allocator for objects that all live and die together (everything of one scene, one physics snapshot).
+ *
+ * Objects are placed one after another into large blocks, so objects created together sit next to each other in memory.
+ * Nothing is freed individually - reset destroys every object (newest first) and keeps the blocks for the next fill,
+ * release gives the blocks back as well. Not synchronized.
+ */
+class Arena {
+    public:
+        explicit Arena(const size_t& blockSize = 64 * 1024) : blockSize(blockSize) {}
+
+        Arena(const Arena&) = delete;
+        Arena& operator=(const Arena&) = delete;
+
+        ~Arena() { release(); }
+
+        template <typename T, typename... Args>
+        T* create(Args&&... args) {
+            T* object = new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+
+            if constexpr (!std::is_trivially_destructible_v<T>) {
+                destructors.push_back({ object, [](void* pointer) { static_cast<T*>(pointer)->~T(); } });
+            }
+            objectCount++;
+
+            return object;
+        }
+
+        void* allocate(const size_t& size, const size_t& alignment) {
+            while (current < blocks.size()) {
+                Block& block = blocks[current];
+
+                uintptr_t start = (uintptr_t)block.memory.get() + block.used;
+                uintptr_t aligned = (start + alignment - 1) & ~(uintptr_t)(alignment - 1);
+                size_t needed = (aligned - start) + size;
+
+                if (block.used + needed <= block.size) {
+                    block.used += needed;
+                    usedBytes += needed;
+                    return (void*)aligned;
+                }
+
+                current++; // the rest of this block stays unused until the next reset
+            }
+
+            // oversized objects get a block of their own
+            size_t newBlockSize = std::max(blockSize, size + alignment);
+            blocks.push_back({ std::unique_ptr<unsigned char[]>(new unsigned char[newBlockSize]), newBlockSize, 0 });
+            reservedBytes += newBlockSize;
+
+            return allocate(size, alignment);
+        }
+
+        // destroys every object, the memory is kept for reuse
+        void reset() {
+            for (auto destructor = destructors.rbegin(); destructor != destructors.rend(); ++destructor) { destructor->destroy(destructor->object); }
+            destructors.clear();
+
+            for (Block& block : blocks) { block.used = 0; }
+            current = 0;
+            usedBytes = 0;
+            objectCount = 0;
+        }
+
+        // destroys every object and frees the memory
+        void release() {
+            reset();
+
+            blocks.clear();
+            blocks.shrink_to_fit();
+            destructors.shrink_to_fit();
+            reservedBytes = 0;
+        }
+
+        size_t used() const { return usedBytes; }
+        size_t reserved() const { return reservedBytes; }
+        size_t objects() const { return objectCount; }
+
+    private:
+        struct Block {
+            std::unique_ptr<unsigned char[]> memory;
+            size_t size;
+            size_t used;
+        };
+        struct Destructor {
+            void* object;
+            void (*destroy)(void*);
+        };
+
+        size_t blockSize;
+
+        std::vector<Block> blocks;
+        std::vector<Destructor> destructors;
+        size_t current = 0; // block new objects go into
+
+        size_t usedBytes = 0, reservedBytes = 0, objectCount = 0;
+};
+
+#endif // ARENA_ALLOCATOR_HEADER
@@ -0,0 +1,427 @@
+#ifndef BINARY_SCENE_HEADER
+#define BINARY_SCENE_HEADER
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include <mappedFile.hpp>
+#include <simulationData.hpp>
+#include <FormatConsole.hpp>
+
+/**
+ * Binary scene file (.simscene) - scenes.json with the object properties of objects.json resolved, stored so the loader
+ * can use it straight from a memory mapping:
+ *
+ *   header | scene records | per scene: columns of object names, positions, velocities, masses, radii, group ranges, catalogs | string table
+ *
+ * Every column is a plain array at an 8 byte aligned offset. Groups refer to bodies by index, names (scenes and objects)
+ * by index into the string table. Orbit catalogs are only referenced (file and object name) and imported on load.
+ * Numbers are stored in the byte order of the machine that wrote the file; a file from the other byte order, another
+ * version or with a bad range is rejected as a whole.
+ */
+
+inline constexpr char BINARY_SCENE_MAGIC[8] = { 'S', 'I', 'M', 'S', 'C', 'E', 'N', 'E' };
+inline constexpr uint32_t BINARY_SCENE_VERSION = 2;
+inline constexpr uint32_t BINARY_SCENE_BYTE_ORDER = 0x01020304; // reads back as 0x04030201 on the other byte order
+
+struct BinarySceneHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint64_t fileSize;
+
+    double orbit[3];
+
+    uint32_t sceneCount;
+    uint32_t stringCount;
+    uint64_t scenes;        // BinarySceneRecord[sceneCount]
+    uint64_t stringOffsets; // uint64_t[stringCount + 1] - string i is the bytes [offsets[i], offsets[i + 1]) of the string data
+    uint64_t stringData;
+};
+
+struct BinarySceneRecord {
+    uint32_t name; // string index
+    uint32_t bodyCount;
+    uint32_t groupCount;
+    uint32_t groupMemberCount;
+
+    uint64_t objects;       // uint32_t[bodyCount] - string index of the object each body is an instance of
+    uint64_t positions;     // glm::dvec3[bodyCount] - km
+    uint64_t velocities;    // glm::dvec3[bodyCount] - km/s, NaN if the ideal orbit velocity is computed on load
+    uint64_t masses;        // double[bodyCount] - tons
+    uint64_t radii;         // double[bodyCount] - km
+    uint64_t groupOffsets;  // uint32_t[groupCount + 1] - group i has the members [offsets[i], offsets[i + 1])
+    uint64_t groupMembers;  // uint32_t[groupMemberCount] - body indices
+
+    uint32_t catalogCount;
+    uint32_t reserved;
+    uint64_t catalogs;      // uint32_t[catalogCount * 2] - string indices of each catalog's file and object
+};
+
+static_assert(std::is_trivially_copyable_v<BinarySceneHeader> && sizeof(BinarySceneHeader) == 80);
+static_assert(std::is_trivially_copyable_v<BinarySceneRecord> && sizeof(BinarySceneRecord) == 88);
+static_assert(sizeof(glm::dvec3) == 3 * sizeof(double), "positions are mapped as glm::dvec3");
+
+// -----------------===[ Converting ]===-----------------
+
+// one scene ready to be written - the same columns as the file
+struct BinarySceneData {
+    uint32_t name = 0;
+
+    std::vector<uint32_t> objects;
+    std::vector<glm::dvec3> positions, velocities;
+    std::vector<double> masses, radii;
+
+    std::vector<uint32_t> groupOffsets = { 0 };
+    std::vector<uint32_t> groupMembers;
+
+    std::vector<uint32_t> catalogs; // file, object, file, ...
+};
+
+struct BinarySceneSet {
+    glm::dvec3 orbit = glm::dvec3(0.0, 1.0, 0.0);
+    std::vector<std::string> strings;
+    std::vector<BinarySceneData> scenes;
+};
+
+/**
+ * @brief Resolves the scenes.json records against objects.json.
+ *
+ * Follows what loadPhysicsScene does with the JSON: scenes without objects or groups are left out, as are bodies without
+ * an object or position or whose object has no radius or mass, and group members that name no body (a name stands for
+ * the last body of that name). Everything left out is described in `skipped`.
+ */
+inline BinarySceneSet convertSceneRecords(const ObjectFile& objectFile, const SceneFile& sceneFile, std::vector<std::string>& skipped) {
+    BinarySceneSet set;
+    set.orbit = sceneFile.orbit;
+
+    std::unordered_map<std::string, uint32_t> stringIndices;
+    auto intern = [&](const std::string& text) {
+        auto [found, added] = stringIndices.try_emplace(text, (uint32_t)set.strings.size());
+        if (added) { set.strings.push_back(text); }
+        return found->second;
+    };
+
+    // later definitions replace earlier ones, as in SimObjects
+    std::unordered_map<std::string, const ObjectEntry*> objects;
+    for (const ObjectEntry& object : objectFile.objects) { objects[object.name] = &object; }
+
+    const double missingVelocity = std::nan("");
+
+    for (const SceneEntry& sceneData : sceneFile.scenes) {
+        if (!sceneData.error.empty()) { skipped.push_back(std::format("scene '{}' - {}", sceneData.name, sceneData.error)); continue; }
+        if (!sceneData.hasObjects) { skipped.push_back(std::format("scene '{}' - no objects", sceneData.name)); continue; }
+        if (!sceneData.hasGroups) { skipped.push_back(std::format("scene '{}' - no groups", sceneData.name)); continue; }
+
+        BinarySceneData scene;
+        scene.name = intern(sceneData.name);
+
+        std::vector<const ObjectEntry*> masters(sceneData.names.size(), nullptr);
+        for (size_t i = 0; i < sceneData.names.size(); ++i) {
+            auto found = objects.find(sceneData.names[i]);
+            if (found != objects.end() && found->second->hasRadius && found->second->hasMass) { masters[i] = found->second; }
+        }
+
+        std::vector<uint32_t> byName(sceneData.names.size(), UINT32_MAX); // body index, as groups list members by name
+
+        for (const SceneObjectEntry& objectData : sceneData.objects) {
+            if (!objectData.hasObject) { skipped.push_back(std::format("object without 'object' in scene '{}'", sceneData.name)); continue; }
+
+            const std::string& objectName = sceneData.names[objectData.object];
+            const ObjectEntry* master = masters[objectData.object];
+
+            if (!master) { skipped.push_back(std::format("unknown object '{}' in scene '{}'", objectName, sceneData.name)); continue; }
+            if (!objectData.hasPosition) { skipped.push_back(std::format("'{}' without 'position' in scene '{}'", objectName, sceneData.name)); continue; }
+
+            byName[objectData.object] = scene.objects.size();
+
+            scene.objects.push_back(intern(objectName));
+            scene.positions.push_back(objectData.position);
+            scene.velocities.push_back(objectData.hasVelocity ? objectData.velocity : glm::dvec3(missingVelocity));
+            scene.masses.push_back(master->mass);
+            scene.radii.push_back(master->radius);
+        }
+
+        for (size_t group = 0; group < sceneData.groupCount(); ++group) {
+            for (uint32_t member = sceneData.groupOffsets[group]; member < sceneData.groupOffsets[group + 1]; ++member) {
+                uint32_t body = byName[sceneData.groupMembers[member]];
+                if (body != UINT32_MAX) { scene.groupMembers.push_back(body); }
+            }
+            scene.groupOffsets.push_back(scene.groupMembers.size());
+        }
+
+        for (const CatalogEntry& catalog : sceneData.catalogs) {
+            if (!catalog.hasFile || !catalog.hasObject) { skipped.push_back(std::format("catalog without '{}' in scene '{}'", catalog.hasFile ? "object" : "file", sceneData.name)); continue; }
+
+            scene.catalogs.push_back(intern(catalog.file));
+            scene.catalogs.push_back(intern(catalog.object));
+        }
+
+        set.scenes.push_back(std::move(scene));
+    }
+
+    return set;
+}
+
+// the whole file in memory
+inline std::vector<unsigned char> serializeBinaryScenes(const BinarySceneSet& set) {
+    std::vector<unsigned char> bytes(sizeof(BinarySceneHeader) + set.scenes.size() * sizeof(BinarySceneRecord));
+
+    // returns where the data went
+    auto append = [&bytes](const void* data, const size_t& size) {
+        bytes.resize((bytes.size() + 7) & ~(size_t)7);
+        uint64_t offset = bytes.size();
+
+        bytes.resize(offset + size);
+        if (size) { std::memcpy(bytes.data() + offset, data, size); }
+
+        return offset;
+    };
+    auto appendColumn = [&append](const auto& column) { return append(column.data(), column.size() * sizeof(column[0])); };
+
+    std::vector<BinarySceneRecord> records;
+    records.reserve(set.scenes.size());
+
+    for (const BinarySceneData& scene : set.scenes) {
+        BinarySceneRecord record = {};
+        record.name = scene.name;
+        record.bodyCount = scene.objects.size();
+        record.groupCount = scene.groupOffsets.size() - 1;
+        record.groupMemberCount = scene.groupMembers.size();
+
+        record.objects = appendColumn(scene.objects);
+        record.positions = appendColumn(scene.positions);
+        record.velocities = appendColumn(scene.velocities);
+        record.masses = appendColumn(scene.masses);
+        record.radii = appendColumn(scene.radii);
+        record.groupOffsets = appendColumn(scene.groupOffsets);
+        record.groupMembers = appendColumn(scene.groupMembers);
+        record.catalogCount = scene.catalogs.size() / 2;
+        record.catalogs = appendColumn(scene.catalogs);
+
+        records.push_back(record);
+    }
+
+    std::vector<uint64_t> stringOffsets = { 0 };
+    std::string stringData;
+    for (const std::string& text : set.strings) {
+        stringData += text;
+        stringOffsets.push_back(stringData.size());
+    }
+
+    BinarySceneHeader header = {};
+    std::memcpy(header.magic, BINARY_SCENE_MAGIC, sizeof(header.magic));
+    header.version = BINARY_SCENE_VERSION;
+    header.byteOrder = BINARY_SCENE_BYTE_ORDER;
+    header.orbit[0] = set.orbit.x;
+    header.orbit[1] = set.orbit.y;
+    header.orbit[2] = set.orbit.z;
+    header.sceneCount = set.scenes.size();
+    header.stringCount = set.strings.size();
+    header.scenes = sizeof(BinarySceneHeader);
+    header.stringOffsets = appendColumn(stringOffsets);
+    header.stringData = append(stringData.data(), stringData.size());
+    header.fileSize = bytes.size();
+
+    std::memcpy(bytes.data(), &header, sizeof(header));
+    if (!records.empty()) { std::memcpy(bytes.data() + header.scenes, records.data(), records.size() * sizeof(BinarySceneRecord)); }
+
+    return bytes;
+}
+
+inline void writeBinaryScenes(const std::filesystem::path& path, const BinarySceneSet& set) {
+    std::vector<unsigned char> bytes = serializeBinaryScenes(set);
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write((const char*)bytes.data(), bytes.size());
+
+    if (!file) { throw std::runtime_error(std::format("could not write '{}'", formatPath(path.string()))); }
+}
+
+// -----------------===[ Loading ]===-----------------
+
+// one scene's columns, pointing into the mapping
+struct BinarySceneView {
+    std::string_view name;
+
+    uint32_t bodyCount, groupCount, catalogCount;
+
+    const uint32_t* objects;
+    const glm::dvec3* positions;
+    const glm::dvec3* velocities;
+    const double* masses;
+    const double* radii;
+    const uint32_t* groupOffsets;
+    const uint32_t* groupMembers;
+    const uint32_t* catalogs;
+
+    bool hasVelocity(const uint32_t& body) const { return !std::isnan(velocities[body].x); }
+};
+
+/**
+ * @brief Memory mapped .simscene file. The whole file is checked when it's opened (throws std::invalid_argument),
+ * after that every range and index in it can be trusted. Columns are read straight from the mapping - keep the file
+ * alive while using them.
+ */
+class BinarySceneFile {
+    public:
+        explicit BinarySceneFile(const std::filesystem::path& path) : file(path) {
+            if (!file.isOpen()) { throw std::invalid_argument(std::format("could not open '{}'", formatPath(path.string()))); }
+
+            try { validate(); }
+            catch (const std::exception& e) {
+                throw std::invalid_argument(std::format("'{}' {}", formatPath(path.filename().string()), e.what()));
+            }
+        }
+
+        glm::dvec3 orbit() const { return glm::dvec3(header().orbit[0], header().orbit[1], header().orbit[2]); }
+
+        size_t sceneCount() const { return header().sceneCount; }
+        size_t stringCount() const { return header().stringCount; }
+
+        std::string_view string(const uint32_t& index) const {
+            const uint64_t* offsets = at<uint64_t>(header().stringOffsets);
+            return std::string_view((const char*)file.bytes() + header().stringData + offsets[index], offsets[index + 1] - offsets[index]);
+        }
+
+        BinarySceneView scene(const size_t& index) const {
+            const BinarySceneRecord& record = at<BinarySceneRecord>(header().scenes)[index];
+
+            return {
+                string(record.name),
+                record.bodyCount, record.groupCount, record.catalogCount,
+                at<uint32_t>(record.objects),
+                at<glm::dvec3>(record.positions),
+                at<glm::dvec3>(record.velocities),
+                at<double>(record.masses),
+                at<double>(record.radii),
+                at<uint32_t>(record.groupOffsets),
+                at<uint32_t>(record.groupMembers),
+                at<uint32_t>(record.catalogs)
+            };
+        }
+
+        size_t size() const { return file.size(); }
+
+    private:
+        MappedFile file;
+
+        const BinarySceneHeader& header() const { return *at<BinarySceneHeader>(0); }
+
+        template <typename T>
+        const T* at(const uint64_t& offset) const { return (const T*)(file.bytes() + offset); }
+
+        // count elements of T at offset lie inside the file and are aligned
+        bool inside(const uint64_t& offset, const uint64_t& count, const size_t& elementSize) const {
+            return offset % 8 == 0 && offset <= file.size() && count <= (file.size() - offset) / elementSize;
+        }
+
+        void validate() const {
+            if (file.size() < sizeof(BinarySceneHeader)) { throw std::invalid_argument("is too short for a scene file"); }
+
+            const BinarySceneHeader& head = header();
+            if (std::memcmp(head.magic, BINARY_SCENE_MAGIC, sizeof(head.magic)) != 0) { throw std::invalid_argument("is not a scene file"); }
+            if (head.byteOrder != BINARY_SCENE_BYTE_ORDER) { throw std::invalid_argument("was written on a machine of the other byte order"); }
+            if (head.version != BINARY_SCENE_VERSION) { throw std::invalid_argument(std::format("has version {}, expected {} - convert it again", head.version, BINARY_SCENE_VERSION)); }
+            if (head.fileSize != file.size()) { throw std::invalid_argument(std::format("is {} bytes, its header says {} - the file is truncated", file.size(), head.fileSize)); }
+
+            // strings
+            if (!inside(head.stringOffsets, (uint64_t)head.stringCount + 1, sizeof(uint64_t))) { throw std::invalid_argument("has a bad string table"); }
+
+            const uint64_t* offsets = at<uint64_t>(head.stringOffsets);
+            if (head.stringData > file.size() || offsets[0] != 0) { throw std::invalid_argument("has a bad string table"); }
+            for (uint32_t i = 0; i < head.stringCount; ++i) {
+                if (offsets[i + 1] < offsets[i] || offsets[i + 1] > file.size() - head.stringData) { throw std::invalid_argument("has a bad string table"); }
+            }
+
+            // scenes
+            if (!inside(head.scenes, head.sceneCount, sizeof(BinarySceneRecord))) { throw std::invalid_argument("has a bad scene table"); }
+
+            for (uint32_t i = 0; i < head.sceneCount; ++i) {
+                const BinarySceneRecord& record = at<BinarySceneRecord>(head.scenes)[i];
+                auto fail = [&](const std::string& what) { return std::invalid_argument(std::format("scene {}: {}", i, what)); };
+
+                if (record.name >= head.stringCount) { throw fail("bad name"); }
+
+                if (!inside(record.objects, record.bodyCount, sizeof(uint32_t)) || !inside(record.positions, record.bodyCount, sizeof(glm::dvec3))
+                    || !inside(record.velocities, record.bodyCount, sizeof(glm::dvec3)) || !inside(record.masses, record.bodyCount, sizeof(double))
+                    || !inside(record.radii, record.bodyCount, sizeof(double)) || !inside(record.groupOffsets, (uint64_t)record.groupCount + 1, sizeof(uint32_t))
+                    || !inside(record.groupMembers, record.groupMemberCount, sizeof(uint32_t)) || !inside(record.catalogs, (uint64_t)record.catalogCount * 2, sizeof(uint32_t))) {
+                    throw fail("column outside of the file");
+                }
+
+                const uint32_t* objects = at<uint32_t>(record.objects);
+                for (uint32_t body = 0; body < record.bodyCount; ++body) {
+                    if (objects[body] >= head.stringCount) { throw fail("bad object name"); }
+                }
+
+                const uint32_t* groupOffsets = at<uint32_t>(record.groupOffsets);
+                if (groupOffsets[0] != 0 || groupOffsets[record.groupCount] != record.groupMemberCount) { throw fail("bad group ranges"); }
+                for (uint32_t group = 0; group < record.groupCount; ++group) {
+                    if (groupOffsets[group + 1] < groupOffsets[group]) { throw fail("bad group ranges"); }
+                }
+
+                const uint32_t* groupMembers = at<uint32_t>(record.groupMembers);
+                for (uint32_t member = 0; member < record.groupMemberCount; ++member) {
+                    if (groupMembers[member] >= record.bodyCount) { throw fail("group member out of range"); }
+                }
+
+                const uint32_t* catalogs = at<uint32_t>(record.catalogs);
+                for (uint64_t string = 0; string < (uint64_t)record.catalogCount * 2; ++string) {
+                    if (catalogs[string] >= head.stringCount) { throw fail("bad catalog name"); }
+                }
+            }
+        }
+};
+
+// -----------------===[ Round trip ]===-----------------
+
+// first difference between what was converted and what reads back from the file, empty if there is none
+inline std::string compareBinaryScenes(const BinarySceneFile& file, const BinarySceneSet& set) {
+    // bitwise, so NaN velocities compare equal
+    auto same = [](const auto* stored, const auto& expected) {
+        return expected.empty() || std::memcmp(stored, expected.data(), expected.size() * sizeof(expected[0])) == 0;
+    };
+
+    if (file.orbit() != set.orbit) { return "orbit vector differs"; }
+    if (file.stringCount() != set.strings.size()) { return std::format("{} strings, expected {}", file.stringCount(), set.strings.size()); }
+    for (uint32_t i = 0; i < set.strings.size(); ++i) {
+        if (file.string(i) != set.strings[i]) { return std::format("string {} is '{}', expected '{}'", i, file.string(i), set.strings[i]); }
+    }
+
+    if (file.sceneCount() != set.scenes.size()) { return std::format("{} scenes, expected {}", file.sceneCount(), set.scenes.size()); }
+
+    for (size_t i = 0; i < set.scenes.size(); ++i) {
+        const BinarySceneData& expected = set.scenes[i];
+        BinarySceneView scene = file.scene(i);
+        const std::string& name = set.strings[expected.name];
+
+        if (scene.name != name) { return std::format("scene {} is '{}', expected '{}'", i, scene.name, name); }
+        if (scene.bodyCount != expected.objects.size()) { return std::format("scene '{}' has {} bodies, expected {}", name, scene.bodyCount, expected.objects.size()); }
+        if (scene.groupCount != expected.groupOffsets.size() - 1) { return std::format("scene '{}' has {} groups, expected {}", name, scene.groupCount, expected.groupOffsets.size() - 1); }
+
+        if (!same(scene.objects, expected.objects)) { return std::format("scene '{}': object names differ", name); }
+        if (!same(scene.positions, expected.positions)) { return std::format("scene '{}': positions differ", name); }
+        if (!same(scene.velocities, expected.velocities)) { return std::format("scene '{}': velocities differ", name); }
+        if (!same(scene.masses, expected.masses)) { return std::format("scene '{}': masses differ", name); }
+        if (!same(scene.radii, expected.radii)) { return std::format("scene '{}': radii differ", name); }
+        if (!same(scene.groupOffsets, expected.groupOffsets) || !same(scene.groupMembers, expected.groupMembers)) { return std::format("scene '{}': groups differ", name); }
+        if (scene.catalogCount != expected.catalogs.size() / 2 || !same(scene.catalogs, expected.catalogs)) { return std::format("scene '{}': catalogs differ", name); }
+    }
+
+    return "";
+}
+
+#endif // BINARY_SCENE_HEADER
@@ -0,0 +1,572 @@
+#ifndef CATALOG_PAGING_HEADER
+#define CATALOG_PAGING_HEADER
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <unordered_map>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include <globals.hpp>
+#include <arena.hpp>
+#include <mappedFile.hpp>
+#include <orbitCatalog.hpp>
+#include <simObject.hpp>
+#include <threadPool.hpp>
+#include <FormatConsole.hpp>
+
+/**
+ * Catalogs too large to keep every body in memory are paged by tiles.
+ *
+ * Tile file (.simtiles, kept in cache/catalogs) - the catalog's orbits sorted along an octree over the bodies' positions
+ * at the catalog's epoch:
+ *
+ *   header | octree nodes | element columns (in tile order) | name offsets | name data
+ *
+ * Children of a node are stored next to each other and every node covers one contiguous run of bodies, so a tile (leaf)
+ * is read as plain column slices straight from the mapping. Like .simscene files, numbers are in the writer's byte order
+ * and the whole file is checked when it's opened.
+ */
+
+inline constexpr char CATALOG_TILES_MAGIC[8] = { 'S', 'I', 'M', 'T', 'I', 'L', 'E', 'S' };
+inline constexpr uint32_t CATALOG_TILES_VERSION = 1;
+inline constexpr uint32_t CATALOG_TILES_BYTE_ORDER = 0x01020304;
+
+// what a resident body costs - the object, its model instance and arena slack (estimate until the first tile is in)
+inline constexpr size_t catalogBodyMemory = sizeof(simulationObject) + sizeof(Model) + 64;
+
+struct CatalogTilesHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint64_t fileSize;
+
+    uint32_t bodyCount;
+    uint32_t nodeCount;
+    uint32_t tileBodies;    // most bodies of a tile the file was built with
+    uint32_t reserved;
+
+    uint64_t nodes;         // CatalogTileNode[nodeCount], the root first
+    uint64_t elements[6];   // double[bodyCount] each - the OrbitElements columns (semi-major axis ... mean anomaly)
+    uint64_t nameOffsets;   // uint64_t[bodyCount + 1]
+    uint64_t nameData;
+};
+
+struct CatalogTileNode {
+    double center[3];       // km from the attractor
+    double halfSize;
+    uint32_t bodyBegin, bodyCount;
+    uint32_t firstChild, childCount; // a node without children is a tile
+};
+
+static_assert(sizeof(CatalogTilesHeader) % 8 == 0 && sizeof(CatalogTileNode) % 8 == 0, "tile file records have to keep the columns aligned");
+
+// -----------------===[ Building ]===-----------------
+
+inline std::vector<unsigned char> serializeCatalogTiles(const OrbitCatalog& catalog, const uint32_t& tileBodies, ThreadPool* pool = nullptr) {
+    const size_t count = catalog.size();
+    if (count > std::numeric_limits<uint32_t>::max()) { throw std::invalid_argument("catalog has too many bodies for a tile file"); }
+
+    // where the bodies are at the epoch - the gravitational parameter only scales velocities, which aren't needed
+    std::vector<glm::dvec3> positions(count);
+    catalogStateVectors(catalog.elements(), 1.0, positions.data(), nullptr, pool);
+
+    glm::dvec3 low(0.0), high(0.0);
+    for (const glm::dvec3& position : positions) { low = glm::min(low, position); high = glm::max(high, position); }
+
+    std::vector<uint32_t> order(count);
+    for (uint32_t i = 0; i < count; ++i) { order[i] = i; }
+
+    glm::dvec3 extent = high - low;
+
+    std::vector<CatalogTileNode> nodes;
+    nodes.push_back({ { (low.x + high.x) / 2, (low.y + high.y) / 2, (low.z + high.z) / 2 }, std::max({ extent.x, extent.y, extent.z }) / 2 + 1.0, 0, (uint32_t)count, 0, 0 });
+
+    // octants are split until a node holds a tile's worth of bodies - depth is capped for bodies sharing one spot
+    std::function<void(const uint32_t&, const unsigned int&)> split = [&](const uint32_t& index, const unsigned int& depth) {
+        CatalogTileNode node = nodes[index];
+        if (node.bodyCount <= std::max(tileBodies, 1u) || depth == 24) { return; }
+
+        glm::dvec3 center(node.center[0], node.center[1], node.center[2]);
+        auto octant = [&](const uint32_t& body) { return (positions[body].x >= center.x) | ((positions[body].y >= center.y) << 1) | ((positions[body].z >= center.z) << 2); };
+
+        std::array<uint32_t, 9> offsets{};
+        for (uint32_t i = node.bodyBegin; i < node.bodyBegin + node.bodyCount; ++i) { offsets[octant(order[i]) + 1]++; }
+        for (int k = 0; k < 8; ++k) { offsets[k + 1] += offsets[k]; }
+
+        std::vector<uint32_t> sorted(node.bodyCount);
+        std::array<uint32_t, 8> next;
+        std::copy(offsets.begin(), offsets.begin() + 8, next.begin());
+        for (uint32_t i = node.bodyBegin; i < node.bodyBegin + node.bodyCount; ++i) { sorted[next[octant(order[i])]++] = order[i]; }
+        std::copy(sorted.begin(), sorted.end(), order.begin() + node.bodyBegin);
+
+        uint32_t firstChild = nodes.size();
+        for (int k = 0; k < 8; ++k) {
+            if (offsets[k + 1] == offsets[k]) { continue; }
+
+            double quarter = node.halfSize / 2;
+            nodes.push_back({ { center.x + ((k & 1) ? quarter : -quarter), center.y + ((k & 2) ? quarter : -quarter), center.z + ((k & 4) ? quarter : -quarter) },
+                              quarter, node.bodyBegin + offsets[k], offsets[k + 1] - offsets[k], 0, 0 });
+        }
+
+        nodes[index].firstChild = firstChild;
+        nodes[index].childCount = nodes.size() - firstChild;
+
+        for (uint32_t child = firstChild; child < firstChild + nodes[index].childCount; ++child) { split(child, depth + 1); }
+    };
+    split(0, 0);
+
+    // -- layout --
+    std::vector<unsigned char> bytes(sizeof(CatalogTilesHeader));
+
+    auto append = [&bytes](const void* data, const size_t& size) {
+        bytes.resize((bytes.size() + 7) & ~(size_t)7, 0);
+        uint64_t offset = bytes.size();
+        bytes.insert(bytes.end(), (const unsigned char*)data, (const unsigned char*)data + size);
+        return offset;
+    };
+
+    CatalogTilesHeader header{};
+    std::memcpy(header.magic, CATALOG_TILES_MAGIC, sizeof(header.magic));
+    header.version = CATALOG_TILES_VERSION;
+    header.byteOrder = CATALOG_TILES_BYTE_ORDER;
+    header.bodyCount = count;
+    header.nodeCount = nodes.size();
+    header.tileBodies = tileBodies;
+    header.nodes = append(nodes.data(), nodes.size() * sizeof(CatalogTileNode));
+
+    const std::vector<double>* columns[6] = { &catalog.semiMajorAxis, &catalog.eccentricity, &catalog.inclination, &catalog.ascendingNode, &catalog.periapsis, &catalog.meanAnomaly };
+    std::vector<double> column(count);
+    for (int k = 0; k < 6; ++k) {
+        for (size_t i = 0; i < count; ++i) { column[i] = (*columns[k])[order[i]]; }
+        header.elements[k] = append(column.data(), count * sizeof(double));
+    }
+
+    std::vector<uint64_t> nameOffsets(count + 1, 0);
+    std::string nameData;
+    for (size_t i = 0; i < count; ++i) {
+        nameData += catalog.names[order[i]];
+        nameOffsets[i + 1] = nameData.size();
+    }
+    header.nameOffsets = append(nameOffsets.data(), nameOffsets.size() * sizeof(uint64_t));
+    header.nameData = append(nameData.data(), nameData.size());
+    header.fileSize = bytes.size();
+
+    std::memcpy(bytes.data(), &header, sizeof(header));
+    return bytes;
+}
+
+// -----------------===[ Loading ]===-----------------
+
+/**
+ * @brief Memory mapped .simtiles file, checked as a whole when it's opened (throws std::invalid_argument).
+ * Element columns point into the mapping - keep the file alive while using them.
+ */
+class CatalogTileFile {
+    public:
+        explicit CatalogTileFile(const std::filesystem::path& path) : file(path) {
+            if (!file.isOpen()) { throw std::invalid_argument(std::format("could not open '{}'", formatPath(path.string()))); }
+
+            try { validate(); }
+            catch (const std::exception& e) {
+                throw std::invalid_argument(std::format("'{}' {}", formatPath(path.filename().string()), e.what()));
+            }
+        }
+
+        size_t bodyCount() const { return header().bodyCount; }
+        size_t nodeCount() const { return header().nodeCount; }
+        uint32_t tileBodies() const { return header().tileBodies; }
+
+        const CatalogTileNode& node(const uint32_t& index) const { return at<CatalogTileNode>(header().nodes)[index]; }
+
+        OrbitElements elements(const uint32_t& begin, const uint32_t& count) const {
+            const CatalogTilesHeader& head = header();
+            return { at<double>(head.elements[0]) + begin, at<double>(head.elements[1]) + begin, at<double>(head.elements[2]) + begin,
+                     at<double>(head.elements[3]) + begin, at<double>(head.elements[4]) + begin, at<double>(head.elements[5]) + begin, count };
+        }
+
+        std::string_view name(const uint32_t& body) const {
+            const uint64_t* offsets = at<uint64_t>(header().nameOffsets);
+            return std::string_view((const char*)file.bytes() + header().nameData + offsets[body], offsets[body + 1] - offsets[body]);
+        }
+
+    private:
+        MappedFile file;
+
+        const CatalogTilesHeader& header() const { return *at<CatalogTilesHeader>(0); }
+
+        template <typename T>
+        const T* at(const uint64_t& offset) const { return (const T*)(file.bytes() + offset); }
+
+        bool inside(const uint64_t& offset, const uint64_t& count, const size_t& elementSize) const {
+            return offset % 8 == 0 && offset <= file.size() && count <= (file.size() - offset) / elementSize;
+        }
+
+        void validate() const {
+            if (file.size() < sizeof(CatalogTilesHeader)) { throw std::invalid_argument("is too short for a tile file"); }
+
+            const CatalogTilesHeader& head = header();
+            if (std::memcmp(head.magic, CATALOG_TILES_MAGIC, sizeof(head.magic)) != 0) { throw std::invalid_argument("is not a tile file"); }
+            if (head.byteOrder != CATALOG_TILES_BYTE_ORDER) { throw std::invalid_argument("was written on a machine of the other byte order"); }
+            if (head.version != CATALOG_TILES_VERSION) { throw std::invalid_argument(std::format("has version {}, expected {}", head.version, CATALOG_TILES_VERSION)); }
+            if (head.fileSize != file.size()) { throw std::invalid_argument(std::format("is {} bytes, its header says {} - the file is truncated", file.size(), head.fileSize)); }
+
+            for (const uint64_t& column : head.elements) {
+                if (!inside(column, head.bodyCount, sizeof(double))) { throw std::invalid_argument("has a bad element column"); }
+            }
+
+            if (!inside(head.nameOffsets, (uint64_t)head.bodyCount + 1, sizeof(uint64_t)) || head.nameData > file.size()) { throw std::invalid_argument("has a bad name table"); }
+            const uint64_t* offsets = at<uint64_t>(head.nameOffsets);
+            if (offsets[0] != 0) { throw std::invalid_argument("has a bad name table"); }
+            for (uint32_t i = 0; i < head.bodyCount; ++i) {
+                if (offsets[i + 1] < offsets[i] || offsets[i + 1] > file.size() - head.nameData) { throw std::invalid_argument("has a bad name table"); }
+            }
+
+            // children always come after their parent, so the tree can't loop
+            if (head.nodeCount == 0 || !inside(head.nodes, head.nodeCount, sizeof(CatalogTileNode))) { throw std::invalid_argument("has a bad node table"); }
+            for (uint32_t i = 0; i < head.nodeCount; ++i) {
+                const CatalogTileNode& current = node(i);
+                if (current.bodyBegin > head.bodyCount || current.bodyCount > head.bodyCount - current.bodyBegin) { throw std::invalid_argument(std::format("node {}: bad body range", i)); }
+                if (current.childCount && (current.childCount > 8 || current.firstChild <= i || current.firstChild > head.nodeCount - current.childCount)) { throw std::invalid_argument(std::format("node {}: bad children", i)); }
+
+                // children split the parent's bodies between them, one run after another
+                uint32_t next = current.bodyBegin;
+                for (uint32_t child = current.firstChild; child < current.firstChild + current.childCount; ++child) {
+                    if (node(child).bodyBegin != next) { throw std::invalid_argument(std::format("node {}: children don't cover its bodies", i)); }
+                    next += node(child).bodyCount;
+                }
+                if (current.childCount && next != current.bodyBegin + current.bodyCount) { throw std::invalid_argument(std::format("node {}: children don't cover its bodies", i)); }
+            }
+        }
+};
+
+// tile file of a catalog (res/<file>) in the cache - made the same for every scene using the catalog
+inline std::filesystem::path catalogTilesName(const std::string& file) {
+    std::string name = file;
+    std::replace(name.begin(), name.end(), '/', '_');
+    std::replace(name.begin(), name.end(), '\\', '_');
+    return name + ".simtiles";
+}
+
+// null if there's no tile file, it's older than the catalog, was built with another tile size or doesn't read back
+inline std::shared_ptr<const CatalogTileFile> openCatalogTiles(const std::filesystem::path& tilesPath, const std::filesystem::path& catalogPath, const uint32_t& tileBodies) {
+    std::error_code error;
+    auto tilesTime = std::filesystem::last_write_time(tilesPath, error);
+    if (error || tilesTime < std::filesystem::last_write_time(catalogPath, error) || error) { return nullptr; }
+
+    try {
+        auto tiles = std::make_shared<const CatalogTileFile>(tilesPath);
+        return tiles->tileBodies() == tileBodies ? tiles : nullptr;
+    }
+    catch (const std::exception&) { return nullptr; }
+}
+
+// throws if the file can't be written or doesn't read back
+inline std::shared_ptr<const CatalogTileFile> buildCatalogTiles(const OrbitCatalog& catalog, const std::filesystem::path& tilesPath, const uint32_t& tileBodies, ThreadPool* pool = nullptr) {
+    std::vector<unsigned char> bytes = serializeCatalogTiles(catalog, tileBodies, pool);
+
+    std::filesystem::create_directories(tilesPath.parent_path());
+    {
+        std::ofstream file(tilesPath, std::ios::binary | std::ios::trunc);
+        file.write((const char*)bytes.data(), bytes.size());
+        if (!file) { throw std::runtime_error(std::format("could not write '{}'", formatPath(tilesPath.string()))); }
+    }
+
+    return std::make_shared<const CatalogTileFile>(tilesPath);
+}
+
+// -----------------===[ Paging ]===-----------------
+
+// what PagedCatalog::update needs to know about the frame - taken on the main thread, copied into the tile loads
+struct CatalogPagingFrame {
+    glm::dvec3 focus;                   // km, relative to the attractor
+    glm::dvec3 attractorPosition, attractorVelocity;
+    double time;                        // seconds since the catalog's epoch
+    double gravitationalParameter;      // km³/s²
+    size_t memoryBudget;                // bytes
+    std::function<void(simulationObject*, const size_t&)> prepareBody; // called on a worker with every paged in body and its index in the catalog
+};
+
+/**
+ * @brief Keeps the tiles of a catalog closest to the camera resident, within a memory budget.
+ *
+ * A few sample bodies of every tile are propagated to the current time (a window of them per frame) and tiles are
+ * ranked by their nearest sample. Missing tiles are read and turned into bodies on the worker pool - each tile in an
+ * arena of its own - and handed over through mainThreadCompletions; tiles that fall out of the wanted set are evicted
+ * least recently wanted first when room is needed. Evicted tiles are only retired: they stay alive until the scene
+ * stopped listing their bodies (releaseRetired). Tiles that aren't resident are drawn as their samples.
+ *
+ * Main thread only. Loads in flight hold the tile file and a weak reference, so the catalog can go away at any time.
+ */
+class PagedCatalog : public std::enable_shared_from_this<PagedCatalog> {
+    public:
+        simulationObject* master;       // object every body is an instance of
+        simulationObject* attractor;    // the scene's instance of the body they orbit
+        size_t testGroup;               // index of the catalog's group in the scene's testParticles
+
+        PagedCatalog(std::shared_ptr<const CatalogTileFile> tiles, simulationObject* master, simulationObject* attractor, const size_t& testGroup)
+            : master(master), attractor(attractor), testGroup(testGroup), tiles(std::move(tiles))
+        {
+            for (uint32_t i = 0; i < this->tiles->nodeCount(); ++i) {
+                if (this->tiles->node(i).childCount == 0 && this->tiles->node(i).bodyCount) { leaves.push_back(i); }
+            }
+
+            // samples are spread over each tile - their elements are copied, so refreshing them doesn't touch the mapping
+            for (size_t leaf = 0; leaf < leaves.size(); ++leaf) {
+                const CatalogTileNode& node = this->tiles->node(leaves[leaf]);
+                uint32_t count = std::min(node.bodyCount, samplesPerTile);
+
+                for (uint32_t k = 0; k < count; ++k) {
+                    uint32_t body = node.bodyBegin + (uint32_t)((uint64_t)k * node.bodyCount / count);
+                    OrbitElements element = this->tiles->elements(body, 1);
+
+                    sampleColumns[0].push_back(*element.semiMajorAxis);
+                    sampleColumns[1].push_back(*element.eccentricity);
+                    sampleColumns[2].push_back(*element.inclination);
+                    sampleColumns[3].push_back(*element.ascendingNode);
+                    sampleColumns[4].push_back(*element.periapsis);
+                    sampleColumns[5].push_back(*element.meanAnomaly);
+                    sampleLeaves.push_back(leaf);
+                }
+            }
+
+            samples.resize(sampleLeaves.size());
+            catalogStateVectors(sampleElements(0, samples.size()), 1.0, samples.data(), nullptr);
+
+            state.assign(leaves.size(), TileState::absent);
+        }
+
+        PagedCatalog(const PagedCatalog&) = delete;
+        PagedCatalog& operator=(const PagedCatalog&) = delete;
+
+        /**
+         * @brief Ranks the tiles around the focus, starts the loads that fit the budget and retires what has to make room.
+         * @return True if the resident set changed since the last call (tiles arrived or were retired).
+         */
+        bool update(const CatalogPagingFrame& frame) {
+            ++frameCounter;
+
+            // a window of samples per frame - cheap no matter how many tiles the catalog has
+            size_t window = std::min(samplesPerFrame, samples.size());
+            for (size_t done = 0; done < window; ) {
+                size_t count = std::min(window - done, samples.size() - sampleCursor);
+                catalogStateVectors(sampleElements(sampleCursor, count), frame.gravitationalParameter, samples.data() + sampleCursor, nullptr, nullptr, frame.time);
+
+                done += count;
+                sampleCursor = (sampleCursor + count) % samples.size();
+            }
+
+            std::vector<double> distances(leaves.size(), std::numeric_limits<double>::max());
+            for (size_t k = 0; k < samples.size(); ++k) {
+                distances[sampleLeaves[k]] = std::min(distances[sampleLeaves[k]], glm::distance(samples[k], frame.focus));
+            }
+
+            std::vector<uint32_t> ranked(leaves.size());
+            for (uint32_t i = 0; i < ranked.size(); ++i) { ranked[i] = i; }
+            std::sort(ranked.begin(), ranked.end(), [&distances](const uint32_t& a, const uint32_t& b) { return distances[a] < distances[b]; });
+
+            // the nearest tiles that fit the budget are wanted
+            size_t wantedMemory = 0;
+            std::vector<uint32_t> wanted;
+            for (const uint32_t& leaf : ranked) {
+                size_t memory = tileMemory(leaf);
+                if (wantedMemory + memory > frame.memoryBudget) { break; }
+
+                wantedMemory += memory;
+                wanted.push_back(leaf);
+                lastWanted[leaf] = frameCounter;
+            }
+
+            for (const uint32_t& leaf : wanted) {
+                if (state[leaf] != TileState::absent) { continue; }
+                if (loadsInFlight >= maxLoadsInFlight) { break; }
+
+                // room is made from the tiles that were wanted the longest time ago
+                while (residentMemory() + loadingMemory() + tileMemory(leaf) > frame.memoryBudget) {
+                    auto oldest = resident.end();
+                    for (auto candidate = resident.begin(); candidate != resident.end(); ++candidate) {
+                        if (lastWanted[candidate->first] == frameCounter) { continue; }
+                        if (oldest == resident.end() || lastWanted[candidate->first] < lastWanted[oldest->first]) { oldest = candidate; }
+                    }
+                    if (oldest == resident.end()) { break; }
+
+                    retire(oldest);
+                }
+
+                if (residentMemory() + loadingMemory() + tileMemory(leaf) > frame.memoryBudget) { break; }
+
+                startLoad(leaf, frame);
+            }
+
+            bool wasChanged = changed;
+            changed = false;
+            return wasChanged;
+        }
+
+        // bodies of every resident tile, in tile order
+        void residentBodies(std::vector<simulationObject*>& bodies) const {
+            for (const uint32_t& leaf : residentOrder()) {
+                const auto& tileBodies = resident.at(leaf)->bodies;
+                bodies.insert(bodies.end(), tileBodies.begin(), tileBodies.end());
+            }
+        }
+
+        // samples of the tiles that aren't resident (km, relative to the attractor) - what is drawn in their place
+        void forEachAggregate(const std::function<void(const glm::dvec3&)>& callback) const {
+            for (size_t k = 0; k < samples.size(); ++k) {
+                if (state[sampleLeaves[k]] != TileState::resident) { callback(samples[k]); }
+            }
+        }
+
+        // retires every tile and forgets the loads in flight (their results are thrown away when they land)
+        void clear() {
+            while (!resident.empty()) { retire(resident.begin()); }
+
+            for (TileState& tileState : state) { tileState = TileState::absent; }
+            loadsInFlight = 0;
+            ++generation;
+        }
+
+        // frees the retired tiles - only once nothing lists their bodies anymore
+        void releaseRetired() { retired.clear(); }
+
+        size_t residentMemory() const {
+            size_t total = 0;
+            for (const auto& [leaf, tile] : resident) { total += tile->memory; }
+            return total;
+        }
+
+        size_t tileCount() const { return leaves.size(); }
+        size_t residentTileCount() const { return resident.size(); }
+        size_t bodyCount() const { return tiles->bodyCount(); }
+
+    private:
+        struct ResidentTile {
+            Arena arena{ 1024 * 1024 }; // the bodies and their model instances
+            std::vector<simulationObject*> bodies;
+            size_t memory = 0;
+        };
+
+        enum class TileState : unsigned char { absent, loading, resident };
+
+        static constexpr uint32_t samplesPerTile = 8;
+        static constexpr size_t samplesPerFrame = 4096;
+        static constexpr size_t maxLoadsInFlight = 4;
+
+        std::shared_ptr<const CatalogTileFile> tiles;
+        std::vector<uint32_t> leaves;   // node index of every tile
+
+        std::vector<double> sampleColumns[6];
+        std::vector<uint32_t> sampleLeaves;
+        std::vector<glm::dvec3> samples;
+        size_t sampleCursor = 0;
+
+        std::vector<TileState> state;   // by leaf
+        std::unordered_map<uint32_t, std::shared_ptr<ResidentTile>> resident; // by leaf
+        std::unordered_map<uint32_t, uint64_t> lastWanted;                    // by leaf - frame the tile was last wanted in
+        std::vector<std::shared_ptr<ResidentTile>> retired;
+
+        size_t loadsInFlight = 0;
+        uint64_t frameCounter = 0;
+        uint64_t generation = 0;
+        bool changed = false;
+
+        // measured once tiles are resident
+        double bytesPerBody = catalogBodyMemory;
+
+        OrbitElements sampleElements(const size_t& first, const size_t& count) const {
+            return { sampleColumns[0].data() + first, sampleColumns[1].data() + first, sampleColumns[2].data() + first,
+                     sampleColumns[3].data() + first, sampleColumns[4].data() + first, sampleColumns[5].data() + first, count };
+        }
+
+        size_t tileMemory(const uint32_t& leaf) const { return (size_t)(tiles->node(leaves[leaf]).bodyCount * bytesPerBody); }
+
+        size_t loadingMemory() const {
+            size_t total = 0;
+            for (uint32_t leaf = 0; leaf < state.size(); ++leaf) { total += state[leaf] == TileState::loading ? tileMemory(leaf) : 0; }
+            return total;
+        }
+
+        std::vector<uint32_t> residentOrder() const {
+            std::vector<uint32_t> order;
+            order.reserve(resident.size());
+            for (const auto& [leaf, tile] : resident) { order.push_back(leaf); }
+            std::sort(order.begin(), order.end());
+            return order;
+        }
+
+        void retire(std::unordered_map<uint32_t, std::shared_ptr<ResidentTile>>::iterator tile) {
+            state[tile->first] = TileState::absent;
+            retired.push_back(std::move(tile->second));
+            resident.erase(tile);
+            changed = true;
+        }
+
+        void startLoad(const uint32_t& leaf, const CatalogPagingFrame& frame) {
+            state[leaf] = TileState::loading;
+            ++loadsInFlight;
+
+            std::weak_ptr<PagedCatalog> self = weak_from_this();
+            workerPool->submit([self, tiles = tiles, node = leaves[leaf], leaf, master = master, frame, generation = generation]() {
+                auto tile = std::make_shared<ResidentTile>();
+                loadTile(*tiles, tiles->node(node), *master, frame, *tile);
+
+                mainThreadCompletions.push([self, leaf, generation, tile]() {
+                    if (auto catalog = self.lock()) { catalog->arrive(leaf, generation, tile); }
+                });
+            });
+        }
+
+        // worker side - the tile's bodies at the frame's time, prepared for the scene
+        static void loadTile(const CatalogTileFile& tiles, const CatalogTileNode& node, const simulationObject& master, const CatalogPagingFrame& frame, ResidentTile& tile) {
+            std::vector<glm::dvec3> positions(node.bodyCount), velocities(node.bodyCount);
+            catalogStateVectors(tiles.elements(node.bodyBegin, node.bodyCount), frame.gravitationalParameter, positions.data(), velocities.data(), nullptr, frame.time);
+
+            tile.bodies.reserve(node.bodyCount);
+            for (uint32_t i = 0; i < node.bodyCount; ++i) {
+                simulationObject* body = tile.arena.create<simulationObject>(master, false);
+                body->model = tile.arena.create<Model>(*master.model, Model::Flags::MAKE_INSTANCE);
+
+                std::string_view name = tiles.name(node.bodyBegin + i);
+                if (!name.empty()) { body->name = name; }
+                body->position = frame.attractorPosition + positions[i];
+                body->velocity = frame.attractorVelocity + velocities[i];
+                body->testParticle = true;
+                body->setCurrentAsOriginal();
+
+                if (frame.prepareBody) { frame.prepareBody(body, node.bodyBegin + i); }
+
+                tile.bodies.push_back(body);
+            }
+
+            tile.memory = tile.arena.reserved() + tile.bodies.capacity() * sizeof(simulationObject*);
+        }
+
+        void arrive(const uint32_t& leaf, const uint64_t& tileGeneration, std::shared_ptr<ResidentTile> tile) {
+            if (tileGeneration != generation) { return; } // loaded for what was cleared since
+
+            --loadsInFlight;
+            state[leaf] = TileState::resident;
+            resident[leaf] = std::move(tile);
+            changed = true;
+
+            size_t bodies = 0;
+            for (const auto& [index, residentTile] : resident) { bodies += residentTile->bodies.size(); }
+            if (bodies) { bytesPerBody = (double)residentMemory() / bodies; }
+        }
+};
+
+#endif // CATALOG_PAGING_HEADER
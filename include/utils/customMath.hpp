@@ -53,4 +53,11 @@ inline glm::mat4 calcuculateModelMatrixFromPosition(const glm::vec3& position) {
     return glm::translate(glm::mat4(1.0f), position);
 }
 
+// radius of a sphere on screen in pixels (perspective projection, small angle approximation)
+inline float projectedRadiusInPixels(const float& radius, const float& distance, const float& fovDeg, const int& viewportHeight) {
+    if (distance <= radius) { return (float)viewportHeight; } // camera inside of the object
+
+    return (radius / distance) * (viewportHeight * 0.5f) / std::tan(glm::radians(fovDeg) * 0.5f);
+}
+
 #endif // CUSTOM_MATH_HEADER
\ No newline at end of file
@@ -0,0 +1,107 @@
+#ifndef FILE_WATCHER_HEADER
+#define FILE_WATCHER_HEADER
+
+#include <algorithm>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @brief Reports files that were saved since the last poll (inotify; does nothing on other platforms).
+ *
+ * Directories are watched rather than the files themselves - most editors save by writing a new file and renaming it
+ * over the old one, which would silently end a watch on the original file.
+ */
+class FileWatcher {
+    public:
+        FileWatcher() {
+#ifdef __linux__
+            descriptor = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+#endif
+        }
+
+        FileWatcher(const FileWatcher&) = delete;
+        FileWatcher& operator=(const FileWatcher&) = delete;
+
+        bool supported() const { return descriptor >= 0; }
+
+        bool watch(const std::filesystem::path& file) {
+            if (!supported()) { return false; }
+
+            std::filesystem::path directory = file.parent_path();
+            if (directory.empty()) { directory = "."; }
+
+            auto existing = std::find_if(directories.begin(), directories.end(), [&directory](const auto& entry) { return entry.second.path == directory; });
+            if (existing != directories.end()) {
+                existing->second.files.push_back(file.filename().string());
+                return true;
+            }
+
+#ifdef __linux__
+            int watchDescriptor = inotify_add_watch(descriptor, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+            if (watchDescriptor < 0) { return false; }
+
+            directories[watchDescriptor] = { directory, { file.filename().string() } };
+            return true;
+#else
+            return false;
+#endif
+        }
+
+        // watched files saved since the last call, each listed once - never blocks
+        std::vector<std::filesystem::path> changes() {
+            std::vector<std::filesystem::path> changed;
+
+#ifdef __linux__
+            if (!supported()) { return changed; }
+
+            alignas(inotify_event) char buffer[4096];
+            ssize_t length;
+
+            while ((length = read(descriptor, buffer, sizeof(buffer))) > 0) {
+                for (char* position = buffer; position < buffer + length; ) {
+                    const inotify_event* event = (const inotify_event*)position;
+                    position += sizeof(inotify_event) + event->len;
+
+                    auto directory = directories.find(event->wd);
+                    if (directory == directories.end() || event->len == 0) { continue; }
+
+                    std::string name = event->name;
+                    const auto& files = directory->second.files;
+                    if (std::find(files.begin(), files.end(), name) == files.end()) { continue; }
+
+                    std::filesystem::path path = directory->second.path / name;
+                    if (std::find(changed.begin(), changed.end(), path) == changed.end()) { changed.push_back(path); }
+                }
+            }
+#endif
+
+            return changed;
+        }
+
+        ~FileWatcher() {
+#ifdef __linux__
+            if (descriptor >= 0) { close(descriptor); }
+#endif
+        }
+
+    private:
+        struct WatchedDirectory {
+            std::filesystem::path path;
+            std::vector<std::string> files;
+        };
+
+        int descriptor = -1;
+        std::unordered_map<int, WatchedDirectory> directories; // by inotify watch descriptor
+};
+
+// created in loadSettings when hot reloading is on
+inline FileWatcher* fileWatcher = nullptr;
+
+#endif // FILE_WATCHER_HEADER
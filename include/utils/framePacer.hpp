@@ -0,0 +1,173 @@
+#ifndef FRAME_PACER_HEADER
+#define FRAME_PACER_HEADER
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <thread>
+
+#ifdef __linux__
+#include <cerrno>
+#include <time.h>
+#endif
+
+/**
+ * @brief Holds the frame rate to absolute deadlines.
+ *
+ * Every deadline is one period after the previous one (not after the frame started), so late wake-ups don't add up.
+ * The thread sleeps until shortly before the deadline (clock_nanosleep with TIMER_ABSTIME on Linux) and spins the rest.
+ * How much earlier it has to wake up is measured at runtime - the 99th percentile of how late the recent sleeps returned -
+ * so the spin only covers the wake-up latency the OS actually has, on any machine.
+ */
+class FramePacer {
+    public:
+        using clock = std::chrono::steady_clock;
+
+        // pacing error (how late the frame was released) bucket bounds in microseconds, the last bucket is everything above
+        static constexpr std::array<int64_t, 9> errorBuckets = { 5, 10, 25, 50, 100, 250, 500, 1'000, 2'000 };
+
+        std::array<uint64_t, errorBuckets.size() + 1> errorHistogram = {};
+        uint64_t pacedFrames = 0;
+        uint64_t missedFrames = 0; // work alone took longer than the period - nothing to wait for
+        clock::duration spun = clock::duration::zero();
+
+        /**
+         * @brief Waits until the next deadline.
+         *
+         * @param period Frame duration - a changed period starts over from now.
+         * @return When the frame was released.
+         */
+        clock::time_point wait(const std::chrono::nanoseconds& period) {
+            clock::time_point now = clock::now();
+
+            if (period != currentPeriod || deadline == clock::time_point()) {
+                currentPeriod = period;
+                deadline = now;
+            }
+
+            deadline += period;
+
+            // fell behind by more than a frame - catching up would only run frames back to back
+            if (deadline <= now) {
+                missedFrames++;
+                deadline = now;
+                return now;
+            }
+
+            if (!calibrated) { calibrate(); }
+
+            clock::time_point wakeUp = deadline - latency;
+            if (wakeUp > now) {
+                sleepUntil(wakeUp);
+                recordLatency(clock::now() - wakeUp);
+            }
+
+            clock::time_point spinStart = clock::now();
+            while (clock::now() < deadline) { std::this_thread::yield(); }
+
+            clock::time_point released = clock::now();
+            if (released > spinStart) { spun += released - spinStart; }
+
+            recordError(released - deadline);
+
+            return released;
+        }
+
+        // the next frame starts its period from now - after a pause the frame rate isn't made up for
+        void reset() { deadline = clock::time_point(); }
+
+        clock::duration wakeUpLatency() const { return latency; }
+
+        // error below which the given share of frames was released
+        std::chrono::microseconds errorPercentile(const double& share) const {
+            uint64_t total = 0;
+            for (uint64_t count : errorHistogram) { total += count; }
+            if (total == 0) { return std::chrono::microseconds(0); }
+
+            uint64_t needed = (uint64_t)std::ceil(total * share), counted = 0;
+            for (size_t i = 0; i < errorBuckets.size(); ++i) {
+                counted += errorHistogram[i];
+                if (counted >= needed) { return std::chrono::microseconds(errorBuckets[i]); }
+            }
+            return std::chrono::microseconds(errorBuckets.back() * 2);
+        }
+
+        void report(std::ostream& out) const {
+            using namespace std::chrono;
+
+            uint64_t total = 0;
+            for (uint64_t count : errorHistogram) { total += count; }
+
+            out << "frames " << pacedFrames << " paced, " << missedFrames << " over budget | wake-up latency " << duration<double, std::micro>(latency).count()
+                << " us | spun " << duration<double, std::milli>(spun).count() << " ms\n";
+
+            for (size_t i = 0; i <= errorBuckets.size(); ++i) {
+                if (i < errorBuckets.size()) { out << "  < " << errorBuckets[i] << " us\t"; }
+                else { out << " >= " << errorBuckets.back() << " us\t"; }
+
+                double share = total ? (double)errorHistogram[i] / total : 0.0;
+                out << std::string((size_t)(share * 40.0 + 0.5), '#') << " " << errorHistogram[i] << "\n";
+            }
+        }
+
+    private:
+        static constexpr size_t latencySamples = 128;
+
+        std::chrono::nanoseconds currentPeriod = std::chrono::nanoseconds(0);
+        clock::time_point deadline;
+
+        std::array<clock::duration, latencySamples> latencies = {};
+        size_t latencyCount = 0;
+        clock::duration latency = std::chrono::microseconds(100); // until there are measurements
+        bool calibrated = false;
+
+        static void sleepUntil(const clock::time_point& time) {
+#ifdef __linux__
+            // steady_clock is CLOCK_MONOTONIC on Linux
+            auto sinceEpoch = std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+            timespec target = { (time_t)(sinceEpoch / 1'000'000'000), (long)(sinceEpoch % 1'000'000'000) };
+
+            while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &target, nullptr) == EINTR) {}
+#else
+            std::this_thread::sleep_until(time);
+#endif
+        }
+
+        // a few short sleeps before the first frame, so the first frames aren't paced with a guess
+        void calibrate() {
+            for (int i = 0; i < 16; ++i) {
+                clock::time_point target = clock::now() + std::chrono::microseconds(200);
+                sleepUntil(target);
+                recordLatency(clock::now() - target);
+            }
+            calibrated = true;
+        }
+
+        void recordLatency(const clock::duration& sample) {
+            latencies[latencyCount++ % latencySamples] = std::max(sample, clock::duration::zero());
+
+            size_t count = std::min(latencyCount, latencySamples);
+            std::array<clock::duration, latencySamples> sorted = latencies;
+            auto percentile = sorted.begin() + (count * 99) / 100;
+            std::nth_element(sorted.begin(), percentile, sorted.begin() + count);
+
+            latency = *percentile;
+        }
+
+        void recordError(const clock::duration& error) {
+            int64_t microseconds = std::chrono::duration_cast<std::chrono::microseconds>(error).count();
+
+            size_t bucket = std::upper_bound(errorBuckets.begin(), errorBuckets.end(), microseconds) - errorBuckets.begin();
+            errorHistogram[bucket]++;
+            pacedFrames++;
+        }
+};
+
+// paces the main loop when VSync is off
+inline FramePacer framePacer;
+
+#endif // FRAME_PACER_HEADER
@@ -0,0 +1,197 @@
+#ifndef HANDLES_HEADER
+#define HANDLES_HEADER
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// -----------------===[ Interned strings ]===-----------------
+
+using StringID = uint32_t;
+
+inline constexpr StringID INVALID_STRING_ID = UINT32_MAX;
+
+/**
+ * @brief Gives every distinct string a small integer, so after loading names are compared and looked up as integers.
+ *
+ * Interned strings live until exit. Not synchronized - intern on the main thread (loading, GUI).
+ */
+class StringInterner {
+    public:
+        StringID intern(std::string_view text) {
+            auto found = ids.find(text);
+            if (found != ids.end()) { return found->second; }
+
+            StringID id = storage.size();
+            storage.emplace_back(text);
+            ids.emplace(storage.back(), id); // keyed by a view of the stored copy - deque never moves it
+
+            return id;
+        }
+
+        // INVALID_STRING_ID if the string was never interned
+        StringID find(std::string_view text) const {
+            auto found = ids.find(text);
+            return found != ids.end() ? found->second : INVALID_STRING_ID;
+        }
+
+        const std::string& str(const StringID& id) const {
+            static const std::string invalid = "<invalid>";
+            return id < storage.size() ? storage[id] : invalid;
+        }
+
+    private:
+        std::deque<std::string> storage;
+        std::unordered_map<std::string_view, StringID> ids;
+};
+
+inline StringInterner internedStrings;
+
+// -----------------===[ Handles ]===-----------------
+
+/**
+ * @brief Reference into a Registry - a slot index and the generation of that slot when the handle was made.
+ *
+ * Erasing an entry bumps its slot's generation, so old handles to it stop resolving instead of pointing at whatever reuses the slot.
+ */
+template <typename T>
+struct Handle {
+    uint32_t index = UINT32_MAX;
+    uint32_t generation = 0;
+
+    bool valid() const { return index != UINT32_MAX; }
+
+    // unique per handle - for keying maps by handle
+    uint64_t key() const { return ((uint64_t)generation << 32) | index; }
+
+    bool operator==(const Handle& other) const { return index == other.index && generation == other.generation; }
+    bool operator!=(const Handle& other) const { return !(*this == other); }
+};
+
+/**
+ * @brief Generational slot map with a name index (interned strings).
+ *
+ * Values are stored densely, so iterating is a walk over a contiguous array. Lookups by handle are two array reads,
+ * lookups by name hash the string and are meant for loading and the GUI only. Values are expected to be pointers
+ * (a stale or invalid handle resolves to nullptr); the registry doesn't own what they point to.
+ */
+template <typename T>
+class Registry {
+    public:
+        struct Entry {
+            Handle<T> handle;
+            T value;
+        };
+
+        // replaces the value if the name is already registered - the handle stays the same then
+        Handle<T> add(std::string_view name, T value) {
+            StringID nameID = internedStrings.intern(name);
+
+            auto existing = byName.find(nameID);
+            if (existing != byName.end()) {
+                entries[slots[existing->second.index].dense].value = value;
+                return existing->second;
+            }
+
+            uint32_t index;
+            if (!freeSlots.empty()) {
+                index = freeSlots.back();
+                freeSlots.pop_back();
+            }
+            else {
+                index = slots.size();
+                slots.push_back({ 0, 0, INVALID_STRING_ID });
+            }
+
+            Handle<T> handle = { index, slots[index].generation };
+
+            slots[index].dense = entries.size();
+            slots[index].name = nameID;
+            entries.push_back({ handle, value });
+            byName[nameID] = handle;
+
+            return handle;
+        }
+
+        bool erase(const Handle<T>& handle) {
+            if (!contains(handle)) { return false; }
+
+            Slot& slot = slots[handle.index];
+
+            // last entry takes the erased one's place
+            uint32_t dense = slot.dense;
+            entries[dense] = entries.back();
+            slots[entries[dense].handle.index].dense = dense;
+            entries.pop_back();
+
+            byName.erase(slot.name);
+            slot.generation++;
+            slot.name = INVALID_STRING_ID;
+            freeSlots.push_back(handle.index);
+
+            return true;
+        }
+
+        bool contains(const Handle<T>& handle) const {
+            return handle.index < slots.size() && slots[handle.index].generation == handle.generation && slots[handle.index].name != INVALID_STRING_ID;
+        }
+
+        // nullptr for stale or invalid handles
+        T get(const Handle<T>& handle) const {
+            return contains(handle) ? entries[slots[handle.index].dense].value : T();
+        }
+
+        T operator[](const Handle<T>& handle) const { return get(handle); }
+
+        // invalid handle if there is no such name - load time and GUI only
+        Handle<T> find(std::string_view name) const {
+            StringID nameID = internedStrings.find(name);
+            if (nameID == INVALID_STRING_ID) { return {}; }
+
+            auto found = byName.find(nameID);
+            return found != byName.end() ? found->second : Handle<T>();
+        }
+
+        bool contains(std::string_view name) const { return find(name).valid(); }
+
+        const std::string& name(const Handle<T>& handle) const {
+            return internedStrings.str(contains(handle) ? slots[handle.index].name : INVALID_STRING_ID);
+        }
+
+        size_t size() const { return entries.size(); }
+        bool empty() const { return entries.empty(); }
+
+        void clear() {
+            for (const Entry& entry : entries) {
+                Slot& slot = slots[entry.handle.index];
+                slot.generation++;
+                slot.name = INVALID_STRING_ID;
+                freeSlots.push_back(entry.handle.index);
+            }
+
+            entries.clear();
+            byName.clear();
+        }
+
+        typename std::vector<Entry>::iterator begin() { return entries.begin(); }
+        typename std::vector<Entry>::iterator end() { return entries.end(); }
+        typename std::vector<Entry>::const_iterator begin() const { return entries.begin(); }
+        typename std::vector<Entry>::const_iterator end() const { return entries.end(); }
+
+    private:
+        struct Slot {
+            uint32_t dense;
+            uint32_t generation;
+            StringID name; // INVALID_STRING_ID while the slot is free
+        };
+
+        std::vector<Entry> entries;
+        std::vector<Slot> slots;
+        std::vector<uint32_t> freeSlots;
+        std::unordered_map<StringID, Handle<T>> byName;
+};
+
+#endif // HANDLES_HEADER
@@ -0,0 +1,25 @@
+#ifndef HASH_UTILITY_HEADER
+#define HASH_UTILITY_HEADER
+
+#include <cstdint>
+#include <cstddef>
+#include <string_view>
+
+// FNV-1a - stable across runs and platforms (unlike std::hash), good enough for cache keys
+inline const uint64_t FNV_OFFSET_BASIS = 14695981039346656037ull;
+inline const uint64_t FNV_PRIME = 1099511628211ull;
+
+inline uint64_t fnv1a(const void* data, const size_t& size, uint64_t hash = FNV_OFFSET_BASIS) {
+    const unsigned char* bytes = (const unsigned char*)data;
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+inline uint64_t fnv1a(std::string_view text, uint64_t hash = FNV_OFFSET_BASIS) {
+    return fnv1a(text.data(), text.size(), hash);
+}
+
+#endif // HASH_UTILITY_HEADER
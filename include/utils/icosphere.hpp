@@ -0,0 +1,101 @@
+#ifndef ICOSPHERE_GENERATOR_HEADER
+#define ICOSPHERE_GENERATOR_HEADER
+
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+#include <unordered_map>
+
+#include <glm/glm.hpp>
+
+#include <types.hpp>
+
+/**
+ * @brief Generates a chain of icospheres, one per subdivision level.
+ *
+ * Starts from a regular icosahedron (20 triangles) and splits every triangle into four on each level,
+ * so level n has 20 * 4^n triangles. Vertices are pushed onto the sphere surface, which also makes them
+ * the (normalized) normals. Winding is counter-clockwise when viewed from outside.
+ *
+ * @param maxSubdivisions The finest level to generate (inclusive).
+ * @param radius Radius of the generated spheres in vertex units.
+ * @return ModelData for every level, ordered from the coarsest (level 0) to the finest.
+ */
+std::vector<ModelData> generateIcosphereLevels(const unsigned int maxSubdivisions, const float radius = 1.0f) {
+    const float t = (1.0f + std::sqrt(5.0f)) * 0.5f; // golden ratio
+
+    std::vector<glm::vec3> points = {
+        {-1,  t,  0}, { 1,  t,  0}, {-1, -t,  0}, { 1, -t,  0},
+        { 0, -1,  t}, { 0,  1,  t}, { 0, -1, -t}, { 0,  1, -t},
+        { t,  0, -1}, { t,  0,  1}, {-t,  0, -1}, {-t,  0,  1}
+    };
+    for (auto& point : points) { point = glm::normalize(point); }
+
+    std::vector<unsigned int> triangles = {
+        0, 11, 5,   0, 5, 1,    0, 1, 7,    0, 7, 10,   0, 10, 11,
+        1, 5, 9,    5, 11, 4,   11, 10, 2,  10, 7, 6,   7, 1, 8,
+        3, 9, 4,    3, 4, 2,    3, 2, 6,    3, 6, 8,    3, 8, 9,
+        4, 9, 5,    2, 4, 11,   6, 2, 10,   8, 6, 7,    9, 8, 1
+    };
+
+    auto exportLevel = [&]() {
+        ModelData level;
+        level.vertices.reserve(points.size() * 3);
+        level.normals.reserve(points.size() * 3);
+
+        for (const auto& point : points) {
+            level.vertices.insert(level.vertices.end(), {point.x * radius, point.y * radius, point.z * radius});
+            level.normals.insert(level.normals.end(), {point.x, point.y, point.z});
+        }
+        level.indices = triangles;
+        level.computeBounds();
+
+        return level;
+    };
+
+    std::vector<ModelData> levels;
+    levels.reserve(maxSubdivisions + 1);
+    levels.push_back(exportLevel());
+
+    for (unsigned int subdivision = 0; subdivision < maxSubdivisions; ++subdivision) {
+        // edges are shared by two triangles - cache the midpoints so they are only created once
+        std::unordered_map<uint64_t, unsigned int> midpoints;
+        midpoints.reserve(triangles.size());
+
+        auto midpoint = [&](unsigned int a, unsigned int b) {
+            uint64_t key = ((uint64_t)std::min(a, b) << 32) | std::max(a, b);
+
+            auto found = midpoints.find(key);
+            if (found != midpoints.end()) { return found->second; }
+
+            points.push_back(glm::normalize(points[a] + points[b]));
+            unsigned int index = points.size() - 1;
+            midpoints.emplace(key, index);
+
+            return index;
+        };
+
+        std::vector<unsigned int> subdivided;
+        subdivided.reserve(triangles.size() * 4);
+
+        for (size_t i = 0; i < triangles.size(); i += 3) {
+            unsigned int a = triangles[i], b = triangles[i + 1], c = triangles[i + 2];
+            unsigned int ab = midpoint(a, b), bc = midpoint(b, c), ca = midpoint(c, a);
+
+            subdivided.insert(subdivided.end(), {
+                a, ab, ca,
+                b, bc, ab,
+                c, ca, bc,
+                ab, bc, ca
+            });
+        }
+
+        triangles = std::move(subdivided);
+        levels.push_back(exportLevel());
+    }
+
+    return levels;
+}
+
+#endif // ICOSPHERE_GENERATOR_HEADER
@@ -0,0 +1,144 @@
+#ifndef LIGHT_CLUSTERS_HEADER
+#define LIGHT_CLUSTERS_HEADER
+
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+// light as seen by the cluster assignment - world position and the distance at which it stops mattering
+struct ClusterLight {
+    glm::vec3 position;
+    float range;
+};
+
+// distance at which a light's attenuated intensity drops below the cutoff (same attenuation as the shaders)
+inline float lightRange(const float& intensity, const float& falloff, const float& cutoff) {
+    if (intensity <= cutoff) { return 0.0f; }
+
+    float attenuationFactor = 0.1f * falloff * 0.01f;
+    if (attenuationFactor <= 0.0f) { return INFINITY; }
+
+    return std::sqrt((intensity / cutoff - 1.0f) / attenuationFactor);
+}
+
+/**
+ * @brief Assigns lights to view space clusters for clustered forward shading.
+ *
+ * The view frustum is split into tiles on screen and exponentially growing slices in depth.
+ * Every light is assigned to all clusters its (conservative) screen rectangle and depth range
+ * overlap, so fragments only have to go through the lights of their own cluster.
+ */
+class LightClusterGrid {
+    public:
+        glm::uvec3 dimensions;
+
+        std::vector<glm::uvec2> clusters;   // x - offset into lightIndices, y - amount of lights
+        std::vector<GLuint> lightIndices;   // indices into the light list, grouped per cluster
+
+        LightClusterGrid(const glm::uvec3& dimensions) : dimensions(dimensions) {
+            clusters.assign(clusterCount(), glm::uvec2(0));
+        }
+
+        size_t clusterCount() const { return (size_t)dimensions.x * dimensions.y * dimensions.z; }
+
+        // expects a symmetric perspective projection (glm::perspective)
+        void assign(const std::vector<ClusterLight>& lights, const glm::mat4& view, const glm::mat4& projection, const float& nearPlane, const float& farPlane) {
+            clusters.assign(clusterCount(), glm::uvec2(0));
+            lightIndices.clear();
+            lightBounds.clear();
+
+            const float logDepthRatio = std::log(farPlane / nearPlane);
+
+            auto depthSlice = [&](float depth) {
+                float slice = std::log(std::max(depth, nearPlane) / nearPlane) / logDepthRatio * dimensions.z;
+                return (unsigned int)std::clamp(slice, 0.0f, (float)dimensions.z - 1.0f);
+            };
+            auto screenCell = [&](float ndc, unsigned int cells) {
+                return (unsigned int)std::clamp((ndc * 0.5f + 0.5f) * cells, 0.0f, (float)cells - 1.0f);
+            };
+
+            // first pass - bounds of every light and how many lights end up in each cluster
+            for (GLuint i = 0; i < lights.size(); ++i) {
+                const float range = lights[i].range;
+                if (range <= 0.0f) { continue; }
+
+                glm::vec3 viewPosition = glm::vec3(view * glm::vec4(lights[i].position, 1.0f));
+                float depth = -viewPosition.z;
+
+                if (depth + range < nearPlane || depth - range > farPlane) { continue; }
+
+                Bounds bounds;
+                bounds.light = i;
+                bounds.min.z = depthSlice(depth - range);
+                bounds.max.z = depthSlice(depth + range);
+
+                if (depth - range <= nearPlane) {
+                    // camera is (almost) inside of the light's range - covers the whole screen
+                    bounds.min.x = bounds.min.y = 0;
+                    bounds.max.x = dimensions.x - 1;
+                    bounds.max.y = dimensions.y - 1;
+                }
+                else {
+                    // x / depth is monotonic on both axes, so the corners of the view space box give a conservative rectangle
+                    float nearest = depth - range, farthest = depth + range;
+
+                    float minX = projection[0][0] * std::min((viewPosition.x - range) / nearest, (viewPosition.x - range) / farthest);
+                    float maxX = projection[0][0] * std::max((viewPosition.x + range) / nearest, (viewPosition.x + range) / farthest);
+                    float minY = projection[1][1] * std::min((viewPosition.y - range) / nearest, (viewPosition.y - range) / farthest);
+                    float maxY = projection[1][1] * std::max((viewPosition.y + range) / nearest, (viewPosition.y + range) / farthest);
+
+                    if (maxX < -1.0f || minX > 1.0f || maxY < -1.0f || minY > 1.0f) { continue; }
+
+                    bounds.min.x = screenCell(minX, dimensions.x);
+                    bounds.max.x = screenCell(maxX, dimensions.x);
+                    bounds.min.y = screenCell(minY, dimensions.y);
+                    bounds.max.y = screenCell(maxY, dimensions.y);
+                }
+
+                forEachCluster(bounds, [&](size_t cluster) { clusters[cluster].y++; });
+                lightBounds.push_back(bounds);
+            }
+
+            // offsets from the counts
+            GLuint offset = 0;
+            for (auto& cluster : clusters) {
+                cluster.x = offset;
+                offset += cluster.y;
+                cluster.y = 0;
+            }
+            lightIndices.resize(offset);
+
+            // second pass - fill in the indices
+            for (const auto& bounds : lightBounds) {
+                forEachCluster(bounds, [&](size_t cluster) {
+                    lightIndices[clusters[cluster].x + clusters[cluster].y] = bounds.light;
+                    clusters[cluster].y++;
+                });
+            }
+        }
+
+    private:
+        struct Bounds {
+            GLuint light;
+            glm::uvec3 min;
+            glm::uvec3 max;
+        };
+
+        std::vector<Bounds> lightBounds;
+
+        template <typename Function>
+        void forEachCluster(const Bounds& bounds, Function function) {
+            for (unsigned int z = bounds.min.z; z <= bounds.max.z; ++z) {
+                for (unsigned int y = bounds.min.y; y <= bounds.max.y; ++y) {
+                    for (unsigned int x = bounds.min.x; x <= bounds.max.x; ++x) {
+                        function(x + (size_t)dimensions.x * (y + (size_t)dimensions.y * z));
+                    }
+                }
+            }
+        }
+};
+
+#endif // LIGHT_CLUSTERS_HEADER
@@ -0,0 +1,84 @@
+#ifndef MAPPED_FILE_HEADER
+#define MAPPED_FILE_HEADER
+
+#include <cstddef>
+#include <filesystem>
+
+#ifdef _WIN32
+    #ifndef WIN32_LEAN_AND_MEAN
+    #define WIN32_LEAN_AND_MEAN
+    #endif
+    #ifndef NOMINMAX
+    #define NOMINMAX
+    #endif
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+// read-only memory mapping of a whole file; pages are only read from disk once they are touched
+class MappedFile {
+    public:
+        MappedFile(const std::filesystem::path& path) {
+        #ifdef _WIN32
+            file = CreateFileW(path.wstring().c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+            if (file == INVALID_HANDLE_VALUE) { return; }
+
+            LARGE_INTEGER fileSize;
+            if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) { return; }
+
+            mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (!mapping) { return; }
+
+            data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            if (data) { mappedSize = (size_t)fileSize.QuadPart; }
+        #else
+            descriptor = open(path.c_str(), O_RDONLY);
+            if (descriptor == -1) { return; }
+
+            struct stat status;
+            if (fstat(descriptor, &status) != 0 || status.st_size == 0) { return; }
+
+            void* address = mmap(nullptr, status.st_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+            if (address == MAP_FAILED) { return; }
+
+            data = address;
+            mappedSize = status.st_size;
+        #endif
+        }
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        bool isOpen() const { return data != nullptr; }
+        size_t size() const { return mappedSize; }
+
+        const unsigned char* bytes() const { return (const unsigned char*)data; }
+
+        ~MappedFile() {
+        #ifdef _WIN32
+            if (data) { UnmapViewOfFile(data); }
+            if (mapping) { CloseHandle(mapping); }
+            if (file != INVALID_HANDLE_VALUE) { CloseHandle(file); }
+        #else
+            if (data) { munmap(data, mappedSize); }
+            if (descriptor != -1) { close(descriptor); }
+        #endif
+        }
+
+    private:
+        void* data = nullptr;
+        size_t mappedSize = 0;
+
+    #ifdef _WIN32
+        HANDLE file = INVALID_HANDLE_VALUE;
+        HANDLE mapping = nullptr;
+    #else
+        int descriptor = -1;
+    #endif
+};
+
+#endif // MAPPED_FILE_HEADER
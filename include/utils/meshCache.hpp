@@ -0,0 +1,186 @@
+#ifndef MESH_CACHE_HEADER
+#define MESH_CACHE_HEADER
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <types.hpp>
+#include <hash.hpp>
+#include <mappedFile.hpp>
+
+/**
+ * @brief Imported meshes stored in a flat binary form so warm starts don't have to go through Assimp.
+ *
+ * One file per source model: a header followed by the vertices, normals and indices exactly as ModelData holds them.
+ * An entry is valid while the source has the same size and modification time; if only the time changed
+ * the source gets hashed and compared instead. Entries from other versions or import flags are ignored.
+ */
+class MeshCache {
+    public:
+        std::filesystem::path directory;
+
+        // safe to use from several threads at once - every source has its own entry
+        std::atomic<unsigned int> hits = 0, misses = 0;
+
+        MeshCache(const std::filesystem::path& directory, const uint32_t& importFlags) : directory(directory), importFlags(importFlags) {
+            std::error_code error;
+            std::filesystem::create_directories(directory, error);
+        }
+
+        // returns false if there is no up to date entry for the source - it has to be imported then
+        bool load(const std::filesystem::path& sourcePath, ModelData& modelData) {
+            SourceInfo source;
+            if (!readSourceInfo(sourcePath, source)) {
+                misses++;
+                return false;
+            }
+
+            std::filesystem::path entryPath = cachePath(sourcePath);
+            bool valid = false;
+            {
+                MappedFile entry(entryPath);
+                if (!entry.isOpen() || entry.size() < sizeof(Header)) {
+                    misses++;
+                    return false;
+                }
+
+                Header header;
+                std::memcpy(&header, entry.bytes(), sizeof(Header));
+
+                size_t expectedSize = sizeof(Header) + (header.vertexCount + header.normalCount) * sizeof(float) + header.indexCount * sizeof(unsigned int);
+
+                if (std::memcmp(header.magic, MAGIC, sizeof(header.magic)) != 0 || header.version != VERSION || header.importFlags != importFlags || entry.size() != expectedSize) {
+                    misses++;
+                    return false;
+                }
+
+                // touched but not changed - e.g. a fresh checkout
+                bool sourceTouched = header.sourceSize != source.size || header.sourceTime != source.time;
+                if (sourceTouched && (header.sourceSize != source.size || header.sourceHash != hashFile(sourcePath))) {
+                    misses++;
+                    return false;
+                }
+
+                const unsigned char* data = entry.bytes() + sizeof(Header);
+
+                const float* vertices = (const float*)data;
+                const float* normals = vertices + header.vertexCount;
+                const unsigned int* indices = (const unsigned int*)(normals + header.normalCount);
+
+                modelData.vertices.assign(vertices, vertices + header.vertexCount);
+                modelData.normals.assign(normals, normals + header.normalCount);
+                modelData.indices.assign(indices, indices + header.indexCount);
+
+                modelData.boundsMin = glm::vec3(header.boundsMin[0], header.boundsMin[1], header.boundsMin[2]);
+                modelData.boundsMax = glm::vec3(header.boundsMax[0], header.boundsMax[1], header.boundsMax[2]);
+
+                valid = !sourceTouched;
+            }
+
+            // saves hashing the source again next time
+            if (!valid) { store(sourcePath, modelData); }
+
+            hits++;
+            return true;
+        }
+
+        void store(const std::filesystem::path& sourcePath, const ModelData& modelData) {
+            SourceInfo source;
+            if (!readSourceInfo(sourcePath, source) || modelData.indices.empty()) { return; }
+
+            Header header = {};
+            std::memcpy(header.magic, MAGIC, sizeof(header.magic));
+            header.version = VERSION;
+            header.importFlags = importFlags;
+
+            header.sourceSize = source.size;
+            header.sourceTime = source.time;
+            header.sourceHash = hashFile(sourcePath);
+
+            header.vertexCount = modelData.vertices.size();
+            header.normalCount = modelData.normals.size();
+            header.indexCount = modelData.indices.size();
+
+            for (int axis = 0; axis < 3; ++axis) {
+                header.boundsMin[axis] = modelData.boundsMin[axis];
+                header.boundsMax[axis] = modelData.boundsMax[axis];
+            }
+
+            // written next to the final file first - a crash mid-write never leaves a truncated entry behind
+            std::filesystem::path path = cachePath(sourcePath), temporaryPath = path;
+            temporaryPath += ".tmp";
+            {
+                std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+                if (!file.is_open()) { return; }
+
+                file.write((const char*)&header, sizeof(Header));
+                file.write((const char*)modelData.vertices.data(), modelData.vertices.size() * sizeof(float));
+                file.write((const char*)modelData.normals.data(), modelData.normals.size() * sizeof(float));
+                file.write((const char*)modelData.indices.data(), modelData.indices.size() * sizeof(unsigned int));
+                if (!file) { return; }
+            }
+
+            std::error_code error;
+            std::filesystem::rename(temporaryPath, path, error);
+        }
+
+    private:
+        static constexpr char MAGIC[4] = { 'S', 'M', 'S', 'H' };
+        static constexpr uint32_t VERSION = 2; // 2 - meshes are stored optimized (meshOptimizer.hpp)
+
+        // 4 byte aligned size so the arrays after it stay aligned
+        struct Header {
+            char magic[4];
+            uint32_t version;
+            uint32_t importFlags;
+            uint32_t padding;
+
+            uint64_t sourceSize;
+            int64_t sourceTime;
+            uint64_t sourceHash;
+
+            uint64_t vertexCount;  // floats, 3 per vertex
+            uint64_t normalCount;  // floats, 3 per vertex
+            uint64_t indexCount;
+
+            float boundsMin[3];
+            float boundsMax[3];
+        };
+
+        struct SourceInfo {
+            uint64_t size;
+            int64_t time;
+        };
+
+        uint32_t importFlags;
+
+        static bool readSourceInfo(const std::filesystem::path& sourcePath, SourceInfo& source) {
+            std::error_code error;
+
+            source.size = std::filesystem::file_size(sourcePath, error);
+            if (error) { return false; }
+
+            source.time = std::filesystem::last_write_time(sourcePath, error).time_since_epoch().count();
+            return !error;
+        }
+
+        static uint64_t hashFile(const std::filesystem::path& sourcePath) {
+            MappedFile source(sourcePath);
+            return source.isOpen() ? fnv1a(source.bytes(), source.size()) : 0;
+        }
+
+        // models in different folders may share a name - the path keeps them apart
+        std::filesystem::path cachePath(const std::filesystem::path& sourcePath) const {
+            char key[17];
+            std::snprintf(key, sizeof(key), "%016llx", (unsigned long long)fnv1a(std::filesystem::absolute(sourcePath).generic_string()));
+            return directory / (sourcePath.stem().string() + "-" + key + ".mesh");
+        }
+};
+
+#endif // MESH_CACHE_HEADER
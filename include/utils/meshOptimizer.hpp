@@ -0,0 +1,336 @@
+#ifndef MESH_OPTIMIZER_HEADER
+#define MESH_OPTIMIZER_HEADER
+
+#include <algorithm>
+#include <climits>
+#include <cstddef>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/packing.hpp>
+
+#include <types.hpp>
+
+// -----------------===[ Vertex cache ]===-----------------
+
+const int VERTEX_CACHE_SIZE = 32; // simulated post-transform cache, larger than on any real GPU so the order stays good on all of them
+
+// Forsyth's score - recently used vertices and vertices with few triangles left are preferred
+inline float vertexCacheScore(const int& cachePosition, const unsigned int& remainingTriangles) {
+    if (remainingTriangles == 0) { return -1.0f; }
+
+    float score = 0.0f;
+    if (cachePosition >= 0) {
+        // the last triangle's vertices get a fixed score so the next one doesn't just reuse its edge
+        if (cachePosition < 3) { score = 0.75f; }
+        else { score = std::pow(1.0f - (cachePosition - 3) / (float)(VERTEX_CACHE_SIZE - 3), 1.5f); }
+    }
+
+    return score + 2.0f * std::pow((float)remainingTriangles, -0.5f);
+}
+
+/**
+ * @brief Reorders triangles so consecutive ones share vertices (Tom Forsyth's linear-speed vertex cache optimisation).
+ *
+ * Greedily emits the best scoring triangle among those touching the simulated cache; only when none are left
+ * it falls back to the next unused triangle in the original order.
+ */
+inline void optimizeVertexCache(std::vector<unsigned int>& indices, const size_t& vertexCount) {
+    const size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0) { return; }
+
+    // triangles of every vertex - the first 'remaining' entries are the ones not emitted yet
+    std::vector<unsigned int> remaining(vertexCount, 0), triangleOffsets(vertexCount + 1, 0);
+    for (unsigned int index : indices) { remaining[index]++; }
+    for (size_t vertex = 0; vertex < vertexCount; ++vertex) { triangleOffsets[vertex + 1] = triangleOffsets[vertex] + remaining[vertex]; }
+
+    std::vector<unsigned int> vertexTriangles(indices.size());
+    std::vector<unsigned int> fill(triangleOffsets.begin(), triangleOffsets.end() - 1);
+    for (size_t triangle = 0; triangle < triangleCount; ++triangle) {
+        for (int corner = 0; corner < 3; ++corner) {
+            vertexTriangles[fill[indices[triangle * 3 + corner]]++] = triangle;
+        }
+    }
+
+    std::vector<int> cachePosition(vertexCount, -1);
+    std::vector<float> vertexScores(vertexCount);
+    for (size_t vertex = 0; vertex < vertexCount; ++vertex) { vertexScores[vertex] = vertexCacheScore(-1, remaining[vertex]); }
+
+    auto triangleScore = [&](size_t triangle) {
+        return vertexScores[indices[triangle * 3]] + vertexScores[indices[triangle * 3 + 1]] + vertexScores[indices[triangle * 3 + 2]];
+    };
+
+    std::vector<bool> emitted(triangleCount, false);
+    std::vector<unsigned int> output;
+    output.reserve(indices.size());
+
+    std::vector<unsigned int> cache, nextCache; // most recently used first
+    cache.reserve(VERTEX_CACHE_SIZE + 3);
+    nextCache.reserve(VERTEX_CACHE_SIZE + 3);
+
+    long best = 0;
+    float bestScore = triangleScore(0);
+    for (size_t triangle = 1; triangle < triangleCount; ++triangle) {
+        float score = triangleScore(triangle);
+        if (score > bestScore) { best = triangle; bestScore = score; }
+    }
+
+    size_t scanPosition = 0;
+
+    while (best >= 0) {
+        emitted[best] = true;
+        nextCache.clear();
+
+        for (int corner = 0; corner < 3; ++corner) {
+            unsigned int vertex = indices[best * 3 + corner];
+            output.push_back(vertex);
+
+            if (std::find(nextCache.begin(), nextCache.end(), vertex) == nextCache.end()) { nextCache.push_back(vertex); }
+
+            // drop the triangle from the vertex's remaining ones
+            unsigned int begin = triangleOffsets[vertex], end = begin + remaining[vertex];
+            for (unsigned int i = begin; i < end; ++i) {
+                if (vertexTriangles[i] == (unsigned int)best) {
+                    std::swap(vertexTriangles[i], vertexTriangles[end - 1]);
+                    break;
+                }
+            }
+            remaining[vertex]--;
+        }
+
+        for (unsigned int vertex : cache) {
+            if (std::find(nextCache.begin(), nextCache.begin() + std::min<size_t>(3, nextCache.size()), vertex) == nextCache.begin() + std::min<size_t>(3, nextCache.size())) {
+                nextCache.push_back(vertex);
+            }
+        }
+
+        // new cache positions - vertices past the cache size fall out of it
+        for (size_t i = 0; i < nextCache.size(); ++i) {
+            unsigned int vertex = nextCache[i];
+            cachePosition[vertex] = i < (size_t)VERTEX_CACHE_SIZE ? (int)i : -1;
+            vertexScores[vertex] = vertexCacheScore(cachePosition[vertex], remaining[vertex]);
+        }
+
+        // only triangles touching the changed vertices changed their score
+        best = -1;
+        bestScore = -1.0f;
+        for (unsigned int vertex : nextCache) {
+            for (unsigned int i = triangleOffsets[vertex]; i < triangleOffsets[vertex] + remaining[vertex]; ++i) {
+                unsigned int triangle = vertexTriangles[i];
+                float score = triangleScore(triangle);
+                if (score > bestScore) { best = triangle; bestScore = score; }
+            }
+        }
+
+        if (nextCache.size() > (size_t)VERTEX_CACHE_SIZE) { nextCache.resize(VERTEX_CACHE_SIZE); }
+        cache.swap(nextCache);
+
+        if (best < 0) {
+            while (scanPosition < triangleCount && emitted[scanPosition]) { scanPosition++; }
+            best = scanPosition < triangleCount ? (long)scanPosition : -1;
+        }
+    }
+
+    indices.swap(output);
+}
+
+// vertices in the order they are first used - sequential fetches, unused vertices are dropped
+inline void optimizeVertexFetch(ModelData& modelData) {
+    const size_t vertexCount = modelData.vertices.size() / 3;
+
+    std::vector<unsigned int> remap(vertexCount, UINT_MAX);
+    unsigned int nextVertex = 0;
+
+    for (unsigned int& index : modelData.indices) {
+        if (remap[index] == UINT_MAX) { remap[index] = nextVertex++; }
+        index = remap[index];
+    }
+
+    std::vector<float> vertices(nextVertex * 3), normals(nextVertex * 3);
+    for (size_t vertex = 0; vertex < vertexCount; ++vertex) {
+        if (remap[vertex] == UINT_MAX) { continue; }
+
+        std::memcpy(&vertices[remap[vertex] * 3], &modelData.vertices[vertex * 3], 3 * sizeof(float));
+        if (modelData.normals.size() >= (vertex + 1) * 3) { std::memcpy(&normals[remap[vertex] * 3], &modelData.normals[vertex * 3], 3 * sizeof(float)); }
+    }
+
+    modelData.vertices.swap(vertices);
+    modelData.normals.swap(normals);
+}
+
+// average cache miss ratio - transformed vertices per triangle with a FIFO cache (0.5 is ideal, 3.0 is no reuse at all)
+inline float averageCacheMissRatio(const std::vector<unsigned int>& indices, const size_t& vertexCount, const size_t& cacheSize = 16) {
+    if (indices.empty()) { return 0.0f; }
+
+    std::vector<size_t> insertedAt(vertexCount, 0); // 0 - not in cache
+    size_t misses = 0;
+
+    for (unsigned int index : indices) {
+        if (insertedAt[index] == 0 || misses + 1 - insertedAt[index] >= cacheSize) {
+            misses++;
+            insertedAt[index] = misses;
+        }
+    }
+
+    return misses / (float)(indices.size() / 3);
+}
+
+// triangle and vertex order for the GPU; call before packing
+inline void optimizeMesh(ModelData& modelData) {
+    optimizeVertexCache(modelData.indices, modelData.vertices.size() / 3);
+    optimizeVertexFetch(modelData);
+}
+
+// -----------------===[ Packing ]===-----------------
+
+// positions are only stored as half floats if that moves no vertex by more than this fraction of the model's size
+const float MAX_HALF_POSITION_ERROR = 1.0e-3f;
+
+// interleaved vertex with half float positions and an octahedral normal - 8 bytes instead of 24
+struct PackedVertexHalf {
+    uint16_t position[3];
+    int8_t normal[2];
+};
+
+// for models whose position range doesn't fit half floats - 16 bytes
+struct PackedVertexFloat {
+    float position[3];
+    int8_t normal[2];
+    int8_t padding[2];
+};
+
+/**
+ * @brief Octahedral normal encoding (two signed bytes) - the unit sphere is folded onto an octahedron and flattened into a square.
+ *
+ * Every rounding direction is tried and the one decoding closest to the original is kept. Decoded in shaders/vertexPacking.glsl.
+ */
+inline void encodeOctahedral(const glm::vec3& normal, int8_t encoded[2]) {
+    auto decode = [](const glm::vec2& e) {
+        glm::vec3 n(e.x, e.y, 1.0f - std::abs(e.x) - std::abs(e.y));
+        float t = std::max(-n.z, 0.0f);
+        n.x += n.x >= 0.0f ? -t : t;
+        n.y += n.y >= 0.0f ? -t : t;
+        return glm::normalize(n);
+    };
+
+    glm::vec3 n = normal / (std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z));
+    glm::vec2 projected(n.x, n.y);
+
+    if (n.z < 0.0f) {
+        projected = glm::vec2(
+            (1.0f - std::abs(n.y)) * (n.x >= 0.0f ? 1.0f : -1.0f),
+            (1.0f - std::abs(n.x)) * (n.y >= 0.0f ? 1.0f : -1.0f)
+        );
+    }
+
+    glm::vec2 scaled = glm::clamp(projected, -1.0f, 1.0f) * 127.0f;
+    float bestDot = -2.0f;
+
+    for (int option = 0; option < 4; ++option) {
+        glm::vec2 candidate((option & 1) ? std::ceil(scaled.x) : std::floor(scaled.x), (option & 2) ? std::ceil(scaled.y) : std::floor(scaled.y));
+        candidate = glm::clamp(candidate, -127.0f, 127.0f);
+
+        float dot = glm::dot(decode(candidate / 127.0f), normal);
+        if (dot > bestDot) {
+            bestDot = dot;
+            encoded[0] = (int8_t)candidate.x;
+            encoded[1] = (int8_t)candidate.y;
+        }
+    }
+}
+
+/**
+ * @brief GPU ready form of a ModelData - interleaved, quantized vertices and the smallest index type that fits.
+ */
+struct PackedMesh {
+    std::vector<unsigned char> vertices;
+    std::vector<unsigned char> indices;
+
+    bool halfPositions = false;
+    GLsizei stride = 0;
+    GLenum positionType = GL_FLOAT;
+    size_t normalOffset = 0;
+
+    GLenum indexType = GL_UNSIGNED_INT;
+    GLsizei indexCount = 0;
+};
+
+inline bool fitsHalfPositions(const ModelData& modelData) {
+    glm::vec3 extent = modelData.boundsMax - modelData.boundsMin;
+    float size = std::max(extent.x, std::max(extent.y, extent.z));
+
+    glm::vec3 magnitude = glm::max(glm::abs(modelData.boundsMin), glm::abs(modelData.boundsMax));
+    float largest = std::max(magnitude.x, std::max(magnitude.y, magnitude.z));
+
+    // half floats keep 11 significant bits - rounding moves a value by at most 2^-11 of its magnitude
+    return size > 0.0f && largest < 65504.0f && largest * std::ldexp(1.0f, -11) <= size * MAX_HALF_POSITION_ERROR;
+}
+
+inline PackedMesh packMesh(const ModelData& modelData) {
+    PackedMesh mesh;
+
+    const size_t vertexCount = modelData.vertices.size() / 3;
+    const bool hasNormals = modelData.normals.size() >= vertexCount * 3;
+
+    auto packNormal = [&](size_t vertex, int8_t encoded[2]) {
+        glm::vec3 normal = hasNormals ? glm::vec3(modelData.normals[vertex * 3], modelData.normals[vertex * 3 + 1], modelData.normals[vertex * 3 + 2]) : glm::vec3(0.0f);
+
+        if (glm::dot(normal, normal) < 1.0e-12f) { normal = glm::vec3(0.0f, 0.0f, 1.0f); }
+        encodeOctahedral(glm::normalize(normal), encoded);
+    };
+
+    mesh.halfPositions = fitsHalfPositions(modelData);
+
+    if (mesh.halfPositions) {
+        std::vector<PackedVertexHalf> vertices(vertexCount);
+        for (size_t vertex = 0; vertex < vertexCount; ++vertex) {
+            for (int axis = 0; axis < 3; ++axis) { vertices[vertex].position[axis] = glm::packHalf1x16(modelData.vertices[vertex * 3 + axis]); }
+            packNormal(vertex, vertices[vertex].normal);
+        }
+
+        mesh.vertices.resize(vertexCount * sizeof(PackedVertexHalf));
+        std::memcpy(mesh.vertices.data(), vertices.data(), mesh.vertices.size());
+
+        mesh.stride = sizeof(PackedVertexHalf);
+        mesh.positionType = GL_HALF_FLOAT;
+        mesh.normalOffset = offsetof(PackedVertexHalf, normal);
+    }
+    else {
+        std::vector<PackedVertexFloat> vertices(vertexCount);
+        for (size_t vertex = 0; vertex < vertexCount; ++vertex) {
+            std::memcpy(vertices[vertex].position, &modelData.vertices[vertex * 3], 3 * sizeof(float));
+            packNormal(vertex, vertices[vertex].normal);
+            vertices[vertex].padding[0] = vertices[vertex].padding[1] = 0;
+        }
+
+        mesh.vertices.resize(vertexCount * sizeof(PackedVertexFloat));
+        std::memcpy(mesh.vertices.data(), vertices.data(), mesh.vertices.size());
+
+        mesh.stride = sizeof(PackedVertexFloat);
+        mesh.positionType = GL_FLOAT;
+        mesh.normalOffset = offsetof(PackedVertexFloat, normal);
+    }
+
+    mesh.indexCount = modelData.indices.size();
+
+    if (vertexCount <= 65536) {
+        std::vector<uint16_t> indices(modelData.indices.begin(), modelData.indices.end());
+
+        mesh.indices.resize(indices.size() * sizeof(uint16_t));
+        std::memcpy(mesh.indices.data(), indices.data(), mesh.indices.size());
+        mesh.indexType = GL_UNSIGNED_SHORT;
+    }
+    else {
+        mesh.indices.resize(modelData.indices.size() * sizeof(unsigned int));
+        std::memcpy(mesh.indices.data(), modelData.indices.data(), mesh.indices.size());
+        mesh.indexType = GL_UNSIGNED_INT;
+    }
+
+    return mesh;
+}
+
+#endif // MESH_OPTIMIZER_HEADER
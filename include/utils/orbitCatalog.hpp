@@ -0,0 +1,416 @@
+#ifndef ORBIT_CATALOG_HEADER
+#define ORBIT_CATALOG_HEADER
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <filesystem>
+#include <format>
+#include <future>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include <mappedFile.hpp>
+#include <threadPool.hpp>
+#include <FormatConsole.hpp>
+
+/**
+ * Orbital element catalogs of minor planets - the MPC's fixed width MPCORB.DAT format or a CSV with a header row
+ * (JPL small-body database exports work as they are).
+ *
+ * Files are memory mapped, split into chunks at line boundaries and every chunk is parsed on the worker pool into columns.
+ * Elements are turned into state vectors in batches with a Kepler solver that runs the same fixed number of iterations for
+ * every body and uses polynomial sines, so its inner loops are branch free and the compiler vectorizes them.
+ * Only elliptic orbits are taken; bodies are placed at the catalog's epoch plus the given time, by mean motion alone.
+ */
+
+inline constexpr double ASTRONOMICAL_UNIT = 149'597'870.7; // km
+
+// a run of orbits in columns - angles in radians, semi-major axis in km
+struct OrbitElements {
+    const double *semiMajorAxis, *eccentricity, *inclination, *ascendingNode, *periapsis, *meanAnomaly;
+    size_t count;
+};
+
+// the columns of a catalog - angles in radians, semi-major axis in km
+struct OrbitCatalog {
+    std::vector<double> semiMajorAxis, eccentricity, inclination, ascendingNode, periapsis, meanAnomaly;
+    std::vector<std::string> names;
+
+    size_t skipped = 0; // lines that couldn't be read or aren't elliptic orbits
+
+    size_t size() const { return names.size(); }
+
+    OrbitElements elements() const {
+        return { semiMajorAxis.data(), eccentricity.data(), inclination.data(), ascendingNode.data(), periapsis.data(), meanAnomaly.data(), size() };
+    }
+
+    void append(OrbitCatalog&& other) {
+        auto move = [](std::vector<double>& into, const std::vector<double>& from) { into.insert(into.end(), from.begin(), from.end()); };
+
+        move(semiMajorAxis, other.semiMajorAxis);
+        move(eccentricity, other.eccentricity);
+        move(inclination, other.inclination);
+        move(ascendingNode, other.ascendingNode);
+        move(periapsis, other.periapsis);
+        move(meanAnomaly, other.meanAnomaly);
+        names.insert(names.end(), std::make_move_iterator(other.names.begin()), std::make_move_iterator(other.names.end()));
+        skipped += other.skipped;
+    }
+};
+
+// -----------------===[ Parsing ]===-----------------
+
+inline std::string_view trimCatalogField(std::string_view field) {
+    while (!field.empty() && std::isspace((unsigned char)field.front())) { field.remove_prefix(1); }
+    while (!field.empty() && std::isspace((unsigned char)field.back())) { field.remove_suffix(1); }
+    if (field.size() >= 2 && field.front() == '"' && field.back() == '"') { field = trimCatalogField(field.substr(1, field.size() - 2)); }
+    return field;
+}
+
+inline bool parseCatalogNumber(std::string_view field, double& value) {
+    field = trimCatalogField(field);
+    if (!field.empty() && field.front() == '+') { field.remove_prefix(1); }
+
+    auto [end, error] = std::from_chars(field.data(), field.data() + field.size(), value);
+    return error == std::errc() && end == field.data() + field.size();
+}
+
+// degrees and AU as the catalogs give them - false if the orbit isn't usable
+inline bool addCatalogOrbit(OrbitCatalog& catalog, std::string_view name, const double& a, const double& e, const double& i, const double& node, const double& peri, const double& meanAnomaly) {
+    if (!(a > 0.0) || !(e >= 0.0 && e < 1.0)) { return false; }
+
+    constexpr double toRadians = 3.14159265358979323846 / 180.0;
+
+    catalog.semiMajorAxis.push_back(a * ASTRONOMICAL_UNIT);
+    catalog.eccentricity.push_back(e);
+    catalog.inclination.push_back(i * toRadians);
+    catalog.ascendingNode.push_back(node * toRadians);
+    catalog.periapsis.push_back(peri * toRadians);
+    catalog.meanAnomaly.push_back(meanAnomaly * toRadians);
+    catalog.names.emplace_back(name);
+
+    return true;
+}
+
+// calls lineFunction for every line of [begin, end) - without the line break
+template <typename LineFunction>
+void forEachCatalogLine(const char* begin, const char* end, LineFunction lineFunction) {
+    while (begin < end) {
+        const char* lineEnd = std::find(begin, end, '\n');
+
+        std::string_view line(begin, lineEnd - begin);
+        if (!line.empty() && line.back() == '\r') { line.remove_suffix(1); }
+        lineFunction(line);
+
+        begin = lineEnd + (lineEnd < end);
+    }
+}
+
+/**
+ * MPCORB.DAT lines (1-based columns): 21-25 epoch, 27-35 mean anomaly, 38-46 argument of perihelion, 49-57 ascending node,
+ * 60-68 inclination, 71-79 eccentricity, 93-103 semi-major axis, 167-194 readable designation.
+ */
+inline void parseMpcorbLines(const char* begin, const char* end, OrbitCatalog& catalog) {
+    forEachCatalogLine(begin, end, [&catalog](std::string_view line) {
+        if (trimCatalogField(line).empty()) { return; } // MPCORB separates sections with blank lines
+
+        auto column = [&line](const size_t& first, const size_t& last) { return first <= line.size() ? line.substr(first - 1, last - first + 1) : std::string_view(); };
+
+        double meanAnomaly, peri, node, i, e, a;
+        bool read = line.size() >= 103
+            && parseCatalogNumber(column(27, 35), meanAnomaly) && parseCatalogNumber(column(38, 46), peri) && parseCatalogNumber(column(49, 57), node)
+            && parseCatalogNumber(column(60, 68), i) && parseCatalogNumber(column(71, 79), e) && parseCatalogNumber(column(93, 103), a);
+
+        std::string_view name = trimCatalogField(column(167, 194));
+        if (name.empty()) { name = trimCatalogField(column(1, 7)); } // packed designation
+
+        if (!read || !addCatalogOrbit(catalog, name, a, e, i, node, peri, meanAnomaly)) { catalog.skipped++; }
+    });
+}
+
+// where each needed value is in a CSV row
+struct CatalogColumns {
+    int name = -1, a = -1, e = -1, i = -1, node = -1, peri = -1, meanAnomaly = -1;
+};
+
+inline std::vector<std::string_view> splitCatalogRow(std::string_view line) {
+    std::vector<std::string_view> fields;
+
+    size_t start = 0;
+    bool quoted = false;
+    for (size_t i = 0; i <= line.size(); ++i) {
+        if (i < line.size() && line[i] == '"') { quoted = !quoted; }
+        if (i == line.size() || (line[i] == ',' && !quoted)) {
+            fields.push_back(line.substr(start, i - start));
+            start = i + 1;
+        }
+    }
+
+    return fields;
+}
+
+inline CatalogColumns findCatalogColumns(std::string_view header) {
+    CatalogColumns columns;
+
+    std::vector<std::string_view> fields = splitCatalogRow(header);
+    for (int index = 0; index < (int)fields.size(); ++index) {
+        std::string field(trimCatalogField(fields[index]));
+        std::transform(field.begin(), field.end(), field.begin(), [](unsigned char character) { return std::tolower(character); });
+
+        auto is = [&field](std::initializer_list<const char*> names) { return std::find(names.begin(), names.end(), field) != names.end(); };
+
+        if (field == "full_name") { columns.name = index; }
+        else if (is({ "name", "designation", "pdes" })) { if (columns.name < 0) { columns.name = index; } }
+        else if (is({ "a", "semi_major_axis" })) { columns.a = index; }
+        else if (is({ "e", "eccentricity" })) { columns.e = index; }
+        else if (is({ "i", "incl", "inclination" })) { columns.i = index; }
+        else if (is({ "om", "node", "raan", "ascending_node" })) { columns.node = index; }
+        else if (is({ "w", "peri", "argp", "argument_of_perihelion" })) { columns.peri = index; }
+        else if (is({ "ma", "m", "mean_anomaly" })) { columns.meanAnomaly = index; }
+    }
+
+    return columns;
+}
+
+inline void parseCsvLines(const char* begin, const char* end, const CatalogColumns& columns, OrbitCatalog& catalog) {
+    int lastColumn = std::max({ columns.name, columns.a, columns.e, columns.i, columns.node, columns.peri, columns.meanAnomaly });
+
+    forEachCatalogLine(begin, end, [&](std::string_view line) {
+        if (trimCatalogField(line).empty()) { return; }
+
+        std::vector<std::string_view> fields = splitCatalogRow(line);
+
+        double a, e, i, node, peri, meanAnomaly;
+        bool read = (int)fields.size() > lastColumn
+            && parseCatalogNumber(fields[columns.a], a) && parseCatalogNumber(fields[columns.e], e) && parseCatalogNumber(fields[columns.i], i)
+            && parseCatalogNumber(fields[columns.node], node) && parseCatalogNumber(fields[columns.peri], peri) && parseCatalogNumber(fields[columns.meanAnomaly], meanAnomaly);
+
+        std::string_view name = (read && columns.name >= 0) ? trimCatalogField(fields[columns.name]) : std::string_view();
+
+        if (!read || !addCatalogOrbit(catalog, name, a, e, i, node, peri, meanAnomaly)) { catalog.skipped++; }
+    });
+}
+
+/**
+ * @brief Reads a whole catalog - '.csv' files as CSV, anything else as MPCORB (with or without its header).
+ * Throws std::invalid_argument if the file can't be opened or a CSV lacks one of the element columns.
+ */
+inline OrbitCatalog readOrbitCatalog(const std::filesystem::path& path, ThreadPool* pool = nullptr) {
+    MappedFile mapping(path);
+    if (!mapping.isOpen()) { throw std::invalid_argument(std::format("could not open '{}'", formatPath(path.string()))); }
+
+    const char* text = (const char*)mapping.bytes();
+    const char* end = text + mapping.size();
+    const char* body = text;
+
+    std::string extension = path.extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char character) { return std::tolower(character); });
+    bool csv = extension == ".csv";
+
+    CatalogColumns columns;
+    if (csv) {
+        const char* headerEnd = std::find(text, end, '\n');
+        columns = findCatalogColumns(std::string_view(text, headerEnd - text));
+
+        if (columns.a < 0 || columns.e < 0 || columns.i < 0 || columns.node < 0 || columns.peri < 0 || columns.meanAnomaly < 0) {
+            throw std::invalid_argument(std::format("'{}' needs the columns a, e, i, om, w and ma", formatPath(path.filename().string())));
+        }
+
+        body = headerEnd + (headerEnd < end);
+    }
+    else {
+        // MPCORB.DAT starts with a description that ends with a line of dashes
+        const char* searchEnd = text + std::min<size_t>(mapping.size(), 64 * 1024);
+        std::string_view start(text, searchEnd - text);
+
+        size_t dashes = start.find("\n-----");
+        if (dashes != std::string_view::npos) {
+            const char* headerEnd = std::find(text + dashes + 1, end, '\n');
+            body = headerEnd + (headerEnd < end);
+        }
+    }
+
+    // chunks of about a megabyte, cut after a line break
+    const size_t chunkSize = 1 << 20;
+    std::vector<std::pair<const char*, const char*>> chunks;
+    for (const char* chunkStart = body; chunkStart < end; ) {
+        const char* chunkEnd = chunkStart + std::min<size_t>(chunkSize, end - chunkStart);
+        chunkEnd = std::find(chunkEnd, end, '\n');
+        chunkEnd += (chunkEnd < end);
+
+        chunks.push_back({ chunkStart, chunkEnd });
+        chunkStart = chunkEnd;
+    }
+
+    std::vector<OrbitCatalog> parts(chunks.size());
+    auto parseChunk = [&](const size_t& index) {
+        if (csv) { parseCsvLines(chunks[index].first, chunks[index].second, columns, parts[index]); }
+        else { parseMpcorbLines(chunks[index].first, chunks[index].second, parts[index]); }
+    };
+
+    std::vector<std::future<void>> parsed;
+    for (size_t index = 0; index < chunks.size(); ++index) {
+        if (pool) { parsed.push_back(pool->submit([&parseChunk, index]() { parseChunk(index); })); }
+        else { parseChunk(index); }
+    }
+    for (auto& result : parsed) { pool->await(result); }
+
+    OrbitCatalog catalog;
+    size_t total = 0;
+    for (const OrbitCatalog& part : parts) { total += part.size(); }
+
+    for (std::vector<double>* column : { &catalog.semiMajorAxis, &catalog.eccentricity, &catalog.inclination, &catalog.ascendingNode, &catalog.periapsis, &catalog.meanAnomaly }) {
+        column->reserve(total);
+    }
+    catalog.names.reserve(total);
+
+    for (OrbitCatalog& part : parts) { catalog.append(std::move(part)); }
+
+    return catalog;
+}
+
+// -----------------===[ Kepler solver ]===-----------------
+
+// sine and cosine from polynomials - accurate to a few ulp for |x| up to about 1e5, no branches
+inline void polynomialSinCos(const double& x, double& sine, double& cosine) {
+    // x = quadrant * pi/2 + r, |r| <= pi/4 - pi/2 split in two so the reduction stays exact
+    constexpr double twoOverPi = 0.63661977236758134308;
+    constexpr double halfPiHigh = 1.57079632673412561417;
+    constexpr double halfPiLow = 6.07710050650619224932e-11;
+
+    double quadrant = std::nearbyint(x * twoOverPi);
+    double r = (x - quadrant * halfPiHigh) - quadrant * halfPiLow;
+    double r2 = r * r;
+
+    double s = r * (1.0 + r2 * (-1.0 / 6.0 + r2 * (1.0 / 120.0 + r2 * (-1.0 / 5040.0 + r2 * (1.0 / 362880.0 + r2 * (-1.0 / 39916800.0
+             + r2 * (1.0 / 6227020800.0 + r2 * (-1.0 / 1307674368000.0 + r2 * (1.0 / 355687428096000.0)))))))));
+    double c = 1.0 + r2 * (-1.0 / 2.0 + r2 * (1.0 / 24.0 + r2 * (-1.0 / 720.0 + r2 * (1.0 / 40320.0 + r2 * (-1.0 / 3628800.0
+             + r2 * (1.0 / 479001600.0 + r2 * (-1.0 / 87178291200.0 + r2 * (1.0 / 20922789888000.0))))))));
+
+    // rotate by the quadrant: 0 (s, c), 1 (c, -s), 2 (-s, -c), 3 (-c, s)
+    long long q = (long long)quadrant & 3;
+    bool swap = q & 1;
+    double sineSign = (q & 2) ? -1.0 : 1.0;
+    double cosineSign = ((q + 1) & 2) ? -1.0 : 1.0;
+
+    sine = sineSign * (swap ? c : s);
+    cosine = cosineSign * (swap ? s : c);
+}
+
+/**
+ * @brief Solves Kepler's equation M = E - e sin E for a batch of elliptic orbits, giving sin E and cos E.
+ *
+ * Every orbit gets the same number of Newton steps from Danby's starting guess, which converges for all but orbits very
+ * close to parabolic near periapsis - those are finished one by one afterwards.
+ */
+inline void solveKepler(const double* meanAnomaly, const double* eccentricity, double* sinE, double* cosE, const size_t& count) {
+    constexpr double pi = 3.14159265358979323846;
+    constexpr int iterations = 8;
+
+    std::vector<double> reduced(count), anomaly(count);
+
+    for (size_t i = 0; i < count; ++i) {
+        reduced[i] = meanAnomaly[i] - 2.0 * pi * std::nearbyint(meanAnomaly[i] * (0.5 / pi)); // [-pi, pi]
+        anomaly[i] = reduced[i] + std::copysign(0.85 * eccentricity[i], reduced[i]);
+    }
+
+    // a step for every orbit at a time - the inner loop is the one that vectorizes
+    for (int step = 0; step < iterations; ++step) {
+        for (size_t i = 0; i < count; ++i) {
+            double s, c;
+            polynomialSinCos(anomaly[i], s, c);
+            anomaly[i] -= (anomaly[i] - eccentricity[i] * s - reduced[i]) / (1.0 - eccentricity[i] * c);
+        }
+    }
+
+    for (size_t i = 0; i < count; ++i) { polynomialSinCos(anomaly[i], sinE[i], cosE[i]); }
+
+    for (size_t i = 0; i < count; ++i) {
+        double M = reduced[i];
+        double E = anomaly[i];
+
+        if (std::abs(E - eccentricity[i] * sinE[i] - M) <= 1e-12) { continue; } // false for NaN as well
+
+        // bisection keeps Newton inside [-pi, pi] where it can't diverge
+        double low = -pi, high = pi;
+        E = M;
+        for (int step = 0; step < 100; ++step) {
+            double residual = E - eccentricity[i] * std::sin(E) - M;
+            if (std::abs(residual) <= 1e-14) { break; }
+
+            (residual > 0.0 ? high : low) = E;
+
+            double next = E - residual / (1.0 - eccentricity[i] * std::cos(E));
+            E = (next > low && next < high) ? next : 0.5 * (low + high);
+        }
+
+        sinE[i] = std::sin(E);
+        cosE[i] = std::cos(E);
+    }
+}
+
+/**
+ * @brief Positions (km) and velocities (km/s) relative to the central body, in the frame of the catalog's elements
+ * (the reference plane is the x-y plane, as in the scenes). gravitationalParameter is G * M of the central body in km³/s².
+ *
+ * time (s) moves every body along its orbit from the catalog's epoch - exact for bodies only the central body pulls on.
+ * velocities can be null if only the positions are needed.
+ */
+inline void catalogStateVectors(const OrbitElements& catalog, const double& gravitationalParameter, glm::dvec3* positions, glm::dvec3* velocities, ThreadPool* pool = nullptr, const double& time = 0.0) {
+    const size_t batchSize = 4096;
+
+    auto convertBatch = [&](const size_t& first, const size_t& count) {
+        std::vector<double> meanAnomaly(count), sinE(count), cosE(count);
+        for (size_t k = 0; k < count; ++k) {
+            double a = catalog.semiMajorAxis[first + k];
+            meanAnomaly[k] = catalog.meanAnomaly[first + k] + std::sqrt(gravitationalParameter / (a * a * a)) * time; // mean motion * time
+        }
+
+        solveKepler(meanAnomaly.data(), &catalog.eccentricity[first], sinE.data(), cosE.data(), count);
+
+        for (size_t k = 0; k < count; ++k) {
+            size_t i = first + k;
+
+            double a = catalog.semiMajorAxis[i];
+            double e = catalog.eccentricity[i];
+            double minorFactor = std::sqrt(1.0 - e * e);
+
+            // in the orbital plane, x towards periapsis
+            double x = a * (cosE[k] - e);
+            double y = a * minorFactor * sinE[k];
+
+            double speedFactor = std::sqrt(gravitationalParameter / a) / (1.0 - e * cosE[k]);
+            double vx = -speedFactor * sinE[k];
+            double vy = speedFactor * minorFactor * cosE[k];
+
+            double sinNode, cosNode, sinInclination, cosInclination, sinPeri, cosPeri;
+            polynomialSinCos(catalog.ascendingNode[i], sinNode, cosNode);
+            polynomialSinCos(catalog.inclination[i], sinInclination, cosInclination);
+            polynomialSinCos(catalog.periapsis[i], sinPeri, cosPeri);
+
+            // P points to periapsis, Q 90° ahead of it in the orbital plane
+            glm::dvec3 P(cosPeri * cosNode - sinPeri * cosInclination * sinNode, cosPeri * sinNode + sinPeri * cosInclination * cosNode, sinPeri * sinInclination);
+            glm::dvec3 Q(-sinPeri * cosNode - cosPeri * cosInclination * sinNode, -sinPeri * sinNode + cosPeri * cosInclination * cosNode, cosPeri * sinInclination);
+
+            positions[i] = x * P + y * Q;
+            if (velocities) { velocities[i] = vx * P + vy * Q; }
+        }
+    };
+
+    std::vector<std::future<void>> converted;
+    for (size_t first = 0; first < catalog.count; first += batchSize) {
+        size_t count = std::min(batchSize, catalog.count - first);
+
+        if (pool) { converted.push_back(pool->submit([&convertBatch, first, count]() { convertBatch(first, count); })); }
+        else { convertBatch(first, count); }
+    }
+    for (auto& result : converted) { pool->await(result); }
+}
+
+#endif // ORBIT_CATALOG_HEADER
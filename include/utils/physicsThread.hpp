@@ -4,10 +4,13 @@
 #include "scenes.hpp"
 #include "simObject.hpp"
 #include "types.hpp"
+#include "arena.hpp"
 #include <string>
 #include <thread>
 #include <mutex>
 #include <atomic>
+#include <algorithm>
+#include <chrono>
 #include <condition_variable>
 #include <unordered_map>
 #include <utility>
@@ -17,7 +20,6 @@
 #include <glm/glm.hpp>
 #include <units.hpp>
 
-inline std::mutex physicsMutex;
 inline std::condition_variable physicsCV;
 inline std::atomic<bool> physicsRunning(true);
 inline std::atomic<bool> pausePhysicsThread(false);
@@ -26,6 +28,22 @@ inline double physicsDeltaTime;
 
 inline std::thread physicsThread;
 
+// when the published state (vertPosition) was due - the previous one (previousVertPosition) is physicsDeltaTime older
+inline std::chrono::steady_clock::time_point physicsStateTime;
+
+/**
+ * @brief How far between the previous and the current physics state bodies are drawn at the given time.
+ *
+ * The renderer stays one physics step behind, so it only ever interpolates between two states the physics thread has
+ * published - motion stays smooth at any frame rate, even with few (large) physics steps. Call with physicsMutex locked.
+ */
+inline float physicsStateFraction(const std::chrono::steady_clock::time_point& now) {
+    if (!interpolatePhysics || pausePhysicsThread) { return 1.0f; }
+
+    double fraction = std::chrono::duration<double>(now - physicsStateTime).count() / physicsDeltaTime;
+    return (float)std::clamp(fraction, 0.0, 1.0);
+}
+
 struct SnapObj {
     glm::dvec3 position;
     glm::dvec3 velocity;
@@ -33,24 +51,39 @@ struct SnapObj {
     units::tons mass;
 
     glm::dvec3 vertPosition;
+    glm::dvec3 previousVertPosition;
     double distanceScale;
     bool simulate;
     bool firstPass;
 };
 
+struct SnapTestParticleGroup {
+    SnapObj* attractor;
+    std::vector<SnapObj*> particles;
+};
+
 class Snapshot {
     public:
         std::vector<std::vector<SnapObj*>> groups;
+        std::vector<SnapTestParticleGroup> testParticles;
         std::vector<std::pair<SnapObj*, simulationObject*>> objects;
         SceneID ID;
+        const scene* source = nullptr; // a hot reload replaces a scene under the same ID
+        uint64_t layoutVersion = 0; // of the scene's objects when the snapshot was taken
+
+        double steppedSeconds = 0.0; // simulated since the last write back
+        std::chrono::steady_clock::time_point stateTime; // when the stepped state was due
+
+        Arena arena; // SnapObjs of the current scene - refilled on every full snapshot
 
     public:
 
         void takeSnapshot(bool lock = true) {
-            bool takeFullSnapshot = Scenes::currentSceneID != ID;
-
             if (lock) { physicsMutex.lock(); }
 
+            // paged catalogs add and remove objects while the scene runs
+            bool takeFullSnapshot = Scenes::currentSceneID != ID || Scenes::currentScene != source || Scenes::currentScene->layoutVersion != layoutVersion;
+
             if (takeFullSnapshot) { fullSnapshot(Scenes::currentScene); }
             else { lightSnapshot(Scenes::currentScene); }
 
@@ -58,15 +91,28 @@ class Snapshot {
         }
 
         void updateOrigin(bool lock = true) {
-            const scene* scene = Scenes::currentScene;
+            scene* scene = Scenes::currentScene;
 
             if (lock) { physicsMutex.lock(); }
 
-            for ( auto [snapObj, obj] : objects ) {
+            // paged tiles came or went since the snapshot, so its paged bodies may be gone - only the scene's own objects (listed first) are written back
+            size_t writeBack = objects.size();
+            if (Scenes::currentSceneID != ID || scene != source) { writeBack = 0; }
+            else if (scene->layoutVersion != layoutVersion) { writeBack = std::min(writeBack, scene->pagedObjectsBegin); }
+
+            if (Scenes::currentSceneID == ID && scene == source) { scene->simulatedTime += steppedSeconds; }
+            steppedSeconds = 0.0;
+
+            physicsStateTime = stateTime;
+
+            for (size_t i = 0; i < writeBack; ++i) {
+                auto [snapObj, obj] = objects[i];
+
                 obj->position = snapObj->position;
                 obj->velocity = snapObj->velocity;
                 obj->acceleration = snapObj->acceleration;
                 obj->vertPosition = snapObj->vertPosition;
+                obj->previousVertPosition = snapObj->previousVertPosition;
 
                 obj->firstPass = snapObj->firstPass;
             }
@@ -82,36 +128,38 @@ class Snapshot {
 
         void clearData() {
             groups.clear();
-
-            for (auto obj : objects) {
-                if (!obj.first) { continue; }
-                delete obj.first;
-                obj.first = nullptr;
-            }
+            testParticles.clear();
             objects.clear();
+            arena.reset();
         }
 
         void fullSnapshot(scene* scene) {
-            std::unordered_map<std::string, SnapObj*> dict;
+            std::unordered_map<const simulationObject*, SnapObj*> dict; // groups point at the same objects the scene lists
 
-            groups.clear();
-            dict.clear();
+            clearData(); // the previous scene's objects
             ID = Scenes::currentSceneID;
+            source = scene;
+            layoutVersion = scene->layoutVersion;
 
+            objects.reserve(scene->objects.size());
             for (const auto obj : scene->objects) {
-                SnapObj* newObj = new SnapObj(
+                // the object's own vertPosition may still be from when the scene was last shown - the first step interpolates from here
+                glm::dvec3 vertPosition = obj->position / (simulationMode == simulationType::simplified ? obj->distanceScale : currentScale);
+
+                SnapObj* newObj = arena.create<SnapObj>(
                     obj->position,
                     obj->velocity,
                     obj->acceleration,
                     obj->mass,
 
-                    obj->vertPosition,
+                    vertPosition,
+                    vertPosition,
                     obj->distanceScale,
                     obj->simulate,
                     obj->firstPass
                 );
 
-                dict[obj->name] = newObj;
+                dict[obj] = newObj;
                 objects.push_back({ newObj, obj });
             }
 
@@ -121,12 +169,24 @@ class Snapshot {
                 currentGroup.reserve(group.size());
 
                 for (const auto obj : group) {
-                    currentGroup.push_back(dict[obj->name]);
+                    currentGroup.push_back(dict[obj]);
                 }
 
                 groups.push_back(currentGroup);
             }
 
+            testParticles.reserve(scene->testParticles.size());
+            for (const auto& group : scene->testParticles) {
+                SnapTestParticleGroup currentGroup = { dict[group.attractor], {} };
+                currentGroup.particles.reserve(group.particles.size());
+
+                for (const auto obj : group.particles) {
+                    currentGroup.particles.push_back(dict[obj]);
+                }
+
+                testParticles.push_back(std::move(currentGroup));
+            }
+
             dict.clear();
         }
 
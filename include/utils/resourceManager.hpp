@@ -0,0 +1,272 @@
+#ifndef RESOURCE_MANAGER_HEADER
+#define RESOURCE_MANAGER_HEADER
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <model.hpp>
+#include <shader.hpp>
+#include <3DModelImport.hpp>
+#include <meshCache.hpp>
+#include <meshOptimizer.hpp>
+
+#include <globals.hpp>
+#include <debug.hpp>
+#include <FormatConsole.hpp>
+
+/**
+ * @brief Keeps only the models and shader variants the active scene needs.
+ *
+ * Model files are just indexed at startup; a mesh is read (mesh cache or Assimp) the first time a scene using it
+ * is activated. Scenes hold references on their models and shaders - whatever no scene references stays resident
+ * until the total goes over the memory budget, then the least recently used resources are freed first.
+ * Freed models keep their Model instance, so objects pointing at them stay valid and the mesh is simply read again.
+ */
+class ResourceManager {
+    public:
+        size_t memoryBudget; // bytes; referenced resources are never freed, even over the budget
+
+        MeshCache* meshCache; // owned, may be null
+
+        ResourceManager(const size_t& memoryBudget, MeshCache* meshCache) : memoryBudget(memoryBudget), meshCache(meshCache) {}
+
+        // model read from a file on first use
+        void registerModel(const ModelID& modelID, Model* model, const std::filesystem::path& source) {
+            models[model] = { modelID, source, 0, 0, false };
+        }
+
+        // generated model - has nothing to be read again from, so it's never freed
+        void registerModel(const ModelID& modelID, Model* model) {
+            models[model] = { modelID, {}, 0, 0, true };
+        }
+
+        /**
+         * @brief References the given models and shaders.
+         *
+         * Anything passed here that wasn't registered is left alone.
+         *
+         * @return Models that aren't resident yet - read them with load or loadAsync before drawing.
+         */
+        std::vector<Model*> acquire(const std::vector<Model*>& sceneModels, const std::vector<Shader*>& sceneShaders) {
+            std::vector<Model*> missing;
+
+            for (Model* model : sceneModels) {
+                auto entry = models.find(model);
+                if (entry == models.end()) { continue; }
+
+                entry->second.references++;
+                if (!model->isResident() && !entry->second.source.empty() && !entry->second.failed) { missing.push_back(model); }
+            }
+
+            for (Shader* shader : sceneShaders) { shaders[shader].references++; }
+
+            return missing;
+        }
+
+        /**
+         * @brief Reads and packs the models on the worker pool, the GPU upload of each one comes back through mainThreadCompletions.
+         *
+         * @param onModelLoaded Called on the main thread after every uploaded model.
+         * @param onFinished Called on the main thread once all of them are uploaded (right away if there are none).
+         */
+        void loadAsync(const std::vector<Model*>& missing, std::function<void()> onModelLoaded = nullptr, std::function<void()> onFinished = nullptr) {
+            if (missing.empty()) {
+                if (onFinished) { onFinished(); }
+                return;
+            }
+
+            // only touched from completions, which all run on the main thread
+            struct Batch {
+                std::vector<Model*> models;
+                size_t remaining;
+                std::chrono::steady_clock::time_point start;
+                unsigned int cacheHits;
+            };
+            auto batch = std::make_shared<Batch>(Batch{ missing, missing.size(), std::chrono::steady_clock::now(), meshCache ? meshCache->hits.load() : 0 });
+
+            for (Model* model : missing) {
+                workerPool->submit([this, model, filepath = models[model].source, batch, onModelLoaded, onFinished]() {
+                    ModelData modelData;
+                    PackedMesh packed;
+                    std::string error;
+
+                    // the completion has to come back either way - the batch only finishes once every model reported
+                    try {
+                        if (!meshCache || !meshCache->load(filepath, modelData)) {
+                            modelData = loadSTLData(filepath);
+                            // the cache keeps the optimized order, so this only runs on a cold import
+                            if (!modelData.indices.empty()) { optimizeMesh(modelData); }
+                            if (meshCache) { meshCache->store(filepath, modelData); }
+                        }
+
+                        if (!modelData.indices.empty()) { packed = packMesh(modelData); }
+                    }
+                    catch (const std::exception& e) { error = e.what(); }
+                    catch (...) { error = "unknown error"; }
+
+                    if (!error.empty()) {
+                        modelData = ModelData();
+                        packed = PackedMesh();
+                    }
+
+                    mainThreadCompletions.push([this, model, filepath, error = std::move(error), data = std::move(modelData), packed = std::move(packed), batch, onModelLoaded, onFinished]() mutable {
+                        if (!error.empty()) {
+                            // stays without a mesh, like a file Assimp can't read - and isn't tried again on the next scene switch
+                            models[model].failed = true;
+                            std::cerr << formatError("ERROR") << ": can't load '" << formatPath(filepath.filename().string()) << "': " << error << " ... " << formatProcess("skipping") << std::endl;
+                        }
+
+                        model->modelData = std::move(data);
+                        if (model->isResident()) { model->uploadPacked(packed); }
+
+                        if (onModelLoaded) { onModelLoaded(); }
+
+                        if (--batch->remaining == 0) {
+                            finishBatch(batch->models, batch->start, batch->cacheHits);
+                            if (onFinished) { onFinished(); }
+                        }
+                    });
+                });
+            }
+        }
+
+        // loadAsync that waits for the uploads
+        void load(const std::vector<Model*>& missing) {
+            bool finished = false;
+            loadAsync(missing, nullptr, [&finished]() { finished = true; });
+
+            while (!finished) { mainThreadCompletions.waitAndRun(std::chrono::milliseconds(5)); }
+        }
+
+        // drops the references taken by acquire - nothing is freed before trim
+        void release(const std::vector<Model*>& sceneModels, const std::vector<Shader*>& sceneShaders) {
+            useCounter++;
+
+            for (Model* model : sceneModels) {
+                auto entry = models.find(model);
+                if (entry == models.end() || entry->second.references == 0) { continue; }
+
+                if (--entry->second.references == 0) { entry->second.lastUsed = useCounter; }
+            }
+
+            for (Shader* shader : sceneShaders) {
+                auto entry = shaders.find(shader);
+                if (entry == shaders.end() || entry->second.references == 0) { continue; }
+
+                if (--entry->second.references == 0) { entry->second.lastUsed = useCounter; }
+            }
+        }
+
+        // frees unreferenced resources, least recently used first, until the resident memory fits the budget
+        void trim() {
+            size_t resident = residentMemory();
+            if (resident <= memoryBudget) { return; }
+
+            struct Candidate {
+                uint64_t lastUsed;
+                Model* model;
+                Shader* shader;
+            };
+            std::vector<Candidate> candidates;
+
+            for (const auto& [model, entry] : models) {
+                if (entry.references == 0 && !entry.pinned && model->isResident()) { candidates.push_back({ entry.lastUsed, model, nullptr }); }
+            }
+            for (const auto& [shader, entry] : shaders) {
+                if (entry.references == 0 && shader->variantCount() > 1) { candidates.push_back({ entry.lastUsed, nullptr, shader }); }
+            }
+
+            std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) { return a.lastUsed < b.lastUsed; });
+
+            for (const Candidate& candidate : candidates) {
+                if (resident <= memoryBudget) { break; }
+
+                if (candidate.model) {
+                    resident -= std::min(resident, modelMemory(candidate.model));
+                    candidate.model->releaseData();
+                    evictions++;
+                }
+                else {
+                    size_t before = candidate.shader->residentMemory();
+                    candidate.shader->releaseInactiveVariants();
+                    resident -= std::min(resident, before - std::min(before, candidate.shader->residentMemory()));
+                    evictions++;
+                }
+            }
+        }
+
+        // CPU and GPU memory of every resident model plus the driver memory of the compiled shader variants
+        size_t residentMemory() const {
+            size_t total = 0;
+            for (const auto& [model, entry] : models) { total += modelMemory(model); }
+            for (const auto& [shader, entry] : shaders) { total += shader->residentMemory(); }
+            return total;
+        }
+
+        size_t residentModels() const {
+            size_t count = 0;
+            for (const auto& [model, entry] : models) { count += model->isResident(); }
+            return count;
+        }
+
+        size_t registeredModels() const { return models.size(); }
+
+        unsigned int loads = 0, evictions = 0;
+
+        ~ResourceManager() {
+            delete meshCache;
+            meshCache = nullptr;
+        }
+
+    private:
+        struct ModelEntry {
+            ModelID modelID;
+            std::filesystem::path source; // empty for generated models
+            unsigned int references;
+            uint64_t lastUsed;
+            bool pinned;
+            bool failed = false; // reading it threw - not read again
+        };
+        struct ShaderEntry {
+            unsigned int references = 0;
+            uint64_t lastUsed = 0;
+        };
+
+        std::unordered_map<Model*, ModelEntry> models;
+        std::unordered_map<Shader*, ShaderEntry> shaders;
+
+        uint64_t useCounter = 0;
+
+        static size_t modelMemory(const Model* model) { return model->cpuMemory() + model->bufferedMemory(); }
+
+        void finishBatch(const std::vector<Model*>& batchModels, const std::chrono::steady_clock::time_point& start, const unsigned int& cacheHits) {
+            loads += batchModels.size();
+
+            if (!debugMode) { return; }
+
+            // compared to separate float position / normal buffers with 32-bit indices
+            size_t packedMemory = 0, unpackedMemory = 0;
+            for (Model* model : batchModels) {
+                const ModelData& data = model->modelData;
+                packedMemory += model->bufferedMemory();
+                unpackedMemory += (data.vertices.size() + data.normals.size()) * sizeof(GLfloat) + data.indices.size() * sizeof(GLuint);
+            }
+
+            std::cout << formatProcess("Loaded") << " " << batchModels.size() << " models in " << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() << " ms";
+            if (meshCache) { std::cout << " (" << meshCache->hits - cacheHits << " from cache)"; }
+            std::cout << " - " << packedMemory / 1024 << " KiB buffered (" << unpackedMemory / 1024 << " KiB unpacked)" << std::endl;
+        }
+};
+
+// created in setupModels
+inline ResourceManager* resources = nullptr;
+
+#endif // RESOURCE_MANAGER_HEADER
@@ -5,35 +5,71 @@
 #include "glm/fwd.hpp"
 #include "glm/geometric.hpp"
 #include <simObject.hpp>
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <unordered_map>
 #include <vector>
 #include <types.hpp>
 #include <customMath.hpp>
 
 #include <renderDefinitions.hpp>
+#include <resourceManager.hpp>
+#include <hash.hpp>
+#include <arena.hpp>
+#include <catalogPaging.hpp>
 #include <math.h>
 
+// guards the scene objects the physics thread writes its results back to
+inline std::mutex physicsMutex;
+
 
 using sceneGroup = std::vector<simulationObject*>;
 
+// bodies too light to pull on anything (catalog asteroids) - only the attractor pulls on them, so they cost O(n) instead of O(n²)
+struct testParticleGroup {
+    simulationObject* attractor;
+    std::vector<simulationObject*> particles;
+};
+
 struct scene {
     std::vector<simulationObject*> objects;
     std::vector<sceneGroup> groups;
+    std::vector<testParticleGroup> testParticles; // also listed in objects
+
+    // catalogs too large to load whole - the bodies of their resident tiles come after the scene's own objects
+    std::vector<std::shared_ptr<PagedCatalog>> pagedCatalogs;
+    size_t pagedObjectsBegin = 0;
+    uint64_t layoutVersion = 0; // changes whenever objects are added or removed after loading
+
+    double simulatedTime = 0.0; // seconds simulated since the scene was last reset - paged bodies are placed at it
+
+    // radius range the objects were scaled within - paged in bodies are scaled the same way
+    units::kilometers minObjectRadius = 0.0, maxObjectRadius = 0.0;
+
+    // owns the objects and their model instances - all of them go away at once with the scene
+    Arena arena;
+
+    // adds a copy of a loaded object (SimObjects) with its own instance of the master's model
+    simulationObject* instantiate(const simulationObject& master) {
+        simulationObject* simObject = arena.create<simulationObject>(master, false);
+        simObject->model = arena.create<Model>(*master.model, Model::Flags::MAKE_INSTANCE);
+
+        objects.push_back(simObject);
+        return simObject;
+    }
 
     ~scene() {
-        // objecs contain class copies need to be deleted separately.
-        for (auto* simObject : objects) {
-            if (simObject) {
-                delete simObject;
-                simObject = nullptr;
-            }
-        }
         objects.clear();
         groups.clear();
+        testParticles.clear();
+        pagedCatalogs.clear();
+        arena.release();
     }
 };
 
-using sceneList = std::unordered_map<std::string, scene*>;
+using sceneList = Registry<scene*>;
 
 class Scenes {
     public:
@@ -47,77 +83,299 @@ class Scenes {
     }
 };
 
-inline void setupSceneObjects(const SceneID& sceneID, const bool& setAsActive = true) {
+// models (the masters the objects are instances of) and shaders a scene draws with
+struct SceneResources {
+    std::vector<Model*> models;
+    std::vector<Shader*> shaders;
+};
 
-    lightQue.clear();
+inline SceneResources collectSceneResources(const scene* targetScene) {
+    SceneResources collected;
 
-    currentScale = 0.0;
+    auto collect = [&collected](const simulationObject* simObject) {
+        Model* model = simObject->model->isDerived ? simObject->model->master : simObject->model;
 
-    renderScaleDistortion = max(renderScaleDistortion, 1.0);
+        if (std::find(collected.models.begin(), collected.models.end(), model) == collected.models.end()) { collected.models.push_back(model); }
+        if (std::find(collected.shaders.begin(), collected.shaders.end(), simObject->shader) == collected.shaders.end()) { collected.shaders.push_back(simObject->shader); }
+    };
+
+    for (const auto& simObject : targetScene->objects) { collect(simObject); }
+    for (const auto& catalog : targetScene->pagedCatalogs) { collect(catalog->master); } // paged bodies come and go while the scene is shown
+
+    return collected;
+}
+
+// resources referenced by the active scene
+inline SceneResources activeSceneResources;
+
+// lets go of the active scene's resources in favour of the new (already acquired) ones, then frees what's over the budget
+inline void replaceSceneResources(SceneResources&& acquired, const size_t& residentBefore) {
+    if (!resources) { return; }
+
+    // the new scene's resources were acquired first, so the ones both scenes use are never freed in between
+    resources->release(activeSceneResources.models, activeSceneResources.shaders);
+    resources->trim();
+
+    activeSceneResources = std::move(acquired);
+
+    if (debugMode) {
+        std::cout << formatProcess("Resources") << ": " << residentBefore / 1024 << " KiB -> " << resources->residentMemory() / 1024 << " KiB resident ("
+                  << resources->residentModels() << " / " << resources->registeredModels() << " models, budget " << resources->memoryBudget / (1024 * 1024) << " MiB)" << std::endl;
+    }
+}
+
+// result of the CPU side of a scene switch, applied once the scene becomes the active one
+struct ScenePreparation {
+    double scale = 0.0;
+    std::vector<SceneLight> lights;
+};
+
+// first half of preparing an object - its model radius, normalized unless the models are scaled already
+inline void normalizeSceneObject(simulationObject* simObject) {
+    simObject->calculateAproximateRadius();
+
+    // scaling builds on the transform - without the reset it would compound every time the scene is prepared again
+    simObject->model->transform = glm::mat4(1.0);
+    if (!assumeModleIsScaled) {
+        simObject->normalizeVertices(normalizedModelRadius);
+    }
+}
+
+// second half - scales the object within the scene's radius range; objectOrder (from 1) spaces objects out in simplified mode
+inline void scaleSceneObject(simulationObject* simObject, const units::kilometers& minObjectRadius, const units::kilometers& maxObjectRadius, const size_t& objectOrder) {
+    double scaleFactor;
+
+    if (simulationMode == simulationType::realistic) {
+        scaleFactor = (simObject->radius / minObjectRadius);
+    }
+    else if (simulationMode == simulationType::simplified) {
+        scaleFactor = exponentialScale(minObjectRadius, maxObjectRadius, simObject->radius, maxScale);
+        // if (!currentScale) { currentScale = ( (minObjectRadius /* /1 */ + (MaxObjctRadius / (double)maxScale)) /2 ) * renderScaleDistortion; }
+
+        double distance = glm::distance({0.0, 0.0, 0.0}, simObject->position);
+        if (simObject->isEmissive()) { distance = simObject->radius * (double)starScaleMultiplier; } // object in the origin is likley a star, that I don't want to move
+
+        simObject->distanceScale = distance / (unifiedDistance * objectOrder);
+    }
+
+    simObject->scaleVertices(scaleFactor);
+    simObject->vertexModelRadius *= scaleFactor;
+
+    if (simObject->rotationSpeed != -1.0 && simulateObjectRotation) {
+        double objectCircumference = 2.0 * PI * (double)simObject->radius;
+
+        simObject->vertexRotation = 360.0 * ( ( simObject->rotationSpeed / objectCircumference ) / 3600 ); // degrees per second
+    }
+}
+
+/**
+ * @brief Scales the scene's objects and collects its lights.
+ *
+ * Only touches the scene's own objects (and reads its models' bounds), so it can run on a worker while another scene is drawn.
+ * Every model of the scene has to be resident.
+ */
+inline ScenePreparation prepareSceneObjects(scene* targetScene) {
+    ScenePreparation preparation;
 
     units::kilometers minObjectRadius = DBL_MAX;
     units::kilometers MaxObjctRadius = DBL_MIN;
 
-    for (const auto& simObject : Scenes::allScenes[sceneID]->objects) {
-        simObject->calculateAproximateRadius();
-        if (!assumeModleIsScaled) {
-            simObject->normalizeVertices(normalizedModelRadius);
-        }
-        else {
-            simObject->model->transform = glm::mat4(1.0);
-        }
+    for (const auto& simObject : targetScene->objects) {
+        normalizeSceneObject(simObject);
 
         minObjectRadius = std::min(simObject->radius, minObjectRadius);
         MaxObjctRadius = std::max(simObject->radius, MaxObjctRadius);
     }
 
-    if (minObjectRadius > 0) { // will be -1 if not all objects are present
-        int objectOrder = 1;
-        for (const auto& simObject : Scenes::allScenes[sceneID]->objects) {
+    // paged bodies join later - the range has to hold them already, or the scene's scale would shift as they come in
+    for (const auto& catalog : targetScene->pagedCatalogs) {
+        minObjectRadius = std::min(catalog->master->radius, minObjectRadius);
+        MaxObjctRadius = std::max(catalog->master->radius, MaxObjctRadius);
+    }
+
+    targetScene->simulatedTime = 0.0;
 
+    if (minObjectRadius > 0) { // will be -1 if not all objects are present
+        size_t objectOrder = 1;
+        for (const auto& simObject : targetScene->objects) {
             simObject->loadOriginalValues();
 
-            double scaleFactor;
+            scaleSceneObject(simObject, minObjectRadius, MaxObjctRadius, objectOrder);
 
-            if (simulationMode == simulationType::realistic) {
-                scaleFactor = (simObject->radius / minObjectRadius);
-                if (!currentScale) { currentScale = (minObjectRadius / (double)normalizedModelRadius) * renderScaleDistortion; }
-            }
-            else if (simulationMode == simulationType::simplified) {
-                scaleFactor = exponentialScale(minObjectRadius, MaxObjctRadius, simObject->radius, maxScale);
-                // if (!currentScale) { currentScale = ( (minObjectRadius /* /1 */ + (MaxObjctRadius / (double)maxScale)) /2 ) * renderScaleDistortion; }
+            ++objectOrder;
+        }
+
+        if (simulationMode == simulationType::realistic) { preparation.scale = (minObjectRadius / (double)normalizedModelRadius) * renderScaleDistortion; }
+
+        targetScene->minObjectRadius = minObjectRadius;
+        targetScene->maxObjectRadius = MaxObjctRadius;
+    }
+    else {
+        preparation.scale = 1.0;
+
+        targetScene->minObjectRadius = targetScene->maxObjectRadius = 0.0;
+    }
+
+    // lights - bound by the object's index in the scene
+    const auto& sceneObjects = targetScene->objects;
+    for (size_t i = 0; i < sceneObjects.size(); ++i) {
+        if (sceneObjects[i]->light != nullptr) {
+            preparation.lights.push_back({ i, sceneObjects[i]->light });
+        }
+    }
+
+    return preparation;
+}
+
+// settings prepareSceneObjects depends on - a cached preparation made with different ones has to be redone
+inline uint64_t scenePreparationKey() {
+    uint64_t key = FNV_OFFSET_BASIS;
+    auto add = [&key](const auto& value) { key = fnv1a(&value, sizeof(value), key); };
+
+    add((int)simulationMode);
+    add(renderScaleDistortion);
+    add(maxScale);
+    add(unifiedDistance);
+    add(normalizedModelRadius);
+    add(starScaleMultiplier);
+    add(assumeModleIsScaled);
+    add(simulateObjectRotation);
+
+    return key;
+}
 
-                double distance = glm::distance({0.0, 0.0, 0.0}, simObject->position);
-                if (simObject->objectType == "star") { distance = simObject->radius * (double)starScaleMultiplier; } // object in the origin is likley a star, that I don't want to move
+/**
+ * @brief Prepared state of recently used scenes, so switching back to one skips loading and preparation altogether.
+ *
+ * The objects of every scene are its own, so their scaled transforms and radii simply stay as they were prepared -
+ * an entry keeps the rest (scale, lights) and holds references on the scene's models and shaders so their buffers stay resident.
+ * Least recently used entries are dropped once the memory of the scenes' models goes over the cap.
+ */
+class SceneCache {
+    public:
+        size_t memoryCap; // bytes
+
+        SceneCache(const size_t& memoryCap = 0) : memoryCap(memoryCap) {}
+
+        // null if the scene isn't cached or was prepared with different settings
+        const ScenePreparation* find(const SceneID& sceneID, const uint64_t& settingsKey) {
+            auto entry = entries.find(sceneID.key());
+            if (entry == entries.end()) { return nullptr; }
 
-                simObject->distanceScale = distance / (unifiedDistance * objectOrder);
+            if (entry->second.settingsKey != settingsKey) {
+                erase(entry);
+                return nullptr;
             }
 
-            simObject->model->clearBufferedData(); // does it automatically but this way I can get rid of the warning while keeping it safe
-            simObject->scaleVertices(scaleFactor);
-            simObject->vertexModelRadius *= scaleFactor;
+            entry->second.lastUsed = ++useCounter;
+            return &entry->second.preparation;
+        }
+
+        // the scene's resources have to be resident already
+        void store(const SceneID& sceneID, const ScenePreparation& preparation, const uint64_t& settingsKey, const SceneResources& sceneResources) {
+            auto existing = entries.find(sceneID.key());
+            if (existing != entries.end()) { erase(existing); }
 
-            if (simObject->rotationSpeed != -1.0 && simulateObjectRotation) {
-                double objectCircumference = 2.0 * PI * (double)simObject->radius;
+            if (memoryCap == 0 || !resources) { return; }
 
-                simObject->vertexRotation = 360.0 * ( ( simObject->rotationSpeed / objectCircumference ) / 3600 ); // degrees per second
+            Entry entry = { preparation, settingsKey, sceneResources, ++useCounter, 0 };
+            for (Model* model : sceneResources.models) { entry.memory += model->cpuMemory() + model->bufferedMemory(); }
+
+            resources->acquire(entry.resources.models, entry.resources.shaders);
+            entries.emplace(sceneID.key(), std::move(entry));
+
+            // least recently used first; the scene that was just stored stays even if it alone is over the cap
+            while (memory() > memoryCap && entries.size() > 1) {
+                auto oldest = entries.begin();
+                for (auto candidate = entries.begin(); candidate != entries.end(); ++candidate) {
+                    if (candidate->second.lastUsed < oldest->second.lastUsed) { oldest = candidate; }
+                }
+                erase(oldest);
             }
+        }
 
-            ++objectOrder;
+        size_t memory() const {
+            size_t total = 0;
+            for (const auto& [sceneID, entry] : entries) { total += entry.memory; }
+            return total;
         }
-    }
-    else {
-        currentScale = 1.0;
-    }
 
-    // adds lights to light que
-    for (const auto& simObject : Scenes::allScenes[sceneID]->objects) {
-        if (simObject->light != nullptr) {
-            lightQue[simObject->name] = simObject->light;
+        size_t size() const { return entries.size(); }
+
+        // the scene was rebuilt - its objects aren't the ones the entry was prepared for
+        void forget(const SceneID& sceneID) {
+            auto entry = entries.find(sceneID.key());
+            if (entry != entries.end()) { erase(entry); }
+        }
+
+        unsigned int hits = 0;
+
+    private:
+        struct Entry {
+            ScenePreparation preparation;
+            uint64_t settingsKey;
+            SceneResources resources;
+            uint64_t lastUsed;
+            size_t memory;
+        };
+
+        std::unordered_map<uint64_t, Entry> entries; // by SceneID::key
+        uint64_t useCounter = 0;
+
+        void erase(std::unordered_map<uint64_t, Entry>::iterator entry) {
+            if (resources) { resources->release(entry->second.resources.models, entry->second.resources.shaders); }
+            entries.erase(entry);
         }
+};
+
+inline SceneCache sceneCache;
+
+// -----------------===[ Paged catalogs ]===-----------------
+
+// lists the resident tiles' bodies after the scene's own objects - the physics thread takes the new layout with its next snapshot
+inline void rebuildPagedObjects(scene* targetScene) {
+    std::lock_guard<std::mutex> lock(physicsMutex);
+
+    targetScene->objects.resize(targetScene->pagedObjectsBegin);
+
+    for (const auto& catalog : targetScene->pagedCatalogs) {
+        auto& particles = targetScene->testParticles[catalog->testGroup].particles;
+
+        particles.clear();
+        catalog->residentBodies(particles);
+        targetScene->objects.insert(targetScene->objects.end(), particles.begin(), particles.end());
     }
 
-    // buffer all object's vertices
+    targetScene->layoutVersion++;
+
+    // the physics thread doesn't write back across a layout change, so nothing touches the retired bodies anymore
+    for (const auto& catalog : targetScene->pagedCatalogs) { catalog->releaseRetired(); }
+}
+
+// a scene that isn't shown (or starts over) keeps no tiles - they're placed for the time they were paged in at
+inline void dropPagedTiles(scene* targetScene) {
+    if (targetScene->pagedCatalogs.empty()) { return; }
+
+    for (const auto& catalog : targetScene->pagedCatalogs) { catalog->clear(); }
+    rebuildPagedObjects(targetScene);
+}
+
+// a cached scene only needs its physics state reset
+inline void resetSceneObjects(scene* targetScene) {
+    dropPagedTiles(targetScene);
+    targetScene->simulatedTime = 0.0;
+
+    for (const auto& simObject : targetScene->objects) { simObject->loadOriginalValues(); }
+}
+
+// main thread part - hands the prepared values over to the renderer
+inline void applySceneObjects(const SceneID& sceneID, ScenePreparation& preparation) {
+    lightQue = std::move(preparation.lights);
+    currentScale = preparation.scale;
+
+    selectLightingVariants(lightQue.size());
+
+    // instances only make sure their master is buffered - the resource manager has done that already
     for (const auto& simObject : Scenes::allScenes[sceneID]->objects) {
         simObject->model->sendBufferedVertices();
     }
@@ -125,6 +383,34 @@ inline void setupSceneObjects(const SceneID& sceneID, const bool& setAsActive =
     // light positions will be updated in the main loop
 }
 
+inline void setupSceneObjects(const SceneID& sceneID, const bool& setAsActive = true) {
+    renderScaleDistortion = max(renderScaleDistortion, 1.0);
+
+    scene* targetScene = Scenes::allScenes[sceneID];
+
+    size_t residentBefore = (resources && debugMode) ? resources->residentMemory() : 0;
+    SceneResources acquired = collectSceneResources(targetScene);
+
+    if (resources) { resources->load(resources->acquire(acquired.models, acquired.shaders)); }
+
+    ScenePreparation preparation;
+    uint64_t settingsKey = scenePreparationKey();
+
+    if (const ScenePreparation* cached = sceneCache.find(sceneID, settingsKey)) {
+        resetSceneObjects(targetScene);
+        preparation = *cached;
+        sceneCache.hits++;
+    }
+    else {
+        preparation = prepareSceneObjects(targetScene);
+        sceneCache.store(sceneID, preparation, settingsKey, acquired);
+    }
+
+    applySceneObjects(sceneID, preparation);
+
+    replaceSceneResources(std::move(acquired), residentBefore);
+}
+
 inline void adjustCameraToScene(const SceneID& sceneID) {
     double maxDistance = 0.0;
     double objectVertRadius = 0.0;
@@ -150,6 +436,8 @@ inline void adjustCameraToScene(const SceneID& sceneID) {
 }
 
 void switchSceneAndCalculateObjects(const SceneID& sceneID) {
+    if (Scenes::currentScene && Scenes::currentScene != Scenes::allScenes[sceneID]) { dropPagedTiles(Scenes::currentScene); }
+
     setupSceneObjects(sceneID);
     Scenes::switchScene(sceneID);
     adjustCameraToScene(sceneID);
@@ -157,4 +445,153 @@ void switchSceneAndCalculateObjects(const SceneID& sceneID) {
     elapsedSimTime = std::chrono::seconds(0);
 }
 
+// scene switch running in the background - the previous scene stays on screen until the new one is ready (main thread only)
+struct SceneLoad {
+    bool active = false;
+    SceneID sceneID;
+
+    size_t totalSteps = 0, finishedSteps = 0; // model uploads + the preparation
+    size_t residentBefore = 0;
+
+    SceneResources acquired;
+    std::function<void()> onSwitched;
+
+    float progress() const { return totalSteps ? (float)finishedSteps / totalSteps : 0.0f; }
+};
+
+inline SceneLoad sceneLoad;
+
+inline void finishSceneSwitch(ScenePreparation& preparation, const bool& fromCache = false) {
+    if (!fromCache) { sceneCache.store(sceneLoad.sceneID, preparation, scenePreparationKey(), sceneLoad.acquired); }
+
+    applySceneObjects(sceneLoad.sceneID, preparation);
+
+    if (Scenes::currentScene && Scenes::currentScene != Scenes::allScenes[sceneLoad.sceneID]) { dropPagedTiles(Scenes::currentScene); }
+
+    Scenes::switchScene(sceneLoad.sceneID);
+    adjustCameraToScene(sceneLoad.sceneID);
+
+    elapsedSimTime = std::chrono::seconds(0);
+
+    replaceSceneResources(std::move(sceneLoad.acquired), sceneLoad.residentBefore);
+
+    sceneLoad.finishedSteps = sceneLoad.totalSteps;
+    sceneLoad.active = false;
+
+    if (sceneLoad.onSwitched) { sceneLoad.onSwitched(); }
+}
+
+/**
+ * @brief switchSceneAndCalculateObjects without blocking the frame.
+ *
+ * Models are read and packed on the worker pool and uploaded one by one from mainThreadCompletions (drained with a time budget
+ * every frame), then the objects are scaled on a worker and the scene is swapped in on the main thread.
+ * Requests made while a switch is running are ignored.
+ *
+ * @param onSwitched Called on the main thread right after the swap.
+ */
+inline void beginSceneSwitch(const SceneID& sceneID, std::function<void()> onSwitched = nullptr) {
+    if (sceneLoad.active) { return; }
+
+    renderScaleDistortion = max(renderScaleDistortion, 1.0);
+
+    scene* targetScene = Scenes::allScenes[sceneID];
+
+    sceneLoad = SceneLoad();
+    sceneLoad.active = true;
+    sceneLoad.sceneID = sceneID;
+    sceneLoad.onSwitched = std::move(onSwitched);
+    sceneLoad.residentBefore = (resources && debugMode) ? resources->residentMemory() : 0;
+    sceneLoad.acquired = collectSceneResources(targetScene);
+
+    std::vector<Model*> missing;
+    if (resources) { missing = resources->acquire(sceneLoad.acquired.models, sceneLoad.acquired.shaders); }
+
+    sceneLoad.totalSteps = missing.size() + 1;
+
+    // recently used scene - its buffers are still resident and its objects still scaled, the swap happens right away
+    const ScenePreparation* cached = missing.empty() ? sceneCache.find(sceneID, scenePreparationKey()) : nullptr;
+    if (cached) {
+        auto switchStart = std::chrono::steady_clock::now();
+
+        ScenePreparation preparation = *cached;
+        resetSceneObjects(targetScene);
+        sceneCache.hits++;
+
+        finishSceneSwitch(preparation, true);
+
+        if (debugMode) {
+            std::cout << formatProcess("Switched") << " to '" << Scenes::allScenes.name(sceneID) << "' from the scene cache in "
+                      << std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - switchStart).count() << " us" << std::endl;
+        }
+        return;
+    }
+
+    auto prepare = [targetScene]() {
+        // the same scene again - its objects are on screen right now, so they get reset at the swap instead
+        if (targetScene == Scenes::currentScene) {
+            dropPagedTiles(targetScene);
+
+            ScenePreparation preparation = prepareSceneObjects(targetScene);
+            finishSceneSwitch(preparation);
+            return;
+        }
+
+        workerPool->submit([targetScene]() {
+            ScenePreparation preparation = prepareSceneObjects(targetScene);
+            mainThreadCompletions.push([preparation]() mutable { finishSceneSwitch(preparation); });
+        });
+    };
+
+    if (resources) { resources->loadAsync(missing, []() { sceneLoad.finishedSteps++; }, prepare); }
+    else { prepare(); }
+}
+
+/**
+ * @brief Pages the current scene's catalog tiles in and out around the camera - main thread, once per frame.
+ *
+ * The camera's surroundings stand in for the region physics needs: paged bodies are test particles, so nothing else
+ * depends on which of them are resident. Each catalog gets an equal share of catalogMemoryBudgetMB.
+ */
+inline void updatePagedCatalogs() {
+    scene* targetScene = Scenes::currentScene;
+    if (!targetScene || targetScene->pagedCatalogs.empty() || sceneLoad.active) { return; }
+
+    // vertex units are currentScale km in realistic mode; simplified mode has no single scale, tiles closest to the attractor are kept there
+    const bool simplified = simulationMode == simulationType::simplified;
+    const glm::dvec3 camera = (glm::dvec3)currentCamera->position * currentScale;
+
+    const units::kilometers minRadius = targetScene->minObjectRadius, maxRadius = targetScene->maxObjectRadius;
+    const double scale = currentScale;
+
+    size_t firstOrder = targetScene->pagedObjectsBegin + 1;
+    bool changed = false;
+
+    for (const auto& catalog : targetScene->pagedCatalogs) {
+        CatalogPagingFrame frame;
+        {
+            std::lock_guard<std::mutex> lock(physicsMutex);
+            frame.attractorPosition = catalog->attractor->position;
+            frame.attractorVelocity = catalog->attractor->velocity;
+            frame.time = targetScene->simulatedTime;
+        }
+
+        frame.focus = simplified ? glm::dvec3(0.0) : camera - frame.attractorPosition;
+        frame.gravitationalParameter = GRAVITATIONAL_CONSTANT * catalog->attractor->mass.get<units::kilograms>() / 1e9; // km³/s²
+        frame.memoryBudget = (size_t)catalogMemoryBudgetMB * 1024 * 1024 / targetScene->pagedCatalogs.size();
+
+        frame.prepareBody = [minRadius, maxRadius, scale, simplified, firstOrder](simulationObject* body, const size_t& index) {
+            normalizeSceneObject(body);
+            if (minRadius > 0) { scaleSceneObject(body, minRadius, maxRadius, firstOrder + index); }
+
+            body->vertPosition = body->previousVertPosition = body->position / (simplified ? body->distanceScale : scale);
+        };
+
+        changed |= catalog->update(frame);
+        firstOrder += catalog->bodyCount();
+    }
+
+    if (changed) { rebuildPagedObjects(targetScene); }
+}
+
 #endif // PHYSICS_SCENE_CLASS_HEADER
\ No newline at end of file
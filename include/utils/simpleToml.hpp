@@ -1,163 +1,251 @@
 #ifndef TOML_PARSER_HEADER_LIB
 #define TOML_PARSER_HEADER_LIB
 
+#include <charconv>
+#include <istream>
+#include <iterator>
+#include <stdexcept>
 #include <string>
-#include <sstream>
-#include <unordered_map>
-#include <regex>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
 #include <vector>
-#include <stdexcept>
-
-class TomlEntry;
-
-using TomlCategory = std::unordered_map<std::string, TomlEntry>;
-using InternalTomlData = std::unordered_map<std::string, TomlCategory>;
 
-// value containing the Toml entry value
-class TomlEntry {
+/**
+ * Subset of TOML the settings file uses:
+ *
+ *   [CATEGORY]
+ *   key = value        ; comment
+ *   name = "quoted ; value"
+ *
+ * ';' starts a comment anywhere outside of quotes, '#' only at the start of a line (colors are written as #rrggbb).
+ * Unquoted values run to the comment or the end of the line.
+ */
+
+// syntax or conversion error, with the 1-based position it was found at
+class TomlError : public std::runtime_error {
     public:
-        TomlEntry(): rawValue("") {}
-        TomlEntry(std::string value): rawValue(value) {}
+        unsigned int line, column;
 
-        operator std::string() const { return rawValue; }
-        operator const char*() { return rawValue.c_str(); }
+        TomlError(const std::string& message, const unsigned int& line, const unsigned int& column)
+            : std::runtime_error(std::to_string(line) + ":" + std::to_string(column) + ": " + message), line(line), column(column) {}
+};
 
-        template<typename T>
-        TomlEntry& operator=(T value) {
-            rawValue = std::to_string(value);
-            return *this;
+// a key = value pair - views into the source text of the Toml it came from
+struct TomlValue {
+    std::string_view category;
+    std::string_view key;
+    std::string_view text;      // without the quotes for quoted values
+    unsigned int line, column;  // of the value
+    bool quoted;
+
+    // throws TomlError when the text isn't a valid T
+    template <typename T>
+    T get() const {
+        if constexpr (std::is_same_v<T, std::string>) {
+            return quoted ? unescape() : std::string(text);
         }
-
-        std::string get() {
-            return rawValue;
+        else if constexpr (std::is_same_v<T, bool>) {
+            if (text == "true" || text == "True") { return true; }
+            if (text == "false" || text == "False") { return false; }
+            throw error("expected true or false");
+        }
+        else if constexpr (std::is_enum_v<T>) {
+            return (T)number<int>();
+        }
+        else if constexpr (std::is_arithmetic_v<T>) {
+            return number<T>();
         }
+        else {
+            static_assert(std::is_same_v<T, std::string>, "unsupported TOML value type");
+        }
+    }
+
+    TomlError error(const std::string& message) const {
+        return TomlError(message + " - '" + std::string(key) + " = " + std::string(text) + "'", line, column);
+    }
 
+    private:
         template <typename T>
-        T get() {
-            std::stringstream buffer(rawValue);
-            T out;
-
-            if constexpr (std::is_same_v<T, bool>) {
-                out = rawValue == "true" || rawValue == "True";
-            } 
-            else if constexpr (std::is_integral_v<T> || std::is_enum_v<T>) {
-                int tempOut;
-                try { tempOut = stoi(rawValue); }
-                catch (std::invalid_argument) {
-                    buffer >> tempOut;
-                }
-                out = (T)tempOut;
-            }
-            else if constexpr (std::is_floating_point_v<T>) {
-                double tempOut;
-                try { tempOut = stod(rawValue); }
-                catch (std::invalid_argument) {
-                    buffer >> tempOut;
+        T number() const {
+            const char* begin = text.data();
+            const char* end = text.data() + text.size();
+            if (begin != end && *begin == '+') { ++begin; } // from_chars doesn't take an explicit plus
+
+            T value{};
+            auto [stop, result] = std::from_chars(begin, end, value);
+
+            if (result == std::errc::result_out_of_range) { throw error("number out of range"); }
+            if (result != std::errc() || stop != end) { throw error(std::is_integral_v<T> ? "expected a whole number" : "expected a number"); }
+
+            return value;
+        }
+
+        std::string unescape() const {
+            std::string out;
+            out.reserve(text.size());
+
+            for (size_t i = 0; i < text.size(); ++i) {
+                if (text[i] != '\\' || i + 1 == text.size()) { out += text[i]; continue; }
+
+                switch (text[++i]) {
+                    case 'n': out += '\n'; break;
+                    case 't': out += '\t'; break;
+                    default: out += text[i]; break; // \" and \\ (anything else is taken as is)
                 }
-                out = (T)tempOut;
-            }
-            else {
-                buffer >> out;
             }
 
             return out;
         }
-    private:
-        std::string rawValue;
 };
 
-// Toml data manager
-class Toml {  
+/**
+ * @brief Single pass parser - the source is kept as one string and every value is a view into it,
+ * so parsing allocates nothing per line. Throws TomlError on the first syntax error.
+ */
+class Toml {
     public:
-        Toml() { data = {}; }
-        Toml(std::string tomlData) { internalize(tomlData); }
+        Toml() = default;
+        Toml(std::string tomlData) { parse(std::move(tomlData)); }
 
-        TomlCategory& operator[](std::string i) { return data[i]; }
-        TomlCategory& operator[](const char* i) { return data[i]; }
-        Toml& operator=(std::string value) { internalize(value); return *this; }
-        Toml& operator=(const char* value) { internalize(value); return *this; }
+        void parse(std::string tomlData) {
+            source = std::move(tomlData);
+            entries.clear();
+            entries.reserve(countLines());
 
-        // defines a function that has access to classes private (s)
-        friend std::istream& operator>>(std::istream& is, Toml& toml);
+            std::string_view text = source;
+            std::string_view category;
+            bool hasCategory = false;
 
-        std::string exportToString(bool spacedOutput = false) {
-            std::stringstream exportBuffer;
-            bool firstLine = true;
-            for (const auto& category : data) {
-                exportBuffer << (firstLine? "" : (spacedOutput? "\n" : "")) << '[' << category.first << "]\n";
+            unsigned int lineNumber = 0;
+            size_t lineStart = 0;
 
-                for (const auto& entry : category.second) {
-                    exportBuffer << entry.first << (spacedOutput? " " : "") << (std::string)entry.second << '\n';
-                }
+            while (lineStart < text.size()) {
+                size_t lineEnd = text.find('\n', lineStart);
+                if (lineEnd == std::string_view::npos) { lineEnd = text.size(); }
 
-                firstLine = false;
-            }
+                std::string_view line = text.substr(lineStart, lineEnd - lineStart);
+                if (!line.empty() && line.back() == '\r') { line.remove_suffix(1); }
 
-            return exportBuffer.str();
-        }
+                ++lineNumber;
+                lineStart = lineEnd + 1;
 
-        bool valueExists(std::string value) {
-            for (const auto& category : data) {
-                if (category.second.find(value) != category.second.end()) { return true; }
-            }
-            return false;
-        }
+                size_t i = skipSpaces(line, 0);
+                if (i == line.size() || line[i] == ';' || line[i] == '#') { continue; }
 
-    private:
-        InternalTomlData data;
+                auto fail = [&](const std::string& message, const size_t& position) { return TomlError(message, lineNumber, position + 1); };
 
-        std::vector<std::string> getLines(std::string text) {
-            std::vector<std::string> lines;
-            std::string line;
+                // [CATEGORY]
+                if (line[i] == '[') {
+                    size_t nameStart = skipSpaces(line, i + 1);
+                    size_t nameEnd = nameStart;
+                    while (nameEnd < line.size() && isKeyCharacter(line[nameEnd])) { ++nameEnd; }
 
-            for (const char& character : text) {
-                if (character != '\n') { line += character; }
-                else {lines.push_back(line); line = ""; }
-            }
-            if (line != "") { lines.push_back(line); }
-            
-            return lines;
-        }
+                    if (nameEnd == nameStart) { throw fail("expected a category name", nameStart); }
 
-        void internalize(std::string tomlData) {
-            std::regex pairPattern(R"((\w+)\s*=\s*([[+-]?[0-9]+\.[0-9]+[eE][0-9]+|[+-]?[0-9]+\.[0-9]+|[+-]?[0-9]+|\S+))");
-            std::regex categoryPattern(R"(\[(\w+)\])");
+                    size_t close = skipSpaces(line, nameEnd);
+                    if (close == line.size() || line[close] != ']') { throw fail("expected ']'", close); }
 
-            if (tomlData == "") { throw std::invalid_argument("empty TOML data"); }
+                    expectLineEnd(line, close + 1, lineNumber);
 
-            std::vector<std::string> lines = getLines(tomlData);
+                    category = line.substr(nameStart, nameEnd - nameStart);
+                    hasCategory = true;
+                    continue;
+                }
 
-            if (!std::regex_search(lines[0], categoryPattern)) { throw std::invalid_argument("invalid TOML data"); }
+                // key = value
+                size_t keyEnd = i;
+                while (keyEnd < line.size() && isKeyCharacter(line[keyEnd])) { ++keyEnd; }
 
-            std::string lastCategory;
+                if (keyEnd == i) { throw fail("expected a key", i); }
+                if (!hasCategory) { throw fail("key outside of a [category]", i); }
 
-            for (const auto& line : lines) {
-                std::smatch categoryMatch;
-                if (std::regex_search(line, categoryMatch, categoryPattern)) {
-                    std::string categoryName = categoryMatch[1];
-                    data.emplace(categoryName, TomlCategory{});
-                    lastCategory = categoryName;
-                    continue;
+                std::string_view key = line.substr(i, keyEnd - i);
+
+                size_t equals = skipSpaces(line, keyEnd);
+                if (equals == line.size() || line[equals] != '=') { throw fail("expected '=' after '" + std::string(key) + "'", equals); }
+
+                size_t valueStart = skipSpaces(line, equals + 1);
+                if (valueStart == line.size() || line[valueStart] == ';') { throw fail("missing value for '" + std::string(key) + "'", valueStart); }
+
+                TomlValue value = { category, key, {}, lineNumber, (unsigned int)valueStart + 1, false };
+
+                if (line[valueStart] == '"') {
+                    size_t close = valueStart + 1;
+                    while (close < line.size() && line[close] != '"') { close += (line[close] == '\\') ? 2 : 1; }
+
+                    if (close >= line.size()) { throw fail("unterminated string", valueStart); }
+
+                    expectLineEnd(line, close + 1, lineNumber);
+
+                    value.text = line.substr(valueStart + 1, close - valueStart - 1);
+                    value.quoted = true;
                 }
+                else {
+                    size_t valueEnd = line.find(';', valueStart);
+                    if (valueEnd == std::string_view::npos) { valueEnd = line.size(); }
+                    while (valueEnd > valueStart && isSpace(line[valueEnd - 1])) { --valueEnd; }
 
-                std::smatch pairMatch;
-                if (std::regex_search(line, pairMatch, pairPattern)) {
-                    std::string key = pairMatch[1]; std::string value = pairMatch[2];
-                    data[lastCategory][key] = TomlEntry(value);
+                    value.text = line.substr(valueStart, valueEnd - valueStart);
                 }
+
+                if (find(category, key)) { throw fail("duplicate key '" + std::string(key) + "' in [" + std::string(category) + "]", i); }
+
+                entries.push_back(value);
+            }
+        }
+
+        // null if there is no such key
+        const TomlValue* find(std::string_view category, std::string_view key) const {
+            for (const TomlValue& entry : entries) {
+                if (entry.key == key && entry.category == category) { return &entry; }
+            }
+            return nullptr;
+        }
+
+        // first key with the name in any category
+        const TomlValue* find(std::string_view key) const {
+            for (const TomlValue& entry : entries) {
+                if (entry.key == key) { return &entry; }
             }
+            return nullptr;
+        }
+
+        const std::vector<TomlValue>& values() const { return entries; }
+
+        friend std::istream& operator>>(std::istream& is, Toml& toml);
+
+    private:
+        std::string source;
+        std::vector<TomlValue> entries;
 
+        static bool isSpace(const char& character) { return character == ' ' || character == '\t'; }
+
+        static bool isKeyCharacter(const char& character) {
+            return (character >= 'a' && character <= 'z') || (character >= 'A' && character <= 'Z') || (character >= '0' && character <= '9') || character == '_' || character == '-';
+        }
+
+        static size_t skipSpaces(std::string_view line, size_t position) {
+            while (position < line.size() && isSpace(line[position])) { ++position; }
+            return position;
+        }
+
+        // only spaces or a comment may follow
+        static void expectLineEnd(std::string_view line, const size_t& position, const unsigned int& lineNumber) {
+            size_t rest = skipSpaces(line, position);
+            if (rest < line.size() && line[rest] != ';' && line[rest] != '#') { throw TomlError("unexpected '" + std::string(1, line[rest]) + "'", lineNumber, rest + 1); }
         }
 
+        size_t countLines() const {
+            size_t lines = 1;
+            for (const char& character : source) { lines += character == '\n'; }
+            return lines;
+        }
 };
 
-// Implementation of the friend function
-std::istream& operator>>(std::istream& is, Toml& toml) {
-    std::stringstream buffer;
-    buffer << is.rdbuf();
-    toml.internalize(buffer.str());
+inline std::istream& operator>>(std::istream& is, Toml& toml) {
+    toml.parse(std::string(std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>()));
     return is;
 }
 
 #endif // TOML_PARSER_HEADER_LIB
-
@@ -0,0 +1,575 @@
+#ifndef SIMULATION_DATA_HEADER
+#define SIMULATION_DATA_HEADER
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <format>
+#include <future>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include <json.hpp>
+
+#include <mappedFile.hpp>
+#include <threadPool.hpp>
+#include <FormatConsole.hpp>
+
+/**
+ * Streaming readers for objects.json and scenes.json.
+ *
+ * The files are memory mapped and fed through nlohmann's SAX interface straight into the flat records below - no JSON DOM
+ * is built. Every top-level scene is an independent range of the file, so scenes are parsed in parallel on the worker pool.
+ * Nothing here touches the global lists; turning records into simulation objects happens in simSetup.
+ */
+
+// -----------------===[ Records ]===-----------------
+
+struct LightEntry {
+    std::string color;
+    float intensity = 0.0f;
+    char starType = 0;
+
+    bool hasColor = false, hasIntensity = false, hasStarType = false;
+
+    bool operator==(const LightEntry&) const = default;
+};
+
+// one object of objects.json
+struct ObjectEntry {
+    std::string name, shader, model, color, type;
+    double radius = 0.0, mass = 0.0, rotation = 0.0;
+    LightEntry light;
+
+    bool hasShader = false, hasModel = false, hasColor = false, hasType = false;
+    bool hasRadius = false, hasMass = false, hasRotation = false, hasLight = false;
+
+    bool operator==(const ObjectEntry&) const = default; // hot reload rebuilds only what changed
+};
+
+struct ObjectFile {
+    std::vector<ObjectEntry> objects;
+};
+
+struct SceneObjectEntry {
+    uint32_t object = 0; // index into SceneEntry::names
+    glm::dvec3 position = glm::dvec3(0.0);
+    glm::dvec3 velocity = glm::dvec3(0.0);
+
+    bool hasObject = false, hasPosition = false, hasVelocity = false;
+
+    bool operator==(const SceneObjectEntry&) const = default;
+};
+
+// orbit catalog whose bodies are added to a scene as test particles (see orbitCatalog.hpp)
+struct CatalogEntry {
+    std::string file;   // relative to res/
+    std::string object; // objects.json object every body is an instance of
+
+    bool hasFile = false, hasObject = false;
+
+    bool operator==(const CatalogEntry&) const = default;
+};
+
+// one scene of scenes.json - object names are stored once, objects and groups refer to them by index
+struct SceneEntry {
+    std::string name;
+
+    std::vector<std::string> names;
+    std::vector<SceneObjectEntry> objects;
+
+    // group i has the members groupMembers[groupOffsets[i] .. groupOffsets[i + 1])
+    std::vector<uint32_t> groupMembers;
+    std::vector<uint32_t> groupOffsets = { 0 };
+
+    std::vector<CatalogEntry> catalogs;
+
+    bool hasObjects = false, hasGroups = false;
+
+    std::string error; // set if the scene couldn't be parsed - nothing else is usable then
+
+    size_t groupCount() const { return groupOffsets.size() - 1; }
+
+    bool operator==(const SceneEntry&) const = default;
+
+    uint32_t nameIndex(std::string_view objectName) {
+        auto found = nameIndices.find(std::string(objectName));
+        if (found != nameIndices.end()) { return found->second; }
+
+        uint32_t index = names.size();
+        names.emplace_back(objectName);
+        nameIndices.emplace(names.back(), index);
+
+        return index;
+    }
+
+    private:
+        std::unordered_map<std::string, uint32_t> nameIndices;
+};
+
+struct SceneFile {
+    glm::dvec3 orbit = glm::dvec3(0.0, 1.0, 0.0);
+    std::vector<SceneEntry> scenes;
+};
+
+// -----------------===[ SAX handlers ]===-----------------
+
+using Json = nlohmann::json;
+
+// 1-based line of a byte in the text - only used for error messages
+inline size_t lineAt(const char* text, const char* at) {
+    return std::count(text, at, '\n') + 1;
+}
+
+/**
+ * @brief Fills SceneEntry records from SAX events.
+ *
+ * Parses either the whole file (keys are scene names, plus ORBIT) or the value of a single scene.
+ * Unknown keys are skipped along with everything nested in them.
+ */
+class SceneReader {
+    public:
+        // whole file
+        explicit SceneReader(SceneFile* file) : file(file) {}
+        // a single scene's value
+        explicit SceneReader(SceneEntry* scene) : scene(scene) {}
+
+        bool null() { return true; }
+        bool boolean(bool) { return true; }
+        bool number_integer(Json::number_integer_t value) { return number((double)value); }
+        bool number_unsigned(Json::number_unsigned_t value) { return number((double)value); }
+        bool number_float(Json::number_float_t value, const Json::string_t&) { return number(value); }
+        bool binary(Json::binary_t&) { return true; }
+
+        bool string(Json::string_t& value) {
+            if (stack.empty()) { return true; }
+
+            if (stack.back() == Context::object && next == Slot::objectName) {
+                scene->objects.back().object = scene->nameIndex(value);
+                scene->objects.back().hasObject = true;
+            }
+            else if (stack.back() == Context::group) {
+                scene->groupMembers.push_back(scene->nameIndex(value));
+            }
+            else if (stack.back() == Context::catalog) {
+                CatalogEntry& catalog = scene->catalogs.back();
+                if (next == Slot::catalogFile) { catalog.file = value; catalog.hasFile = true; }
+                else if (next == Slot::catalogObject) { catalog.object = value; catalog.hasObject = true; }
+            }
+
+            return true;
+        }
+
+        bool key(Json::string_t& name) {
+            switch (stack.back()) {
+                case Context::file:
+                    if (name == "ORBIT") { next = Slot::orbit; }
+                    else {
+                        file->scenes.emplace_back();
+                        scene = &file->scenes.back();
+                        scene->name = name;
+                        next = Slot::scene;
+                    }
+                    break;
+                case Context::scene:
+                    next = name == "objects" ? Slot::objects : name == "groups" ? Slot::groups : name == "catalogs" ? Slot::catalogs : Slot::other;
+                    break;
+                case Context::catalog:
+                    next = name == "file" ? Slot::catalogFile : name == "object" ? Slot::catalogObject : Slot::other;
+                    break;
+                case Context::object:
+                    next = name == "object" ? Slot::objectName : name == "position" ? Slot::position : name == "velocity" ? Slot::velocity : Slot::other;
+                    break;
+                default:
+                    next = Slot::other;
+                    break;
+            }
+            return true;
+        }
+
+        bool start_object(std::size_t) {
+            Context child = Context::skip;
+
+            if (stack.empty()) { child = file ? Context::file : Context::scene; }
+            else if (stack.back() == Context::file && next == Slot::scene) { child = Context::scene; }
+            else if (stack.back() == Context::objects) {
+                scene->objects.emplace_back();
+                child = Context::object;
+            }
+            else if (stack.back() == Context::catalogs) {
+                scene->catalogs.emplace_back();
+                child = Context::catalog;
+            }
+
+            stack.push_back(child);
+            return true;
+        }
+
+        bool end_object() {
+            stack.pop_back();
+            return true;
+        }
+
+        bool start_array(std::size_t) {
+            Context child = Context::skip;
+
+            if (!stack.empty()) {
+                switch (stack.back()) {
+                    case Context::file:
+                        if (next == Slot::orbit) { child = startVector(&file->orbit, nullptr); }
+                        break;
+                    case Context::scene:
+                        if (next == Slot::objects) { child = Context::objects; scene->hasObjects = true; }
+                        else if (next == Slot::groups) { child = Context::groups; scene->hasGroups = true; }
+                        else if (next == Slot::catalogs) { child = Context::catalogs; }
+                        break;
+                    case Context::object:
+                        if (next == Slot::position) { child = startVector(&scene->objects.back().position, &scene->objects.back().hasPosition); }
+                        else if (next == Slot::velocity) { child = startVector(&scene->objects.back().velocity, &scene->objects.back().hasVelocity); }
+                        break;
+                    case Context::groups:
+                        child = Context::group;
+                        break;
+                    default:
+                        break;
+                }
+            }
+
+            stack.push_back(child);
+            return true;
+        }
+
+        bool end_array() {
+            if (stack.back() == Context::vector) {
+                if (components != 3) { return fail("expected 3 numbers"); }
+                if (vectorFlag) { *vectorFlag = true; }
+            }
+            else if (stack.back() == Context::group) {
+                scene->groupOffsets.push_back(scene->groupMembers.size());
+            }
+
+            stack.pop_back();
+            return true;
+        }
+
+        bool parse_error(std::size_t position, const std::string&, const nlohmann::detail::exception& exception) {
+            errorPosition = position;
+            error = exception.what();
+            return false;
+        }
+
+        std::string error;
+        size_t errorPosition = 0; // bytes into the parsed range
+
+    private:
+        enum class Context : unsigned char { file, scene, objects, object, vector, groups, group, catalogs, catalog, skip };
+        enum class Slot : unsigned char { other, orbit, scene, objects, groups, catalogs, objectName, position, velocity, catalogFile, catalogObject };
+
+        SceneFile* file = nullptr;
+        SceneEntry* scene = nullptr;
+
+        std::vector<Context> stack;
+        Slot next = Slot::other; // what the value after the last key is
+
+        glm::dvec3* vector = nullptr;
+        bool* vectorFlag = nullptr;
+        unsigned int components = 0;
+
+        Context startVector(glm::dvec3* target, bool* flag) {
+            vector = target;
+            vectorFlag = flag;
+            components = 0;
+            return Context::vector;
+        }
+
+        bool number(const double& value) {
+            if (!stack.empty() && stack.back() == Context::vector) {
+                if (components < 3) { (*vector)[components] = value; }
+                components++;
+            }
+            return true;
+        }
+
+        bool fail(const std::string& message) {
+            error = message;
+            return false;
+        }
+};
+
+// fills ObjectEntry records from SAX events - top-level keys are the object names
+class ObjectReader {
+    public:
+        explicit ObjectReader(ObjectFile* file) : file(file) {}
+
+        bool null() { return true; }
+        bool boolean(bool) { return true; }
+        bool number_integer(Json::number_integer_t value) { return number((double)value); }
+        bool number_unsigned(Json::number_unsigned_t value) { return number((double)value); }
+        bool number_float(Json::number_float_t value, const Json::string_t&) { return number(value); }
+        bool binary(Json::binary_t&) { return true; }
+
+        bool string(Json::string_t& value) {
+            if (stack.empty() || file->objects.empty()) { return true; }
+
+            ObjectEntry& object = file->objects.back();
+
+            if (stack.back() == Context::object) {
+                switch (next) {
+                    case Field::shader: object.shader = value; object.hasShader = true; break;
+                    case Field::model:  object.model = value; object.hasModel = true; break;
+                    case Field::color:  object.color = value; object.hasColor = true; break;
+                    case Field::type:   object.type = value; object.hasType = true; break;
+                    default: break;
+                }
+            }
+            else if (stack.back() == Context::light) {
+                if (next == Field::color) { object.light.color = value; object.light.hasColor = true; }
+                else if (next == Field::starType && !value.empty()) { object.light.starType = value[0]; object.light.hasStarType = true; }
+            }
+
+            return true;
+        }
+
+        bool key(Json::string_t& name) {
+            switch (stack.back()) {
+                case Context::file:
+                    file->objects.emplace_back();
+                    file->objects.back().name = name;
+                    next = Field::object;
+                    break;
+                case Context::object:
+                    next = name == "shader" ? Field::shader : name == "model" ? Field::model : name == "color" ? Field::color
+                         : name == "type" ? Field::type : name == "radius" ? Field::radius : name == "mass" ? Field::mass
+                         : name == "rotation" ? Field::rotation : name == "light" ? Field::light : Field::other;
+                    break;
+                case Context::light:
+                    next = name == "color" ? Field::color : name == "intensity" ? Field::intensity : name == "starType" ? Field::starType : Field::other;
+                    break;
+                default:
+                    next = Field::other;
+                    break;
+            }
+            return true;
+        }
+
+        bool start_object(std::size_t) {
+            Context child = Context::skip;
+
+            if (stack.empty()) { child = Context::file; }
+            else if (stack.back() == Context::file && next == Field::object) { child = Context::object; }
+            else if (stack.back() == Context::object && next == Field::light) {
+                file->objects.back().hasLight = true;
+                child = Context::light;
+            }
+
+            stack.push_back(child);
+            return true;
+        }
+
+        bool end_object() { stack.pop_back(); return true; }
+        bool start_array(std::size_t) { stack.push_back(Context::skip); return true; }
+        bool end_array() { stack.pop_back(); return true; }
+
+        bool parse_error(std::size_t position, const std::string&, const nlohmann::detail::exception& exception) {
+            errorPosition = position;
+            error = exception.what();
+            return false;
+        }
+
+        std::string error;
+        size_t errorPosition = 0;
+
+    private:
+        enum class Context : unsigned char { file, object, light, skip };
+        enum class Field : unsigned char { other, object, shader, model, color, type, radius, mass, rotation, light, intensity, starType };
+
+        ObjectFile* file;
+
+        std::vector<Context> stack;
+        Field next = Field::other;
+
+        bool number(const double& value) {
+            if (stack.empty() || file->objects.empty()) { return true; }
+
+            ObjectEntry& object = file->objects.back();
+
+            if (stack.back() == Context::object) {
+                switch (next) {
+                    case Field::radius:   object.radius = value; object.hasRadius = true; break;
+                    case Field::mass:     object.mass = value; object.hasMass = true; break;
+                    case Field::rotation: object.rotation = value; object.hasRotation = true; break;
+                    default: break;
+                }
+            }
+            else if (stack.back() == Context::light && next == Field::intensity) {
+                object.light.intensity = (float)value;
+                object.light.hasIntensity = true;
+            }
+
+            return true;
+        }
+};
+
+// -----------------===[ Reading ]===-----------------
+
+// a member of the top-level object - its value is left unparsed
+struct JsonMember {
+    std::string key;
+    const char* begin;
+    const char* end;
+};
+
+/**
+ * @brief Finds the members of the top-level object by only matching brackets and strings.
+ *
+ * Much cheaper than parsing, it lets every member be parsed on its own. Malformed values are left for their parser to report.
+ */
+inline std::vector<JsonMember> splitTopLevelObject(const char* text, const char* end) {
+    auto skipSpace = [&end](const char* position) {
+        while (position < end && (*position == ' ' || *position == '\n' || *position == '\r' || *position == '\t')) { ++position; }
+        return position;
+    };
+    auto fail = [&text](const char* at, const std::string& message) {
+        return std::invalid_argument(std::format("line {}: {}", lineAt(text, at), message));
+    };
+    // position after the closing quote
+    auto skipString = [&end](const char* position) {
+        for (++position; position < end; ++position) {
+            if (*position == '\\') { ++position; }
+            else if (*position == '"') { return position + 1; }
+        }
+        return end;
+    };
+
+    std::vector<JsonMember> members;
+
+    const char* position = skipSpace(text);
+    if (position + 3 <= end && (unsigned char)position[0] == 0xEF && (unsigned char)position[1] == 0xBB && (unsigned char)position[2] == 0xBF) { position = skipSpace(position + 3); } // UTF-8 BOM
+
+    if (position == end || *position != '{') { throw fail(position, "expected '{'"); }
+    position = skipSpace(position + 1);
+
+    if (position < end && *position == '}') { return members; }
+
+    while (position < end) {
+        if (*position != '"') { throw fail(position, "expected a key"); }
+
+        const char* keyEnd = skipString(position);
+        std::string_view keyText(position, keyEnd - position);
+        std::string key = keyText.find('\\') == std::string_view::npos ? std::string(keyText.substr(1, keyText.size() - 2)) : Json::parse(keyText).get<std::string>();
+
+        position = skipSpace(keyEnd);
+        if (position == end || *position != ':') { throw fail(position, "expected ':' after \"" + key + "\""); }
+        position = skipSpace(position + 1);
+
+        const char* valueBegin = position;
+        int depth = 0;
+        while (position < end) {
+            char character = *position;
+
+            if (character == '"') { position = skipString(position); continue; }
+            if (character == '{' || character == '[') { ++depth; }
+            else if (character == '}' || character == ']') {
+                if (depth == 0) { break; }
+                --depth;
+            }
+            else if (character == ',' && depth == 0) { break; }
+
+            ++position;
+        }
+
+        const char* valueEnd = position;
+        while (valueEnd > valueBegin && (valueEnd[-1] == ' ' || valueEnd[-1] == '\n' || valueEnd[-1] == '\r' || valueEnd[-1] == '\t')) { --valueEnd; }
+        if (valueEnd == valueBegin) { throw fail(valueBegin, "missing value for \"" + key + "\""); }
+
+        members.push_back({ std::move(key), valueBegin, valueEnd });
+
+        if (position == end) { throw fail(position, "unexpected end of file"); }
+        if (*position == '}') { return members; }
+        if (*position != ',') { throw fail(position, "expected ',' or '}'"); }
+
+        position = skipSpace(position + 1);
+    }
+
+    throw fail(end, "unexpected end of file");
+}
+
+inline const char* mappedText(const MappedFile& file, const std::filesystem::path& path) {
+    if (!file.isOpen()) {
+        throw std::invalid_argument(std::format("Could not open and load Json data from '{}'", formatPath(path.string())));
+    }
+    return (const char*)file.bytes();
+}
+
+inline ObjectFile readObjectFile(const std::filesystem::path& path) {
+    MappedFile mapping(path);
+    const char* text = mappedText(mapping, path);
+
+    ObjectFile objects;
+    ObjectReader reader(&objects);
+
+    if (!Json::sax_parse(text, text + mapping.size(), &reader)) {
+        throw std::invalid_argument(std::format("'{}' line {}: {}", formatPath(path.filename().string()), lineAt(text, text + std::min(reader.errorPosition, mapping.size())), reader.error));
+    }
+
+    return objects;
+}
+
+/**
+ * @brief Reads scenes.json - every scene is parsed as its own task on the pool (or in order without one).
+ *
+ * Structural errors of the file throw, errors inside a scene only mark that scene (SceneEntry::error).
+ * Scenes keep the order of the file.
+ */
+inline SceneFile readSceneFile(const std::filesystem::path& path, ThreadPool* pool = nullptr) {
+    MappedFile mapping(path);
+    const char* text = mappedText(mapping, path);
+    const char* end = text + mapping.size();
+
+    SceneFile sceneFile;
+
+    std::vector<JsonMember> members;
+    try { members = splitTopLevelObject(text, end); }
+    catch (const std::exception& e) {
+        throw std::invalid_argument(std::format("'{}' {}", formatPath(path.filename().string()), e.what()));
+    }
+
+    auto parseScene = [text](const JsonMember& member, SceneEntry& scene) {
+        SceneReader reader(&scene);
+        if (!Json::sax_parse(member.begin, member.end, &reader)) {
+            scene.error = std::format("line {}: {}", lineAt(text, member.begin + std::min(reader.errorPosition, (size_t)(member.end - member.begin))), reader.error);
+        }
+    };
+
+    sceneFile.scenes.reserve(members.size());
+    std::vector<std::future<void>> parsed;
+
+    for (const JsonMember& member : members) {
+        if (member.key == "ORBIT") {
+            SceneReader reader(&sceneFile);
+            std::string wrapped = "{\"ORBIT\":" + std::string(member.begin, member.end) + "}"; // a few bytes
+            if (!Json::sax_parse(wrapped, &reader)) {
+                throw std::invalid_argument(std::format("'{}' line {}: ORBIT - {}", formatPath(path.filename().string()), lineAt(text, member.begin), reader.error));
+            }
+            continue;
+        }
+
+        sceneFile.scenes.emplace_back();
+        SceneEntry& scene = sceneFile.scenes.back();
+        scene.name = member.key;
+
+        if (pool) { parsed.push_back(pool->submit([&parseScene, &member, &scene]() { parseScene(member, scene); })); }
+        else { parseScene(member, scene); }
+    }
+
+    for (auto& result : parsed) { pool->await(result); }
+
+    return sceneFile;
+}
+
+#endif // SIMULATION_DATA_HEADER
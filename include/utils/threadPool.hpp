@@ -0,0 +1,252 @@
+#ifndef THREAD_POOL_HEADER
+#define THREAD_POOL_HEADER
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <future>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// fixed set of worker threads for CPU-only work (decoding, parsing) - nothing submitted here may touch OpenGL
+class ThreadPool {
+    public:
+        ThreadPool(unsigned int threadCount = std::max(1u, std::thread::hardware_concurrency() - 1)) {
+            threadCount = std::max(threadCount, 1u);
+
+            workers.reserve(threadCount);
+            for (unsigned int i = 0; i < threadCount; ++i) {
+                workers.emplace_back([this]() { work(); });
+            }
+        }
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        // exceptions thrown by the function are rethrown from the future's get()
+        template <typename Function>
+        auto submit(Function function) -> std::future<std::invoke_result_t<Function>> {
+            using Result = std::invoke_result_t<Function>;
+
+            auto task = std::make_shared<std::packaged_task<Result()>>(std::move(function));
+            std::future<Result> result = task->get_future();
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                tasks.push([task]() { (*task)(); });
+            }
+            wake.notify_one();
+
+            return result;
+        }
+
+        size_t size() const { return workers.size(); }
+
+        // runs one queued task on the calling thread; false if there was none
+        bool runPendingTask() {
+            std::function<void()> task;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (tasks.empty()) { return false; }
+
+                task = std::move(tasks.front());
+                tasks.pop();
+            }
+            task();
+
+            return true;
+        }
+
+        // get() for tasks that wait on tasks of their own - helps with the queue instead of blocking a worker the subtasks might need
+        template <typename Result>
+        Result await(std::future<Result>& result) {
+            while (result.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+                if (!runPendingTask()) { break; } // the task is running somewhere already
+            }
+            return result.get();
+        }
+
+        /**
+         * @brief Calls function(begin, end) for every chunk of [0, count), spread over the calling thread and the workers.
+         *
+         * The chunks are claimed through a shared index, so the calling thread only ever runs chunks of this loop - unlike await()
+         * it never picks up an unrelated (possibly long) queued task - and it only waits for the chunks a worker is still on.
+         * Workers that get to their helper task after every chunk was claimed return right away.
+         * The first exception thrown by the function is rethrown here once every chunk finished.
+         */
+        template <typename Function>
+        void parallelFor(const size_t& count, const size_t& chunkSize, Function function) {
+            const size_t chunkCount = (count + chunkSize - 1) / chunkSize;
+
+            if (chunkCount <= 1) {
+                if (count) { function((size_t)0, count); }
+                return;
+            }
+
+            struct Loop {
+                std::function<void(size_t, size_t)> function;
+                size_t count, chunkSize, chunkCount;
+
+                std::atomic<size_t> nextChunk = 0;
+                std::atomic<size_t> finishedChunks = 0;
+
+                std::mutex mutex;
+                std::condition_variable finished;
+                std::exception_ptr error;
+            };
+
+            // shared with the helper tasks, which may only run after this returned
+            auto loop = std::make_shared<Loop>();
+            loop->function = std::move(function);
+            loop->count = count;
+            loop->chunkSize = chunkSize;
+            loop->chunkCount = chunkCount;
+
+            auto claimChunks = [loop]() {
+                for (size_t chunk = loop->nextChunk++; chunk < loop->chunkCount; chunk = loop->nextChunk++) {
+                    size_t begin = chunk * loop->chunkSize;
+
+                    try { loop->function(begin, std::min(begin + loop->chunkSize, loop->count)); }
+                    catch (...) {
+                        std::lock_guard<std::mutex> lock(loop->mutex);
+                        if (!loop->error) { loop->error = std::current_exception(); }
+                    }
+
+                    if (++loop->finishedChunks == loop->chunkCount) {
+                        std::lock_guard<std::mutex> lock(loop->mutex);
+                        loop->finished.notify_all();
+                    }
+                }
+            };
+
+            size_t helpers = std::min(workers.size(), chunkCount - 1);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                for (size_t i = 0; i < helpers; ++i) { tasks.push(claimChunks); }
+            }
+            if (helpers == 1) { wake.notify_one(); }
+            else { wake.notify_all(); }
+
+            claimChunks();
+
+            std::unique_lock<std::mutex> lock(loop->mutex);
+            loop->finished.wait(lock, [&loop]() { return loop->finishedChunks == loop->chunkCount; });
+
+            if (loop->error) { std::rethrow_exception(loop->error); }
+        }
+
+        // waits for the tasks that are already queued
+        ~ThreadPool() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopping = true;
+            }
+            wake.notify_all();
+
+            for (auto& worker : workers) { worker.join(); }
+        }
+
+    private:
+        std::vector<std::thread> workers;
+        std::queue<std::function<void()>> tasks;
+
+        std::mutex mutex;
+        std::condition_variable wake;
+        bool stopping = false;
+
+        void work() {
+            while (true) {
+                std::function<void()> task;
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    wake.wait(lock, [this]() { return stopping || !tasks.empty(); });
+
+                    if (tasks.empty()) { return; }
+
+                    task = std::move(tasks.front());
+                    tasks.pop();
+                }
+                task();
+            }
+        }
+};
+
+// work handed back from the workers to the thread owning the GL context (uploads, registering into the global lists)
+class CompletionQueue {
+    public:
+        void push(std::function<void()> completion) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                completions.push_back(std::move(completion));
+            }
+            arrived.notify_one();
+        }
+
+        bool empty() {
+            std::lock_guard<std::mutex> lock(mutex);
+            return completions.empty();
+        }
+
+        // runs everything queued so far, returns how many ran
+        size_t run() {
+            std::vector<std::function<void()>> ready;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                ready.swap(completions);
+            }
+
+            for (auto& completion : ready) { completion(); }
+
+            return ready.size();
+        }
+
+        // runs queued completions until the budget is used up (always at least one), the rest is left for the next call
+        size_t run(const std::chrono::nanoseconds& budget) {
+            auto start = std::chrono::steady_clock::now();
+
+            std::vector<std::function<void()>> ready;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                ready.swap(completions);
+            }
+
+            size_t ran = 0;
+            while (ran < ready.size()) {
+                ready[ran++]();
+                if (std::chrono::steady_clock::now() - start >= budget) { break; }
+            }
+
+            if (ran < ready.size()) {
+                // completions pushed in the meantime came later, so the leftovers go in front of them
+                std::lock_guard<std::mutex> lock(mutex);
+                completions.insert(completions.begin(), std::make_move_iterator(ready.begin() + ran), std::make_move_iterator(ready.end()));
+            }
+
+            return ran;
+        }
+
+        // sleeps until something arrives (or the timeout passes), then runs it
+        size_t waitAndRun(const std::chrono::milliseconds& timeout) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                arrived.wait_for(lock, timeout, [this]() { return !completions.empty(); });
+            }
+            return run();
+        }
+
+    private:
+        std::vector<std::function<void()>> completions;
+
+        std::mutex mutex;
+        std::condition_variable arrived;
+};
+
+#endif // THREAD_POOL_HEADER
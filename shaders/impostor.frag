@@ -0,0 +1,43 @@
+#version 430 core
+
+#include "lighting.glsl"
+
+in vec3 worldPosition;
+flat in vec3 center;
+flat in float radius;
+flat in vec4 surfaceColor;
+
+out vec4 FragColor;
+
+uniform mat4 view;
+uniform mat4 projection;
+uniform vec3 cameraPosition;
+
+void main() {
+    // ray-sphere intersection from the camera through this fragment
+    vec3 rayDirection = normalize(worldPosition - cameraPosition);
+    vec3 offset = cameraPosition - center;
+
+    float b = dot(offset, rayDirection);
+    float c = dot(offset, offset) - radius * radius;
+    float discriminant = b * b - c;
+
+    if (discriminant < 0.0) { discard; }
+
+    vec3 hit = cameraPosition + rayDirection * (-b - sqrt(discriminant));
+
+    // depth of the actual sphere surface instead of the quad
+    vec4 clipPosition = projection * view * vec4(hit, 1.0);
+    gl_FragDepth = (clipPosition.z / clipPosition.w) * 0.5 + 0.5;
+
+    if (surfaceColor.a > 0.5) {
+        FragColor = vec4(surfaceColor.rgb, 1.0);
+        return;
+    }
+
+    uvec2 lightRange = findLightRange(gl_FragCoord.xy, clipPosition.w);
+
+    vec3 result = shadeSurface(surfaceColor.rgb, hit, normalize(hit - center), lightRange);
+
+    FragColor = vec4(result, 1.0);
+}
@@ -0,0 +1,36 @@
+#version 430 core
+
+layout (location = 0) in vec4 body;      // xyz - center, w - radius
+layout (location = 1) in vec4 bodyColor; // rgb - color, a - emissive flag
+
+out vec3 worldPosition;
+flat out vec3 center;
+flat out float radius;
+flat out vec4 surfaceColor;
+
+uniform mat4 view;
+uniform mat4 projection;
+uniform vec3 cameraPosition;
+
+const vec2 corners[4] = vec2[](vec2(-1.0, -1.0), vec2(1.0, -1.0), vec2(-1.0, 1.0), vec2(1.0, 1.0));
+
+void main() {
+    center = body.xyz;
+    radius = body.w;
+    surfaceColor = bodyColor;
+
+    vec3 toCamera = cameraPosition - center;
+    float distance = length(toCamera);
+    vec3 forward = toCamera / distance;
+
+    vec3 right = normalize(cross(abs(forward.y) > 0.99 ? vec3(1.0, 0.0, 0.0) : vec3(0.0, 1.0, 0.0), forward));
+    vec3 up = cross(forward, right);
+
+    // the silhouette seen in perspective is larger than the radius itself
+    float extent = radius * distance / sqrt(max(distance * distance - radius * radius, 1e-6));
+
+    vec2 corner = corners[gl_VertexID];
+    worldPosition = center + (right * corner.x + up * corner.y) * extent;
+
+    gl_Position = projection * view * vec4(worldPosition, 1.0);
+}
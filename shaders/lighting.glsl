@@ -0,0 +1,103 @@
+// clustered forward lighting shared by all lit shaders - include right after '#version 430 core'
+// programs compiled with LIGHT_COUNT defined skip the clusters and go through that many lights directly
+
+struct Light {
+    vec3 position;
+    vec4 color;
+    float intensity;
+};
+
+layout(std140, binding = 0) uniform LightBlock {
+    int lightCount;
+    float lightFallOff;
+    float clusterNear;
+    float clusterFar;
+    uvec4 clusterGrid;
+    vec2 viewportSize;
+};
+
+layout(std430, binding = 1) readonly buffer LightBuffer {
+    Light lights[];
+};
+
+// x - offset into lightIndices, y - amount of lights in the cluster
+layout(std430, binding = 2) readonly buffer LightClusterBuffer {
+    uvec2 lightClusters[];
+};
+
+layout(std430, binding = 3) readonly buffer LightIndexBuffer {
+    uint lightIndices[];
+};
+
+uniform float ambientStrength = 0.2;
+
+// screen tile + exponential depth slice, has to match LightClusterGrid
+uint findLightCluster(vec2 fragmentCoord, float viewDepth) {
+    uvec2 tile = min(uvec2(fragmentCoord / viewportSize * vec2(clusterGrid.xy)), clusterGrid.xy - 1u);
+
+    float slice = log(max(viewDepth, clusterNear) / clusterNear) / log(clusterFar / clusterNear) * float(clusterGrid.z);
+    uint depthSlice = min(uint(max(slice, 0.0)), clusterGrid.z - 1u);
+
+    return tile.x + clusterGrid.x * (tile.y + clusterGrid.y * depthSlice);
+}
+
+#ifdef LIGHT_COUNT
+
+// few lights in the scene - the count is known at compile time, so the loops over it can be unrolled
+uvec2 findLightRange(vec2 fragmentCoord, float viewDepth) {
+    return uvec2(0u, uint(LIGHT_COUNT));
+}
+
+Light getLight(uint i) {
+    return lights[i];
+}
+
+#else
+
+// x - first entry, y - amount of lights reaching this fragment
+uvec2 findLightRange(vec2 fragmentCoord, float viewDepth) {
+    return lightClusters[findLightCluster(fragmentCoord, viewDepth)];
+}
+
+Light getLight(uint i) {
+    return lights[lightIndices[i]];
+}
+
+#endif
+
+float lightAttenuation(Light light, vec3 position) {
+    float distance = length(light.position - position);
+    return light.intensity / (1.0 + 0.1 * lightFallOff * 0.01 * distance * distance);
+}
+
+// Additive blending function
+vec3 blendAdditive(vec3 base, vec3 blend) {
+    return min(base + blend, 1.0);
+}
+
+vec3 shadeSurface(vec3 color, vec3 position, vec3 norm, uvec2 lightRange) {
+    vec3 combinedLightColor = vec3(0.0);
+    float totalDiffuse = 0.0;
+
+    // only the lights reaching this fragment
+    for (uint i = lightRange.x; i < lightRange.x + lightRange.y; ++i) {
+        Light light = getLight(i);
+
+        float attenuation = lightAttenuation(light, position);
+
+        vec3 lightDir = normalize(light.position - position);
+        float diff = max(dot(norm, lightDir), 0.0);
+
+        // Accumulate diffuse intensity
+        totalDiffuse += diff * attenuation;
+
+        // Blend light colors additively with attenuation
+        combinedLightColor = blendAdditive(combinedLightColor, light.color.rgb * diff * attenuation);
+    }
+
+    // Blend surface color with light colors (40% light, 60% surface)
+    vec3 finalColor = mix(color, combinedLightColor, 0.4);
+
+    // Combine lighting components
+    return max(totalDiffuse, ambientStrength) * finalColor;
+}
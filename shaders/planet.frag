@@ -1,4 +1,6 @@
-#version 330 core
+#version 430 core
+
+#include "lighting.glsl"
 
 uniform vec3 color;
 in vec3 normal;
@@ -6,55 +8,11 @@ in vec3 currentPosition;
 
 out vec4 FragColor;
 
-#define MAX_LIGHTS 4
-
-struct Light {
-    vec3 position;
-    vec4 color;
-    float intensity;
-};
-
-layout(std140) uniform LightBlock {
-    Light lights[MAX_LIGHTS];
-    int lightCount;
-    float lightFallOff;
-};
-
-uniform float ambientStrength = 0.2;
-
-// Additive blending function
-vec3 blendAdditive(vec3 base, vec3 blend) {
-    return min(base + blend, 1.0);
-}
-
 void main() {
-    vec3 combinedLightColor = vec3(0.0);
-    float totalDiffuse = 0.0;
-
-    vec3 norm = normalize(normal);
-
-    // Loop through all active lights
-    for (int i = 0; i < lightCount; ++i) {
-        vec3 currentLightColor = lights[i].color.rgb;
-        float distance = length(lights[i].position - currentPosition);
-        float attenuation = 1.0 / (1.0 + 0.1 * lightFallOff * 0.01 * distance * distance);
-        attenuation *= lights[i].intensity;
+    // 1 / w is the view space depth for perspective projections
+    uvec2 lightRange = findLightRange(gl_FragCoord.xy, 1.0 / gl_FragCoord.w);
 
-        vec3 lightDir = normalize(lights[i].position - currentPosition);
-        float diff = max(dot(norm, lightDir), 0.0);
-        
-        // Accumulate diffuse intensity
-        totalDiffuse += diff * attenuation;
-        
-        // Blend light colors additively with attenuation
-        combinedLightColor = blendAdditive(combinedLightColor, currentLightColor * diff * attenuation);
-    }
-
-    // Blend surface color with light colors (40% light, 60% surface)
-    vec3 finalColor = mix(color, combinedLightColor, 0.4);
-
-    // Combine lighting components
-    vec3 result = max(totalDiffuse, ambientStrength) * finalColor;
+    vec3 result = shadeSurface(color, currentPosition, normalize(normal), lightRange);
 
     FragColor = vec4(result, 1.0);
-}
\ No newline at end of file
+}
@@ -0,0 +1,32 @@
+#version 430 core
+
+#include "lighting.glsl"
+
+flat in vec3 bodyPosition;
+flat in vec4 pointColor;
+
+out vec4 FragColor;
+
+uniform vec3 cameraPosition;
+
+void main() {
+    if (pointColor.a > 0.5) {
+        FragColor = vec4(pointColor.rgb, 1.0);
+        return;
+    }
+
+    uvec2 lightRange = findLightRange(gl_FragCoord.xy, 1.0 / gl_FragCoord.w);
+
+    // sub-pixel body - lit fraction of the disc as seen from the camera (phase) instead of per-pixel normals
+    vec3 toCamera = normalize(cameraPosition - bodyPosition);
+    float totalDiffuse = 0.0;
+
+    for (uint i = lightRange.x; i < lightRange.x + lightRange.y; ++i) {
+        Light light = getLight(i);
+
+        vec3 lightDir = normalize(light.position - bodyPosition);
+        totalDiffuse += 0.5 * (1.0 + dot(lightDir, toCamera)) * lightAttenuation(light, bodyPosition);
+    }
+
+    FragColor = vec4(max(totalDiffuse, ambientStrength) * pointColor.rgb, 1.0);
+}
@@ -0,0 +1,18 @@
+#version 430 core
+
+layout (location = 0) in vec4 body;      // xyz - center, w - radius
+layout (location = 1) in vec4 bodyColor; // rgb - color, a - emissive flag
+
+flat out vec3 bodyPosition;
+flat out vec4 pointColor;
+
+uniform mat4 view;
+uniform mat4 projection;
+
+void main() {
+    bodyPosition = body.xyz;
+    pointColor = bodyColor;
+
+    gl_Position = projection * view * vec4(body.xyz, 1.0);
+    gl_PointSize = 1.0;
+}
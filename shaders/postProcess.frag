@@ -6,8 +6,14 @@ in vec2 textureUV;
 uniform sampler2D screenTexture;
 
 uniform vec2 resolution;
-uniform bool enableFXAA = true;
-uniform bool inverseColors = false;
+
+// variant switches - set by the program's defines (see selectPostProcessVariant), not per pixel
+#ifndef ENABLE_FXAA
+#define ENABLE_FXAA 1
+#endif
+#ifndef INVERSE_COLORS
+#define INVERSE_COLORS 0
+#endif
 
 // FXAA Constants
 #define FXAA_REDUCE_MIN (1.0/128.0)
@@ -65,9 +71,13 @@ vec4 applyFXAA(sampler2D tex, vec2 uv, vec2 res) {
 void main() {
     vec4 outColor = texture(screenTexture, textureUV);
 
-    if (enableFXAA) { outColor = applyFXAA(screenTexture, textureUV, resolution); }
+#if ENABLE_FXAA
+    outColor = applyFXAA(screenTexture, textureUV, resolution);
+#endif
 
-    if (inverseColors) { outColor = vec4(1.0 - outColor.rgb, 1.0); }
+#if INVERSE_COLORS
+    outColor = vec4(1.0 - outColor.rgb, 1.0);
+#endif
 
     FragColor = outColor;
 }
\ No newline at end of file
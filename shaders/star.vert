@@ -1,7 +1,9 @@
 #version 330 core
 
+#include "vertexPacking.glsl"
+
 layout (location = 0) in vec3 vertexPos;
-layout (location = 1) in vec3 faceNormal;
+layout (location = 1) in vec2 faceNormal; // octahedral
 
 out vec3 normal;
 out vec3 currentPosition;
@@ -14,7 +16,7 @@ void main() {
     // Transform vertex position to world space
     currentPosition = vec3(model * vec4(vertexPos, 1.0f));
 
-    normal = transpose(inverse(mat3(model))) * faceNormal;
+    normal = transpose(inverse(mat3(model))) * decodeOctahedral(faceNormal);
 
     // Transform vertex to clip space
     gl_Position = projection * view * model * vec4(vertexPos, 1.0f);
@@ -0,0 +1,13 @@
+// decoding for the packed vertex formats of include/utils/meshOptimizer.hpp
+
+// octahedral normal - two signed bytes, already normalized to [-1, 1] by the attribute setup
+vec3 decodeOctahedral(vec2 encoded) {
+    vec3 normal = vec3(encoded, 1.0f - abs(encoded.x) - abs(encoded.y));
+
+    // lower hemisphere is folded over the diagonals
+    float fold = max(-normal.z, 0.0f);
+    normal.x += normal.x >= 0.0f ? -fold : fold;
+    normal.y += normal.y >= 0.0f ? -fold : fold;
+
+    return normalize(normal);
+}
@@ -0,0 +1,395 @@
+#include <config.hpp>
+#include <globals.hpp>
+#include <state.hpp>
+#include <debug.hpp>
+#include <FormatConsole.hpp>
+
+#include <simObject.hpp>
+#include <scenes.hpp>
+#include <physicsThread.hpp>
+#include <simulationData.hpp>
+#include <threadPool.hpp>
+#include <renderDefinitions.hpp>
+#include <json.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+// light benchmark - synthetic scene with a large amount of stars, run with '--benchmark-lights [star count]'
+unsigned int benchmarkStarCount = 0;
+bool benchmarkRunning = false;
+
+SceneID benchmarkSceneID; // registered by setupLightBenchmark
+
+const unsigned int benchmarkPlanetCount = 64;
+const unsigned int benchmarkWarmupFrames = 60;
+const unsigned int benchmarkMeasuredFrames = 600;
+
+std::vector<double> benchmarkFrameTimes;
+
+void parseBenchmarkArguments(int argc, char** argv) {
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--benchmark-lights") != 0) { continue; }
+
+        benchmarkStarCount = 256;
+        if (i + 1 < argc && std::isdigit(argv[i + 1][0])) { benchmarkStarCount = std::max(std::stoi(argv[i + 1]), 1); }
+    }
+}
+
+simulationObject* findTemplateObject(const std::string& objectType) {
+    for (const auto& [objectID, object] : SimObjects) {
+        if (object->objectType == objectType && (!object->isEmissive() || object->light)) { return object; }
+    }
+    return nullptr;
+}
+
+// builds the benchmark scene from the first star and planet in objects.json
+bool setupLightBenchmark() {
+    simulationObject* starTemplate = findTemplateObject("star");
+    simulationObject* planetTemplate = findTemplateObject("planet");
+
+    if (!starTemplate || !planetTemplate) {
+        std::cerr << formatError("ERROR") << ": light benchmark needs at least one star and one planet in '" << formatPath(simObjectsConfigPath.string()) << "'" << std::endl;
+        return false;
+    }
+
+    std::mt19937 random(42); // fixed seed -> same scene on every run
+    std::uniform_real_distribution<double> unit(-1.0, 1.0);
+    std::uniform_real_distribution<double> orbitDistance(5.0e7, 7.5e8); // km
+
+    const std::string starTypes = "OBAFGKM";
+    const glm::dvec3 orbitUp(0.0, 1.0, 0.0);
+
+    scene* benchmarkScene = new scene();
+
+    auto addObject = [&](simulationObject* objectTemplate, const std::string& name) {
+        simulationObject* master = new simulationObject(*objectTemplate, true);
+        master->name = name;
+
+        if (objectTemplate->light) {
+            master->light = new LightObject(*objectTemplate->light);
+            master->light->starType = starTypes[SimObjects.size() % starTypes.size()];
+        }
+
+        SimObjects.add(name, master);
+
+        return benchmarkScene->instantiate(*master);
+    };
+
+    // heavy star in the middle everything orbits
+    simulationObject* anchor = addObject(starTemplate, "benchmark-anchor");
+    anchor->mass = anchor->mass * 1.0e3;
+    anchor->setCurrentAsOriginal();
+
+    for (unsigned int i = 0; i < benchmarkStarCount + benchmarkPlanetCount - 1; ++i) {
+        bool isStar = i < benchmarkStarCount - 1;
+        simulationObject* object = addObject(isStar ? starTemplate : planetTemplate, (isStar ? "benchmark-star-" : "benchmark-planet-") + std::to_string(i));
+
+        glm::dvec3 direction = glm::normalize(glm::dvec3(unit(random), unit(random) * 0.25, unit(random)));
+        object->position = direction * orbitDistance(random);
+        object->velocity = calcIdealOrbitVelocity(object, anchor, glm::normalize(glm::cross(direction, orbitUp)));
+        object->setCurrentAsOriginal();
+
+        benchmarkScene->groups.push_back({ anchor, object });
+    }
+
+    benchmarkSceneID = Scenes::allScenes.add("Benchmark", benchmarkScene);
+
+    // nothing should hold the frame rate back
+    VSync = 0;
+    glfwSwapInterval(VSync);
+    frameDuration = nanoseconds(0);
+
+    switchSceneAndCalculateObjects(benchmarkSceneID);
+
+    showScenePicker = false;
+    transitionState(state::running);
+
+    benchmarkFrameTimes.reserve(benchmarkMeasuredFrames);
+    benchmarkRunning = true;
+
+    std::cout << formatProcess("Benchmark") << ": " << benchmarkStarCount << " stars, " << benchmarkPlanetCount << " planets ... " << std::flush;
+
+    return true;
+}
+
+void reportLightBenchmark() {
+    std::vector<double> sorted = benchmarkFrameTimes;
+    std::sort(sorted.begin(), sorted.end());
+
+    double total = 0.0;
+    for (double frameTime : sorted) { total += frameTime; }
+
+    double average = total / sorted.size();
+    double median = sorted[sorted.size() / 2];
+    double percentile99 = sorted[std::min(sorted.size() - 1, (size_t)(sorted.size() * 0.99))];
+
+    size_t maxClusterLights = 0, occupiedClusters = 0;
+    for (const auto& cluster : lightClusters.clusters) {
+        maxClusterLights = std::max(maxClusterLights, (size_t)cluster.y);
+        if (cluster.y) { occupiedClusters++; }
+    }
+
+    std::cout << formatSuccess("Done") << "\n"
+              << formatRole("frame time") << "    avg " << average << " ms | median " << median << " ms | p99 " << percentile99 << " ms | " << 1'000.0 / average << " FPS\n"
+              << formatRole("lights") << "        " << shaderLights.size() << " total | " << lightClusters.lightIndices.size() << " cluster entries | "
+              << (occupiedClusters ? (double)lightClusters.lightIndices.size() / occupiedClusters : 0.0) << " avg / " << maxClusterLights << " max per occupied cluster\n" << std::endl;
+}
+
+// called once per frame from the main loop
+void recordBenchmarkFrame() {
+    static unsigned int frame = 0;
+    static auto lastFrame = steady_clock::now();
+
+    // the GPU work is measured as well - the render thread waits for it on benchmark frames
+
+    auto now = steady_clock::now();
+    double frameTime = duration<double, std::milli>(now - lastFrame).count();
+    lastFrame = now;
+
+    if (++frame <= benchmarkWarmupFrames) { return; }
+
+    benchmarkFrameTimes.push_back(frameTime);
+
+    if (benchmarkFrameTimes.size() >= benchmarkMeasuredFrames) {
+        renderThread.invoke(reportLightBenchmark); // reads the render thread's light lists
+
+        benchmarkRunning = false;
+        transitionState(state::stopping);
+    }
+}
+
+// scene memory check - switches through every scene repeatedly and fails if memory keeps growing, run with '--check-scene-memory [rounds]'
+unsigned int sceneMemoryCheckRounds = 0;
+
+void parseSceneMemoryCheckArguments(int argc, char** argv) {
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--check-scene-memory") != 0) { continue; }
+
+        sceneMemoryCheckRounds = 20;
+        if (i + 1 < argc && std::isdigit(argv[i + 1][0])) { sceneMemoryCheckRounds = std::max(std::stoi(argv[i + 1]), 2); }
+    }
+}
+
+// resident set of the whole process in bytes, 0 where it can't be read
+size_t processResidentMemory() {
+#ifdef __linux__
+    std::ifstream statm("/proc/self/statm");
+    size_t totalPages = 0, residentPages = 0;
+    if (statm >> totalPages >> residentPages) { return residentPages * (size_t)sysconf(_SC_PAGESIZE); }
+#endif
+    return 0;
+}
+
+struct SceneMemoryUsage {
+    size_t arenas = 0;      // reserved by the scenes and the snapshot
+    size_t resources = 0;   // resident models and shader variants
+    size_t process = 0;
+};
+
+SceneMemoryUsage measureSceneMemory(const Snapshot& snapshot) {
+    SceneMemoryUsage usage;
+
+    for (const auto& [sceneID, scene] : Scenes::allScenes) { usage.arenas += scene->arena.reserved(); }
+    usage.arenas += snapshot.arena.reserved();
+
+    usage.resources = resources ? resources->residentMemory() : 0;
+    usage.process = processResidentMemory();
+
+    return usage;
+}
+
+/**
+ * @brief Runs instead of the main loop - every round switches to every scene, takes a physics snapshot of it
+ * and builds and tears down a throwaway scene of all loaded objects.
+ *
+ * The first round only warms up (models get loaded, caches filled). After it, the scene arenas and the resident resources
+ * must not grow at all and the process may grow by a few MiB at most (driver and allocator noise).
+ *
+ * @return Whether memory stayed flat.
+ */
+bool checkSceneMemory() {
+    const size_t processSlack = 4 * 1024 * 1024;
+
+    if (Scenes::allScenes.empty()) {
+        std::cerr << formatError("ERROR") << ": scene memory check needs at least one scene in '" << formatPath(physicsScenesPath.string()) << "'" << std::endl;
+        return false;
+    }
+
+    std::cout << formatProcess("Checking") << " scene memory over " << sceneMemoryCheckRounds << " rounds of " << Scenes::allScenes.size() << " scenes ... " << std::flush;
+
+    Snapshot snapshot;
+    SceneMemoryUsage baseline;
+    size_t switches = 0, teardowns = 0;
+
+    for (unsigned int round = 0; round < sceneMemoryCheckRounds; ++round) {
+        for (const auto& [sceneID, scene] : Scenes::allScenes) {
+            switchSceneAndCalculateObjects(sceneID);
+            snapshot.takeSnapshot();
+            switches++;
+        }
+
+        // teardown is a single arena release
+        ::scene* throwaway = new ::scene();
+        for (const auto& [objectID, object] : SimObjects) { throwaway->instantiate(*object); }
+        delete throwaway;
+        teardowns++;
+
+        if (round == 0) { baseline = measureSceneMemory(snapshot); }
+    }
+
+    SceneMemoryUsage after = measureSceneMemory(snapshot);
+
+    bool passed = after.arenas <= baseline.arenas && after.resources <= baseline.resources && after.process <= baseline.process + processSlack;
+
+    std::cout << (passed ? formatSuccess("Done") : formatError("FAILED")) << "\n"
+              << formatRole("switches") << "      " << switches << " scene switches, " << teardowns << " scene teardowns\n"
+              << formatRole("arenas") << "        " << baseline.arenas / 1024 << " KiB -> " << after.arenas / 1024 << " KiB\n"
+              << formatRole("resources") << "     " << baseline.resources / 1024 << " KiB -> " << after.resources / 1024 << " KiB\n"
+              << formatRole("process") << "       " << baseline.process / 1024 << " KiB -> " << after.process / 1024 << " KiB\n" << std::endl;
+
+    return passed;
+}
+
+// loading benchmark - streaming scene reader against a full JSON document on a generated scenes file, run with '--benchmark-loading [bodies]'
+unsigned int loadingBenchmarkBodies = 0;
+
+void parseLoadingBenchmarkArguments(int argc, char** argv) {
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--benchmark-loading") != 0) { continue; }
+
+        loadingBenchmarkBodies = 1'000'000;
+        if (i + 1 < argc && std::isdigit(argv[i + 1][0])) { loadingBenchmarkBodies = std::max(std::stoi(argv[i + 1]), 1); }
+    }
+}
+
+// peak resident set since the last reset, 0 where it can't be read
+size_t processPeakMemory() {
+#ifdef __linux__
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.rfind("VmHWM:", 0) == 0) { return std::stoull(line.substr(6)) * 1024; }
+    }
+#endif
+    return 0;
+}
+
+void resetPeakMemory() {
+#ifdef __linux__
+    std::ofstream("/proc/self/clear_refs") << "5"; // peak resident set = current one
+#endif
+}
+
+// scenes.json shaped file - a few scenes sharing the bodies, every body in a group with the scene's anchor
+void writeLoadingBenchmarkFile(const std::filesystem::path& path, const unsigned int& bodies) {
+    const unsigned int sceneCount = 8;
+
+    std::mt19937 random(42);
+    std::uniform_real_distribution<double> coordinate(-1.0e9, 1.0e9);
+
+    std::ofstream file(path);
+    file << "{\n    \"ORBIT\": [0, 1, 0]";
+
+    char number[64];
+    auto writeVector = [&]() {
+        file << '[';
+        for (int axis = 0; axis < 3; ++axis) {
+            std::snprintf(number, sizeof(number), "%.9e", coordinate(random));
+            file << (axis ? ", " : "") << number;
+        }
+        file << ']';
+    };
+
+    for (unsigned int sceneIndex = 0; sceneIndex < sceneCount; ++sceneIndex) {
+        unsigned int sceneBodies = bodies / sceneCount + (sceneIndex < bodies % sceneCount);
+
+        file << ",\n    \"Catalog-" << sceneIndex << "\": {\n        \"objects\": [\n            {\"object\": \"anchor\", \"position\": [0, 0, 0]}";
+        for (unsigned int body = 0; body < sceneBodies; ++body) {
+            file << ",\n            {\"object\": \"body-" << body << "\", \"position\": ";
+            writeVector();
+            file << ", \"velocity\": ";
+            writeVector();
+            file << '}';
+        }
+
+        file << "\n        ],\n        \"groups\": [";
+        for (unsigned int body = 0; body < sceneBodies; ++body) { file << (body ? ",\n            " : "\n            ") << "[\"anchor\", \"body-" << body << "\"]"; }
+        file << "\n        ]\n    }";
+    }
+
+    file << "\n}\n";
+}
+
+// runs before the window opens - returns whether both readers agree on the generated file
+bool runLoadingBenchmark() {
+    std::filesystem::path path = std::filesystem::temp_directory_path() / "simulacrum-loading-benchmark.json";
+
+    std::cout << formatProcess("Benchmark") << ": loading " << loadingBenchmarkBodies << " bodies ... " << std::flush;
+    writeLoadingBenchmarkFile(path, loadingBenchmarkBodies);
+
+    ThreadPool pool;
+
+    struct Result {
+        double milliseconds;
+        size_t peakMemory;
+        size_t bodies;
+    };
+
+    auto measure = [](auto load) {
+        resetPeakMemory();
+        size_t before = processResidentMemory();
+        auto start = steady_clock::now();
+
+        size_t bodies = load();
+
+        double milliseconds = duration<double, std::milli>(steady_clock::now() - start).count();
+        size_t peak = processPeakMemory();
+
+        return Result{ milliseconds, peak > before ? peak - before : 0, bodies };
+    };
+
+    Result streaming = measure([&]() {
+        SceneFile data = readSceneFile(path, &pool);
+
+        size_t bodies = 0;
+        for (const SceneEntry& scene : data.scenes) { bodies += scene.objects.size(); }
+        return bodies;
+    });
+
+    Result document = measure([&]() {
+        std::ifstream file(path);
+        nlohmann::json data;
+        file >> data;
+
+        size_t bodies = 0;
+        for (const auto& [sceneID, sceneData] : data.items()) {
+            if (sceneData.is_object() && sceneData.contains("objects")) { bodies += sceneData["objects"].size(); }
+        }
+        return bodies;
+    });
+
+    size_t fileSize = std::filesystem::file_size(path);
+    std::filesystem::remove(path);
+
+    bool agree = streaming.bodies == document.bodies;
+
+    std::cout << (agree ? formatSuccess("Done") : formatError("FAILED")) << "\n"
+              << formatRole("file") << "          " << fileSize / (1024 * 1024) << " MiB, " << streaming.bodies << " bodies in 8 scenes\n"
+              << formatRole("streaming") << "     " << streaming.milliseconds << " ms | " << streaming.peakMemory / (1024 * 1024) << " MiB peak (" << pool.size() << " workers)\n"
+              << formatRole("document") << "      " << document.milliseconds << " ms | " << document.peakMemory / (1024 * 1024) << " MiB peak\n" << std::endl;
+
+    return agree;
+}
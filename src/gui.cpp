@@ -6,6 +6,7 @@
 #include <renderDefinitions.hpp>
 #include <physicsThread.hpp>
 #include <scenes.hpp>
+#include <framePacer.hpp>
 
 // 3rd party headers
 #include <imgui/imgui.h>
@@ -31,12 +32,13 @@ void renderSimPerfDisplay();
 void renderSettingsMenu();
 void renderScenePicker();
 void renderBackgChanger();
+void renderLoadingProgress();
 
-void renderGui() {
+// builds the GUI on the main thread and copies its draw lists out for the render thread
+void renderGui(GuiDrawData& drawData) {
     io = &ImGui::GetIO();
 
-    // Start the Dear ImGui frame
-    ImGui_ImplOpenGL3_NewFrame();
+    // Start the Dear ImGui frame - the OpenGL backend's objects are made once in setupGui
     ImGui_ImplGlfw_NewFrame();
     ImGui::NewFrame();
 
@@ -54,9 +56,26 @@ void renderGui() {
         renderSettingsMenu();
     }
 
+    if (sceneLoad.active) { renderLoadingProgress(); }
+
     // Rendering
     ImGui::Render();
-    ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+
+    // the copied draw lists don't carry texture updates (new glyphs) - they are uploaded before the copy is drawn
+    ImDrawData* source = ImGui::GetDrawData();
+    if (source->Textures) {
+        bool texturesChanged = std::any_of(source->Textures->begin(), source->Textures->end(), [](const ImTextureData* texture) { return texture->Status != ImTextureStatus_OK; });
+
+        if (texturesChanged) {
+            renderThread.invoke([source]() {
+                for (ImTextureData* texture : *source->Textures) {
+                    if (texture->Status != ImTextureStatus_OK) { ImGui_ImplOpenGL3_UpdateTexture(texture); }
+                }
+            });
+        }
+    }
+
+    drawData.capture(source);
 }
 
 
@@ -73,25 +92,44 @@ void renderScenePicker() {
     ImGui::Begin("Scene Picker", &showScenePicker, ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoCollapse);
     ImGui::PopFont();
 
-    for (const auto& [name, scene] : Scenes::allScenes) {
+    for (const auto& [sceneID, scene] : Scenes::allScenes) {
+        const std::string& name = Scenes::allScenes.name(sceneID);
         ImGui::TextUnformatted(name.c_str());
 
         std::string button_label = "Switch##" + name;
 
         ImGui::SameLine(0.0f, 10.0f);
+        ImGui::BeginDisabled(sceneLoad.active); // one switch at a time
         if (ImGui::Button(button_label.c_str())) {
-            switchSceneAndCalculateObjects(name);
+            // the current scene stays on screen while the new one loads in the background
+            transitionState(state::loading);
+
+            // a cached scene is swapped in right away, which needs the GL context
+            renderThread.invoke([sceneID]() { beginSceneSwitch(sceneID, []() { transitionState(state::running); }); });
 
             showScenePicker = false;
-            transitionState(state::running);
 
             if (showMenu) { showMenu = false; } // ensures clear first look
         }
+        ImGui::EndDisabled();
     }
 
     ImGui::End();
 }
 
+// shown until a background scene switch is swapped in
+void renderLoadingProgress() {
+    ImGui::SetNextWindowPos(ImVec2(io->DisplaySize.x * 0.5f, io->DisplaySize.y * 0.5f), ImGuiCond_Always, ImVec2(0.5f, 0.5f));
+    ImGui::SetNextWindowSize(ImVec2(io->DisplaySize.x * 0.4f, 0.0f), ImGuiCond_Always);
+
+    ImGui::Begin("Loading", nullptr, ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoCollapse | ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_NoInputs);
+
+    ImGui::Text("Loading %s", Scenes::allScenes.name(sceneLoad.sceneID).c_str());
+    ImGui::ProgressBar(sceneLoad.progress(), ImVec2(-FLT_MIN, 0.0f));
+
+    ImGui::End();
+}
+
 void renderBackgChanger() {
     transitionState(state::paused);
 
@@ -104,9 +142,7 @@ void renderBackgChanger() {
 
     ImGui::SliderFloat("R", &backgroundColor.decR, 0.0f, 1.0f, "%.2f");
     ImGui::SliderFloat("G", &backgroundColor.decG, 0.0f, 1.0f, "%.2f");
-    ImGui::SliderFloat("B", &backgroundColor.decB, 0.0f, 1.0f, "%.2f");
-
-    glClearColor(backgroundColor.decR, backgroundColor.decG, backgroundColor.decB, backgroundColor.a);
+    ImGui::SliderFloat("B", &backgroundColor.decB, 0.0f, 1.0f, "%.2f"); // goes out with every frame
 
     ImGui::End();
 }
@@ -222,55 +258,41 @@ void renderSettingsMenu() {
         ImGui::Checkbox("Show FPS", &showFPS);
         ImGui::Checkbox("Show elapsed sim time", &showElapsedSimTime);
 
-        static bool localVsync = VSync;
-        ImGui::Checkbox("VSync", &localVsync);
-        if (localVsync != VSync) {
+        // read every frame - the value can also change with a settings reload
+        bool localVsync = VSync;
+        if (ImGui::Checkbox("VSync", &localVsync)) {
             VSync = localVsync;
-            glfwSwapInterval(VSync);
+            renderThread.post([vsync = VSync]() { glfwSwapInterval(vsync); }); // the context is current on the render thread
         }
 
         if (!VSync) {
-            static int lastMaxFPS = maxFrameRate;
-
-            ImGui::SliderInt("Max FPS", &lastMaxFPS, 10, 300, "%i FPS");
-
-            if (lastMaxFPS != maxFrameRate) {
-                lastMaxFPS = (lastMaxFPS / (int)10) * 10;
+            int maxFrameRateLocal = maxFrameRate;
 
+            // read every frame like VSync - only snapped to tens when dragged, so a reloaded 144 stays 144
+            if (ImGui::SliderInt("Max FPS", &maxFrameRateLocal, 10, 300, "%i FPS")) {
+                maxFrameRate = std::max((maxFrameRateLocal / (int)10) * 10, 10);
                 frameDuration = nanoseconds(1'000'000'000 / maxFrameRate);
-                maxFrameRate = lastMaxFPS;
             }
         }
 
         ImGui::Checkbox("Post Process", &doPostProcess);
 
         if (doPostProcess) {
-            // FixMe: This is kinda a hack, consider rewriting
-            static bool doFXAALocal = doFXAA, inverseColorsLocal = inverseColors;
+            // both are compiled into the post process program - switches to the matching precompiled variant
+            bool toggled = ImGui::Checkbox("FXAA", &doFXAA);
+            toggled |= ImGui::Checkbox("Inverse colors", &inverseColors);
 
-            ImGui::Checkbox("FXAA", &doFXAALocal);
-            ImGui::Checkbox("Inverse colors", &inverseColorsLocal);
-
-            if (doFXAALocal != doFXAA && Shaders.find("postProcess") != Shaders.end()) {
-                doFXAA = doFXAALocal;
-                Shaders["postProcess"]->activate();
-                Shaders["postProcess"]->setUniform("enableFXAA", doFXAA);
-            }
-
-            if (inverseColorsLocal != inverseColors && Shaders.find("postProcess") != Shaders.end()) {
-                inverseColors = inverseColorsLocal;
-                Shaders["postProcess"]->activate();
-                Shaders["postProcess"]->setUniform("inverseColors", inverseColors);
-            }
+            if (toggled) { renderThread.post(selectPostProcessVariant); }
         }
 
         static float ambientStrengthLocal = ambientStrength;
         ImGui::SliderFloat("Ambient Light Strength", &ambientStrengthLocal, 0.0f, 1.0f, "%.2f");
         if (ambientStrengthLocal != ambientStrength) {
-            for (const auto& [shaderID, shader] : Shaders) {
-                ambientStrength = ambientStrengthLocal;
-                shader->setUniform("ambientStrength", ambientStrength);
-            }
+            ambientStrength = ambientStrengthLocal;
+
+            renderThread.post([strength = ambientStrength]() {
+                for (const auto& [shaderID, shader] : Shaders) { shader->setUniform("ambientStrength", strength); }
+            });
         }
 
         // udpates every frame in main loop
@@ -292,7 +314,7 @@ void renderSettingsMenu() {
         ImGui::SameLine();
         ImGui::Checkbox("Extra slow", &extraSlowSimSpeed);
 
-        static unsigned int phyiscsSubstepsLocal = phyiscsSubsteps;
+        unsigned int phyiscsSubstepsLocal = phyiscsSubsteps;
 
         ImGui::SliderInt("Physics SubSteps", (int*)&phyiscsSubstepsLocal, 1, 512);
 
@@ -360,6 +382,11 @@ void renderSimPerfDisplay() {
     if (showFPS) {
         ImGui::SameLine();
         ImGui::Text("| %.0f FPS", currentFPS);
+
+        if (!VSync && framePacer.pacedFrames) {
+            ImGui::SameLine();
+            ImGui::Text("| 99%% paced within %lli us", (long long)framePacer.errorPercentile(0.99).count());
+        }
     }
 
     ImGui::PopFont();
@@ -384,8 +411,10 @@ void renderSceneGraph() {
                 ImGuiWindowFlags_NoMove);
     
 
-    if (ImGui::TreeNode(Scenes::currentSceneID.c_str())) {
+    if (ImGui::TreeNode(Scenes::allScenes.name(Scenes::currentSceneID).c_str())) {
         for (const auto& object :Scenes::currentScene->objects) {
+            if (object->testParticle) { continue; } // catalogs are listed as a whole below
+
             const char* objID = ("##" + object->name).c_str();
 
             if (ImGui::TreeNode(object->name.c_str())) {
@@ -393,7 +422,7 @@ void renderSceneGraph() {
                 ImGui::SameLine(0.0f, 20.0f);
                 ImGui::Checkbox(objID, &object->simulate);
 
-                if (object->objectType == "star") { ImGui::BulletText("Star type: %c", object->light->starType); }
+                if (object->isEmissive()) { ImGui::BulletText("Star type: %c", object->light->starType); }
                 ImGui::BulletText("Mass: %g t", (double)object->mass);
                 ImGui::BulletText("Radius: %.0f km", (double)object->radius);
                 ImGui::BulletText("Velocity: %.2f km/s", (double)glm::length(object->velocity));
@@ -404,6 +433,13 @@ void renderSceneGraph() {
                 ImGui::Checkbox(objID, &object->simulate);
             }
         }
+
+        for (const auto& group : Scenes::currentScene->testParticles) {
+            ImGui::BulletText("%zu catalog bodies around %s", group.particles.size(), group.attractor->name.c_str());
+        }
+        for (const auto& catalog : Scenes::currentScene->pagedCatalogs) {
+            ImGui::BulletText("%zu / %zu tiles of %zu bodies resident (%zu MiB)", catalog->residentTileCount(), catalog->tileCount(), catalog->bodyCount(), catalog->residentMemory() / (1024 * 1024));
+        }
         ImGui::TreePop();
     }
 
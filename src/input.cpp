@@ -13,6 +13,18 @@ std::unordered_map<unsigned int, bool> wasPressed;
 inline bool isJustPressed(const unsigned int& GlfwKey, const unsigned int& WasPressedFlags );
 inline bool isJustPressed(const unsigned int& GlfwKey ); 
 
+// every event asks for a frame - installed before ImGui's callbacks, which chain to these
+void setupInputCallbacks() {
+    glfwSetKeyCallback(mainWindow, [](GLFWwindow*, int, int, int, int) { requestRedraw(); });
+    glfwSetCharCallback(mainWindow, [](GLFWwindow*, unsigned int) { requestRedraw(); });
+    glfwSetMouseButtonCallback(mainWindow, [](GLFWwindow*, int, int, int) { requestRedraw(); });
+    glfwSetCursorPosCallback(mainWindow, [](GLFWwindow*, double, double) { requestRedraw(); });
+    glfwSetScrollCallback(mainWindow, [](GLFWwindow*, double, double) { requestRedraw(); });
+    glfwSetCursorEnterCallback(mainWindow, [](GLFWwindow*, int) { requestRedraw(); });
+    glfwSetWindowFocusCallback(mainWindow, [](GLFWwindow*, int) { requestRedraw(); });
+    glfwSetWindowRefreshCallback(mainWindow, [](GLFWwindow*) { requestRedraw(); }); // uncovered or restored
+}
+
 void handleInputs() {
 
     if (isJustPressed(GLFW_KEY_ESCAPE)) {
@@ -1,6 +1,8 @@
 #include <chrono>
 #include <config.hpp>
+#include <ctime>
 #include <filesystem>
+#include <iomanip>
 #include <globals.hpp>
 #include <state.hpp>
 
@@ -8,6 +10,7 @@
 #include <customMath.hpp>
 #include <physicsThread.hpp>
 #include <renderDefinitions.hpp>
+#include <framePacer.hpp>
 #include <string>
 
 #include <imgui.h>
@@ -20,16 +23,23 @@
 #include "setup/simSetup.cpp"
 #include "setup/renderSetup.cpp"
 
+#include "benchmark.cpp"
+
 void createWindow();
 void setupOpenGL();
 void mainLoop();
 
 void setupShaders();
+void linkShaders();
+bool finishShaderVariants();
+void enableParallelShaderCompile();
 void setupModels();
 
 void setupPostProcess();
+void setupRenderTiers();
 
 void setupSimulation();
+void prefetchSimulationData();
 
 void setupGui();
 void GuiCameraInterruption();
@@ -38,10 +48,43 @@ void countFPS();
 void trackElapsedTime();
 
 void cleanup();
+void reportShaderCache();
+
+void handleFileChanges();
+bool frameNeeded();
+void setupInputCallbacks();
+
+// longest the main loop sleeps waiting for events while idle - background loading and file watching go on in between
+const duration<double> idleEventTimeout(0.1);
+
+// how the run split between drawing and waiting for events - printed at exit with debug output
+struct IdleStats {
+    steady_clock::time_point start = steady_clock::now();
+    steady_clock::duration idled = steady_clock::duration::zero();
+    uint64_t drawnFrames = 0;
+
+    void report(std::ostream& out) const {
+        double wallSeconds = duration<double>(steady_clock::now() - start).count();
+        double cpuSeconds = (double)std::clock() / CLOCKS_PER_SEC; // every thread of the process
+
+        out << "\n" << formatProcess("Idle") << ": " << std::fixed << std::setprecision(1) << 100.0 * duration<double>(idled).count() / wallSeconds
+            << "% of " << wallSeconds << " s waiting for events | " << drawnFrames << " frames drawn (" << drawnFrames / wallSeconds << " / s) | CPU "
+            << std::setprecision(2) << cpuSeconds / wallSeconds << " cores on average" << std::defaultfloat << std::endl;
+    }
+} idleStats;
+bool simulationReloadPending();
 
 int main(int argc, char **argv) {
     mainState = state::starting;
 
+    auto startupStart = steady_clock::now();
+
+    parseBenchmarkArguments(argc, argv);
+    parseSceneMemoryCheckArguments(argc, argv);
+    parseLoadingBenchmarkArguments(argc, argv);
+    parseSceneConversionArguments(argc, argv);
+
+
     // attemps to extract current file location from call args
     if (filesystem::exists(argv[0])) {
         projectDir = ((filesystem::path)argv[0]).parent_path().parent_path();
@@ -52,11 +95,20 @@ int main(int argc, char **argv) {
         projectDir = filesystem::current_path().parent_path();
     }
 
+    // only read and write files, no window needed
+    if (loadingBenchmarkBodies) { return runLoadingBenchmark() ? 0 : 1; }
+    if (!sceneConversionOutput.empty()) { return convertScenes() ? 0 : 1; }
+
     createWindow();
 
     glfwSetFramebufferSizeCallback(mainWindow, resize);
+    setupInputCallbacks();
 
     loadSettings(projectPath(settingsPath));
+
+    // asset decoding and JSON parsing are spread over all cores; GL work stays with the thread owning the context
+    workerPool = new ThreadPool();
+    prefetchSimulationData();
     
     setupOpenGL();
 
@@ -67,13 +119,33 @@ int main(int argc, char **argv) {
     // This must be called after OpenGL context is created and GLAD is loaded.
     setupModels();
 
+    linkShaders();
+
     setupPostProcess();
 
+    setupRenderTiers();
+
     setupSimulation();
 
     transitionState(state::paused); // here so that the physics thread can be started but scene does not have to be loaded yet
 
-    mainLoop();
+    if (debugMode) {
+        std::cout << "\n" << formatProcess("Started") << " in " << duration<double, std::milli>(steady_clock::now() - startupStart).count() << " ms" << std::endl;
+        reportShaderCache();
+    }
+
+    if (benchmarkStarCount) { setupLightBenchmark(); }
+
+    int exitCode = 0;
+    if (sceneMemoryCheckRounds) { exitCode = checkSceneMemory() ? 0 : 1; } // runs instead of the main loop
+    else { mainLoop(); }
+
+    if (debugMode && framePacer.pacedFrames) {
+        std::cout << "\n" << formatProcess("Frame pacing") << " - release error after the deadline\n";
+        framePacer.report(std::cout);
+    }
+
+    if (debugMode && !sceneMemoryCheckRounds) { idleStats.report(std::cout); }
 
     // Call cleanup() to free all allocated model resources before exiting
     mainState = state::stopping;
@@ -82,7 +154,7 @@ int main(int argc, char **argv) {
     glfwDestroyWindow(mainWindow);
     glfwTerminate();
 
-    return 0;
+    return exitCode;
 }
 
 void createWindow() {
@@ -157,11 +229,13 @@ void setupOpenGL() {
 
     // sets OpenGL viewport (plane onto which will be deawn)
     glViewport(0, 0, width, height);
+    framebufferSize = glm::ivec2(width, height);
 
     // sets background color defined in header
     glClearColor(backgroundColor.decR , backgroundColor.decG, backgroundColor.decB, backgroundColor.a);
 
-    setupShaders();
+    enableParallelShaderCompile();
+    setupShaders(); // only submits the compiles - they are checked in linkShaders
 
     glfwSwapInterval(VSync);
 }
@@ -219,27 +293,46 @@ void setupGui() {
     // Setup Platform/Renderer backends
     ImGui_ImplGlfw_InitForOpenGL(mainWindow, true);
     ImGui_ImplOpenGL3_Init("#version 330");
+
+    // creates the backend's shaders and buffers while this thread still has the context - frames are built without it
+    ImGui_ImplOpenGL3_NewFrame();
 }
 
 void mainLoop() {
-    TinyInt frameCount = 0;
+    physicsThread = std::thread(physicsThreadFunction);
 
-    if (!isPowerOfTwo(lightUpdateFrameSkip)) {
-        lightUpdateFrameSkip = roundUpToPowerOfTwo(lightUpdateFrameSkip);
-    }
-    updateLightSources(); // inital calculation (positions) + sending data to shaders
+    // the GL context moves to the render thread - this one keeps events, input and building the frames, one frame ahead of it
+    renderThread.start(mainWindow, drawFrame);
 
-    physicsThread = std::thread(physicsThreadFunction);
+    bool idle = false;
 
     while (!glfwWindowShouldClose(mainWindow)) {
         auto frameStart = steady_clock::now(); // Use std::chrono
 
         supressCameraControls = showScenePicker; // don't use cameara when switching scene
 
-        // handles events such as resizing and creating window
-        glfwPollEvents();
+        // handles events such as resizing and creating window - with nothing to draw the thread sleeps until one comes
+        // (the timeout keeps background loading and file watching going)
+        if (idle) {
+            glfwWaitEventsTimeout(idleEventTimeout.count());
+            idleStats.idled += steady_clock::now() - frameStart;
+        }
+        else { glfwPollEvents(); }
+
+        // background work that needs the GL context (scene switch uploads) - time sliced, so the frame rate holds
+        if (!mainThreadCompletions.empty()) {
+            renderThread.invoke([]() { mainThreadCompletions.run(duration_cast<nanoseconds>(frameDuration * loadingFrameFraction)); });
+            requestRedraw();
+        }
+
+        handleFileChanges();
+
+        updatePagedCatalogs();
+
+        idle = isMinimized || !frameNeeded();
 
-        if (!isMinimized) { // Custom Actions
+        if (!idle) { // Custom Actions
+            idleStats.drawnFrames++;
 
             // ----==[ MISC ]==----
             if (showFPS) { countFPS(); }
@@ -255,18 +348,13 @@ void mainLoop() {
                 
                 currentCamera->updateCameraValues(renderDistance, cameraSensitivity, cameraSpeed, fovDeg);
                 currentCamera->handleInputs(mainWindow);
-                for(auto shader: Shaders) {
-                    currentCamera->updateProjection(shader.second);
-                }
             }
 
-            // y       = 8   = 1000 - y has to be POT
-            // y - 1   = 7   = 0111
-            if ( (frameCount & (lightUpdateFrameSkip - 1)) == 0 ) {
-                updateLightSources();
-            }
+            currentCamera->updateMatrices();
+
+            render(benchmarkRunning);
 
-            render();
+            if (benchmarkRunning) { recordBenchmarkFrame(); }
         }
         static steady_clock::time_point lastTime;
 
@@ -277,26 +365,14 @@ void mainLoop() {
             isFirstFrame = false;
         }
 
-        auto frameEnd = steady_clock::now();
-        auto elapsed = duration_cast<nanoseconds>(frameEnd - frameStart);
-        auto target = frameStart + frameDuration;
-
-        if (elapsed < frameDuration && !VSync) {
-            std::this_thread::sleep_for((frameDuration - elapsed) * staticDelayFraction);
-
-            // spin delay for frames
-            if (staticDelayFraction < 1.0f) {
-                while (steady_clock::now() < target)
-                {
-                    std::this_thread::sleep_for(spinDelay);
-                }
-            }
+        // with VSync the swap on the render thread sets the pace
+        steady_clock::time_point frameEnd;
+        if (!idle && !VSync && frameDuration > nanoseconds(0)) { frameEnd = framePacer.wait(frameDuration); }
+        else {
+            framePacer.reset();
+            frameEnd = steady_clock::now();
         }
 
-        ++frameCount; // does not need to be checked, unsigned types wrap around.
-
-        frameEnd = steady_clock::now();
-
         deltaTime = duration_cast<nanoseconds>(frameEnd - lastTime).count() / 1'000'000'000.0;
             
         lastTime = frameEnd;
@@ -305,6 +381,24 @@ void mainLoop() {
 
 
 
+/**
+ * @brief Whether the main loop should build a frame.
+ *
+ * Moving scenes, a camera under control, loading and benchmarks always draw. Otherwise only a change asks for frames -
+ * input, a resize, a reload or finished background work (requestRedraw) - and they keep coming for idleDelayMS after it,
+ * so GUI hover and fades play out.
+ */
+bool frameNeeded() {
+    static steady_clock::time_point lastChange = steady_clock::now();
+
+    auto now = steady_clock::now();
+
+    bool active = mainState == state::running || mainState == state::loading || sceneLoad.active || currentCamera->focused || benchmarkRunning;
+    if (redrawRequested.exchange(false) || active || !renderOnDemand) { lastChange = now; }
+
+    return now - lastChange < milliseconds(idleDelayMS);
+}
+
 void countFPS() {
     static auto timer = steady_clock::now();
     static unsigned int count = 0;
@@ -339,6 +433,9 @@ void trackElapsedTime() {
 
 
 void cleanup() {
+    // the context comes back to this thread for the rest
+    renderThread.stop();
+
     // must be called before shutting down the main window
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplGlfw_Shutdown();
@@ -348,8 +445,15 @@ void cleanup() {
     Fonts.clear();
 
     physicsRunning = false; 
+    physicsCV.notify_all();
     if (physicsThread.joinable()) { physicsThread.join(); }
 
+    delete workerPool;
+    workerPool = nullptr;
+
+    delete fileWatcher;
+    fileWatcher = nullptr;
+
     delete currentCamera;
     currentCamera = nullptr;
 
@@ -358,13 +462,19 @@ void cleanup() {
         lightBlockUBO = nullptr;
     }
 
-    for (auto& [key, lightObject] : lightQue) {
-        delete lightObject;
-        lightObject = nullptr;
+    delete lightSSBO;
+    delete lightClusterSSBO;
+    delete lightIndexSSBO;
+
+    lightSSBO = lightClusterSSBO = lightIndexSSBO = nullptr;
+
+    for (auto& sceneLight : lightQue) {
+        delete sceneLight.light;
+        sceneLight.light = nullptr;
     }
     lightQue.clear();
 
-    for (auto& [key, scene] : Scenes::allScenes) {
+    for (auto& [sceneID, scene] : Scenes::allScenes) {
         delete scene;
     }
     Scenes::allScenes.clear();
@@ -372,16 +482,54 @@ void cleanup() {
 
     for (const auto& FBO : FBOs) { delete FBO.second; }
     FBOs.clear();
+    postProcessFBO = nullptr;
+
+    delete impostorBatch;
+    impostorBatch = nullptr;
 
-    for (const auto& LightObject : lightQue) { delete LightObject.second; }
+    delete pointBatch;
+    pointBatch = nullptr;
+
+    for (const auto& sceneLight : lightQue) { delete sceneLight.light; }
     lightQue.clear();
 
-    for (const auto& simObject : SimObjects) { delete simObject.second; }
+    for (const auto& [simObjectID, simObject] : SimObjects) { delete simObject; }
     SimObjects.clear();
 
-    for (const auto& model : Models) { delete model.second; }
+    for (simulationObject* simObject : replacedSimObjects) { delete simObject; }
+    replacedSimObjects.clear();
+
+    for (const auto& [modelID, model] : Models) { delete model; }
     Models.clear();
 
-    for(const auto& shader : Shaders) { delete shader.second; } // destroys class on heap and clears OpenGl binaries
+    delete resources;
+    resources = nullptr;
+
+    for (const auto& [shaderID, shader] : Shaders) { delete shader; } // destroys class on heap and clears OpenGl binaries
     Shaders.clear(); // remoces map entries if classes were not cleared before -> dangling pointers
+    litShaders.clear();
+
+    delete Shader::binaryCache;
+    Shader::binaryCache = nullptr;
+}
+
+// files saved while running (hot reload)
+void handleFileChanges() {
+    if (!fileWatcher) { return; }
+
+    for (const auto& file : fileWatcher->changes()) {
+        std::error_code error;
+        if (filesystem::equivalent(file, projectPath(settingsPath), error)) {
+            renderThread.invoke([file]() { reloadSettings(file); });
+            requestRedraw();
+        }
+        else if (filesystem::equivalent(file, projectPath(simObjectsConfigPath), error)) { requestSimulationReload(true, false); }
+        else if (filesystem::equivalent(file, projectPath(physicsScenesPath), error)) { requestSimulationReload(false, true); }
+    }
+
+    // rebuilt scenes upload their models - waits for a running scene switch to finish
+    if (simulationReloadPending()) {
+        renderThread.invoke(reloadSimulationFiles);
+        requestRedraw();
+    }
 }
@@ -22,71 +22,220 @@
 #include "gui.cpp"
 #include "state.hpp"
 
-void renderGui(); // function in gui.cpp
+void renderGui(GuiDrawData& drawData); // function in gui.cpp
+bool finishShaderVariants(); // function in setup/renderSetup.cpp
+void collectSceneFrame(FramePacket& frame);
+void collectLightSources(FramePacket& frame);
+void updateLightSources(FramePacket& frame);
+void updateLightClusters(const FramePacket& frame);
+ShaderDefines postProcessDefines(const bool& fxaa, const bool& inverse);
+
+// picks the instance's level of detail from its size on screen; hysteresis keeps it from popping back and forth on a boundary
+void selectDetailLevel(simulationObject* simObject, const float& projectedRadius) {
+    Model* model = simObject->model;
+    if (!model->isDerived || !model->master || model->master->detailLevels.empty()) { return; }
+
+    float finestLevel = (float)(model->master->levelsOfDetail() - 1);
+
+    // icosahedron edge is ~1.05 of its radius and halves with every subdivision
+    float idealLevel = projectedRadius > 0.0f ? std::log2(projectedRadius * 1.05f / lodTargetEdgePixels) : 0.0f;
+    float currentLevel = (float)model->detailLevel;
+
+    // current level covers (level - 1, level]
+    if (idealLevel > currentLevel + lodHysteresis || idealLevel < currentLevel - 1.0f - lodHysteresis) {
+        model->detailLevel = (unsigned int)std::clamp(std::ceil(idealLevel), 0.0f, finestLevel);
+    }
+}
 
-void render() {
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+// bodies only a few pixels across are not worth a mesh draw
+renderTier selectRenderTier(const float& projectedRadius) {
+    if (!useRenderTiers) { return renderTier::mesh; }
 
-    if (Scenes::currentScene) {
-        static FBO* postProcessFBO;
-        static Shader* postProcessShader;
+    if (projectedRadius < pointPixelRadius && pointBatch) { return renderTier::point; }
+    if (projectedRadius < impostorPixelRadius && impostorBatch) { return renderTier::impostor; }
 
-        if (doPostProcess) {
-            postProcessFBO = FBOs["postProcess"];
-            postProcessShader = Shaders["postProcess"];
-        }
+    return renderTier::mesh;
+}
 
-        // Only attempt to render if the model instance has been successfully created
+// main thread - copies everything the frame needs into the packet, the render thread never reads the scene
+void render(const bool& waitForGPU) {
+    FramePacket frame = renderThread.recycle();
+    frame.clear();
 
+    frame.viewMatrix = currentCamera->viewMatrix;
+    frame.projectionMatrix = currentCamera->projectionMatrix;
+    frame.cameraPosition = currentCamera->position;
+    frame.nearClipPlane = currentCamera->nearClipPlane;
+    frame.farClipPlane = currentCamera->farClipPlane;
+    frame.viewportSize = glm::vec2(currentCamera->width, currentCamera->height);
+
+    frame.clearColor = glm::vec4(backgroundColor.decR, backgroundColor.decG, backgroundColor.decB, backgroundColor.a);
+    frame.postProcess = doPostProcess && postProcessFBO;
+    frame.waitForGPU = waitForGPU;
+
+    if (Scenes::currentScene) {
         if (Scenes::currentScene->objects.empty()) {
             if (debugMode) { std::cout << formatError("ERROR") << ": current scene list emtpty... skipping frame." << std::endl; }
-            return;
         }
+        else {
+            collectSceneFrame(frame);
+        }
+    }
 
-        if (doPostProcess) {
-            postProcessFBO->bind();
-            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    renderGui(frame.gui);
+
+    renderThread.submit(std::move(frame));
+}
+
+void collectSceneFrame(FramePacket& frame) {
+    const auto& objects = Scenes::currentScene->objects;
+
+    frame.drawScene = true;
+    collectLightSources(frame);
+
+    // one lock for the whole frame instead of one per body
+    static std::vector<glm::dvec3> positions;
+    static std::vector<bool> drawn;
+    float fraction;
+    {
+        std::lock_guard<std::mutex> lock(physicsMutex);
+        fraction = physicsStateFraction(steady_clock::now());
+
+        positions.resize(objects.size());
+        drawn.resize(objects.size());
+
+        for (size_t i = 0; i < objects.size(); ++i) {
+            positions[i] = objects[i]->renderPosition(fraction); // copy safe position
+            drawn[i] = objects[i]->simulate || renderUnsimulated;
         }
+    }
+
+    for (size_t i = 0; i < objects.size(); ++i) {
+        if (!drawn[i]) { continue; } // escape early on non-simulated ojbects
+
+        simulationObject* simObject = objects[i];
+        Model* model = simObject->model;
+        const glm::dvec3& renderPos = positions[i];
+
+        if (simulateObjectRotation && mainState != state::paused) {
+            simObject->modelMatrix = glm::rotate(simObject->modelMatrix, (float)(glm::radians(simObject->vertexRotation) * simulationSpeed * deltaTime), glm::vec3(0.0f,0.0f,1.0f)); // temporarily rotate around Z axii
+        }
+
+        float projectedRadius = projectedRadiusInPixels(simObject->vertexModelRadius, glm::distance(currentCamera->position, (glm::vec3)renderPos), currentCamera->FOVdeg, currentCamera->height);
 
-        for (const auto& simObject : Scenes::currentScene->objects) {
-            Shader* shader = simObject->shader;
-            Model* model = simObject->model;
+        switch (selectRenderTier(projectedRadius)) {
+            case renderTier::point:
+                frame.points.push_back(BodyBatch::instance(renderPos, simObject->vertexModelRadius, simObject->getDisplayColor(), simObject->isEmissive()));
+                continue;
 
+            case renderTier::impostor:
+                frame.impostors.push_back(BodyBatch::instance(renderPos, simObject->vertexModelRadius, simObject->getDisplayColor(), simObject->isEmissive()));
+                continue;
 
-            glm::dvec3 renderPos;
+            case renderTier::mesh:
+                break;
+        }
+
+        selectDetailLevel(simObject, projectedRadius);
+
+        glm::mat4 modelMatrix = calcuculateModelMatrixFromPosition(renderPos);
+        if (simulateObjectRotation) { modelMatrix *= simObject->modelMatrix; } // rotation
+        if (model->isDerived) { modelMatrix *= model->transform; } // scaling
+
+        Model* mesh = model->isDerived ? model->master->getDetailLevel(model->detailLevel) : model;
+        frame.meshes.push_back({ mesh, simObject->shader, modelMatrix, simObject->getDisplayColor() });
+    }
+
+    // tiles of paged catalogs that aren't resident are drawn as their sample bodies - realistic mode has one scale to place them with
+    if (pointBatch && simulationMode == simulationType::realistic) {
+        for (const auto& catalog : Scenes::currentScene->pagedCatalogs) {
+            glm::dvec3 attractorPosition;
             {
                 std::lock_guard<std::mutex> lock(physicsMutex);
-                if (!simObject->simulate && !renderUnsimulated) { continue; } // escape early on non-simulated ojbects
-                renderPos = simObject->vertPosition; // copy safe position
+                attractorPosition = catalog->attractor->renderPosition(fraction);
             }
 
+            const glm::vec3 color = catalog->master->model->color;
+            catalog->forEachAggregate([&](const glm::dvec3& offset) { frame.points.push_back(BodyBatch::instance(attractorPosition + offset / currentScale, 0.0f, color, false)); });
+        }
+    }
+}
+
+// render thread - draws a packet and presents it
+void drawFrame(FramePacket& frame) {
+    // unused variants finish compiling in the background, none of them hold up the first frames
+    static bool shaderVariantsCompiling = true;
+    if (shaderVariantsCompiling) { shaderVariantsCompiling = finishShaderVariants(); }
+
+    static glm::vec4 clearColor(-1.0f);
+    if (frame.clearColor != clearColor) {
+        clearColor = frame.clearColor;
+        glClearColor(clearColor.r, clearColor.g, clearColor.b, clearColor.a);
+    }
+
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    glEnable(GL_PROGRAM_POINT_SIZE);
+
+    if (frame.drawScene) {
+        for (const auto& [shaderID, shader] : Shaders) {
             shader->activate();
 
-            if (simulateObjectRotation && mainState != state::paused) {
-                simObject->modelMatrix = glm::rotate(simObject->modelMatrix, (float)(glm::radians(simObject->vertexRotation) * simulationSpeed * deltaTime), glm::vec3(0.0f,0.0f,1.0f)); // temporarily rotate around Z axii
-                shader->applyModelMatrix( calcuculateModelMatrixFromPosition(renderPos) * simObject->modelMatrix /*rotation*/ * (simObject->model->isDerived ? simObject->model->transform : 1.0f) /*scaling*/ );
-            }
-            else {
-                shader->applyModelMatrix(calcuculateModelMatrixFromPosition(renderPos) * (simObject->model->isDerived ? simObject->model->transform : 1.0f));
-            }
+            shader->viewMatrix = frame.viewMatrix;
+            shader->projectionMatrix = frame.projectionMatrix;
 
-            simObject->draw( true /*skip sending derived model matrix*/);
+            shader->applyViewMatrix();
+            shader->applyProjectionMatrix();
         }
 
-        if (doPostProcess) {
+        if (frame.postProcess) {
+            postProcessFBO->bind();
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        }
+
+        updateLightSources(frame);
+        updateLightClusters(frame);
+
+        for (const auto& draw : frame.meshes) {
+            draw.shader->activate();
+            draw.shader->applyModelMatrix(draw.modelMatrix);
+            draw.shader->setUniform("color", draw.color);
+
+            draw.mesh->draw(draw.shader, true /*matrix is applied*/, true /*so is the color*/);
+        }
+
+        // every small body in one draw call per tier
+        if (impostorBatch && !frame.impostors.empty()) {
+            impostorBatch->instances.swap(frame.impostors);
+
+            Shader* impostorShader = Shaders[impostorShaderID];
+            impostorShader->setUniform("cameraPosition", frame.cameraPosition);
+            impostorBatch->draw(impostorShader);
+        }
+        if (pointBatch && !frame.points.empty()) {
+            pointBatch->instances.swap(frame.points);
+
+            Shader* pointShader = Shaders[pointShaderID];
+            pointShader->setUniform("cameraPosition", frame.cameraPosition);
+            pointBatch->draw(pointShader);
+        }
+
+        if (frame.postProcess) {
             postProcessFBO->unbind();
 
-            postProcessFBO->draw(postProcessShader);
+            postProcessFBO->draw(Shaders[postProcessShaderID]);
         }
     }
 
-    renderGui();
+    if (frame.gui.data.Valid) { ImGui_ImplOpenGL3_RenderDrawData(&frame.gui.data); }
 
     glfwSwapBuffers(mainWindow);
+
+    if (frame.waitForGPU) { glFinish(); }
 }
 
 void setupPostProcess() {
-    if (!doPostProcess || Shaders.find("postProcess") == Shaders.end()) {
+    if (!doPostProcess || !Shaders.contains(postProcessShaderID)) {
         doPostProcess = false;
         return;
     }
@@ -94,52 +243,151 @@ void setupPostProcess() {
     int width, height;
     glfwGetFramebufferSize(mainWindow, &width, &height);
 
-    FBOs["postProcess"] = new FBO(width, height);
-    Shaders["postProcess"]->setUniform("resolution", glm::vec2(width, height));
+    postProcessFBO = new FBO(width, height);
+    FBOs["postProcess"] = postProcessFBO;
+
+    // every combination of the toggles is compiled up front, toggling only swaps programs
+    for (bool fxaa : {false, true}) {
+        for (bool inverse : {false, true}) {
+            Shaders[postProcessShaderID]->precompileVariant(postProcessDefines(fxaa, inverse));
+        }
+    }
+
+    selectPostProcessVariant();
+    Shaders[postProcessShaderID]->setUniform("resolution", glm::vec2(width, height));
+}
+
+ShaderDefines postProcessDefines(const bool& fxaa, const bool& inverse) {
+    return {{"ENABLE_FXAA", fxaa ? "1" : "0"}, {"INVERSE_COLORS", inverse ? "1" : "0"}};
+}
+
+void selectPostProcessVariant() {
+    if (!doPostProcess || !Shaders.contains(postProcessShaderID)) { return; }
 
-    Shaders["postProcess"]->setUniform("enableFXAA", doFXAA);
-    Shaders["postProcess"]->setUniform("inverseColors", inverseColors);
+    // can run on the render thread, which mustn't ask GLFW for the size
+    Shader* shader = Shaders[postProcessShaderID];
+    if (shader->selectVariant(postProcessDefines(doFXAA, inverseColors))) {
+        shader->setUniform("resolution", glm::vec2(framebufferSize));
+    }
+}
+
+// few lights - programs with the count baked in skip the cluster lookups and can unroll their light loops
+void selectLightingVariants(const size_t& lightCount) {
+    clusteredLighting = lightCount > MAX_UNROLLED_LIGHTS;
+
+    ShaderDefines defines;
+    if (!clusteredLighting) { defines["LIGHT_COUNT"] = std::to_string(lightCount); }
+
+    for (Shader* shader : litShaders) {
+        if (shader->selectVariant(defines)) { shader->setUniform("ambientStrength", ambientStrength); }
+    }
+}
 
+void setupRenderTiers() {
+    // tiers are only used when their shaders are present
+    if (Shaders.contains(impostorShaderID)) { impostorBatch = new BodyBatch(BodyBatch::Type::impostors); }
+    if (Shaders.contains(pointShaderID)) { pointBatch = new BodyBatch(BodyBatch::Type::points); }
+
+    glEnable(GL_PROGRAM_POINT_SIZE);
 }
 
+// lights are bound to scene bodies by index - they follow the bodies between the states the physics thread published
 void updateLightSourcePositions() {
-    for (const auto& light : lightQue) {
-        if (SimObjects.find(light.first) != SimObjects.end()) {
-            light.second->position = SimObjects[light.first]->vertPosition;
+    if (!Scenes::currentScene) { return; }
+
+    const auto& objects = Scenes::currentScene->objects;
+
+    std::lock_guard<std::mutex> lock(physicsMutex);
+    float fraction = physicsStateFraction(steady_clock::now());
+
+    for (const auto& sceneLight : lightQue) {
+        if (sceneLight.objectIndex < objects.size()) {
+            sceneLight.light->position = objects[sceneLight.objectIndex]->renderPosition(fraction);
         }
     }
 }
 
-// prototype function; later will be culling based on distance
-void updateLightSources() {
+// main thread - rebuilds the light list into the frame; which lights reach which clusters is sorted out in updateLightClusters()
+void collectLightSources(FramePacket& frame) {
     updateLightSourcePositions();
 
-    int amountOfLights = std::min(MAX_LIGHTS, (int)lightQue.size());
+    for (const auto& sceneLight : lightQue) {
+        const LightObject* light = sceneLight.light;
 
-    LightBlockData lightsData;
-    lightsData.lightCount = amountOfLights;
-    lightsData.lightFallOff = lightFalloff;
+        ShaderLight shaderLight = {};
+        shaderLight.position = light->position;
+        shaderLight.color = glm::vec4((cartoonColorMode ? starTypeCartoonEmissions[light->starType] : light->color), 1);
+        shaderLight.intensity = light->intensity;
 
-    unsigned char lightsAdded = 0;
-    for (const auto& light : lightQue) {
-        if (lightsAdded >= MAX_LIGHTS) { break; }
+        frame.lights.push_back(shaderLight);
+        frame.clusterLights.push_back({ light->position, lightRange(light->intensity, lightFalloff, lightCutoff) });
+    }
+
+    frame.lightFalloff = lightFalloff;
+}
 
-        lightsData.lights[lightsAdded].position = light.second->position;
-        lightsData.lights[lightsAdded].color = glm::vec4((cartoonColorMode ? starTypeCartoonEmissions[light.second->starType] : light.second->color), 1);
-        lightsData.lights[lightsAdded].intensity = light.second->intensity;
+// render thread - takes the frame's lights over and uploads them when they changed
+void updateLightSources(FramePacket& frame) {
+    static std::vector<ShaderLight> uploadedLights;
 
-        lightsAdded++;
+    shaderLights.swap(frame.lights);
+    clusterLights.swap(frame.clusterLights);
+
+    lightBlockData.lightCount = shaderLights.size();
+    lightBlockData.lightFallOff = frame.lightFalloff;
+
+    // paused scenes don't move - nothing to send
+    bool lightsChanged = shaderLights.size() != uploadedLights.size() ||
+                         std::memcmp(shaderLights.data(), uploadedLights.data(), shaderLights.size() * sizeof(ShaderLight)) != 0;
+
+    if (lightsChanged && !shaderLights.empty()) {
+        lightSSBO->upload(shaderLights.size() * sizeof(ShaderLight), shaderLights.data());
+        lightSSBO->bind(LIGHT_SSBO_BINDING_POINT);
+
+        uploadedLights = shaderLights;
+    }
+}
+
+// camera moves every frame - lights have to be re-assigned to the view space clusters
+void updateLightClusters(const FramePacket& frame) {
+    static std::vector<glm::uvec2> uploadedClusters;
+    static std::vector<GLuint> uploadedIndices;
+
+    // unrolled variants go through every light - clusters aren't read
+    if (!clusteredLighting) {
+        lightBlockUBO->write(&lightBlockData);
+        return;
+    }
+
+    lightClusters.assign(clusterLights, frame.viewMatrix, frame.projectionMatrix, frame.nearClipPlane, frame.farClipPlane);
+
+    lightBlockData.clusterNear = frame.nearClipPlane;
+    lightBlockData.clusterFar = frame.farClipPlane;
+    lightBlockData.clusterGrid = glm::uvec4(lightClusters.dimensions, 0);
+    lightBlockData.viewportSize = frame.viewportSize;
+
+    if (lightClusters.clusters != uploadedClusters) {
+        lightClusterSSBO->upload(lightClusters.clusters.size() * sizeof(glm::uvec2), lightClusters.clusters.data());
+        lightClusterSSBO->bind(LIGHT_CLUSTER_SSBO_BINDING_POINT);
+
+        uploadedClusters = lightClusters.clusters;
     }
 
-    // Update the UBO with the new light data
-    lightBlockUBO->update(0, sizeof(LightBlockData), &lightsData);
+    if (lightClusters.lightIndices != uploadedIndices && !lightClusters.lightIndices.empty()) {
+        lightIndexSSBO->upload(lightClusters.lightIndices.size() * sizeof(GLuint), lightClusters.lightIndices.data());
+        lightIndexSSBO->bind(LIGHT_INDEX_SSBO_BINDING_POINT);
 
-    // Bind the UBO to the specified binding point
-    lightBlockUBO->bind(LIGHT_UBO_BINDING_POINT);
+        uploadedIndices = lightClusters.lightIndices;
+    }
+
+    // no-op unless something in the block changed
+    lightBlockUBO->write(&lightBlockData);
 }
 
 
 void resize(GLFWwindow *window, int width, int height) {
+    requestRedraw();
+
     if (fullscreen) { return; } // here just in case so that values won't change after entering fullscreen.
     if ((width | height) == 0) {
         isMinimized = true;
@@ -150,25 +398,24 @@ void resize(GLFWwindow *window, int width, int height) {
     windowWidth = width;
     windowHeight = height;
 
-    // Set the viewport first
-    glViewport(0, 0, width, height);
-    
-    // Ensure the mainShader is active before updating projection
-    for (const auto& shaderPair : Shaders) {
-        auto shader = shaderPair.second;
-        if (shader) {
-            shader->activate();
-            currentCamera->updateProjection(width, height, shader);
-        }
-    }
+    // the shaders get the new projection with the next frame
+    currentCamera->width = width;
+    currentCamera->height = height;
+    currentCamera->updateMatrices();
 
-    for (const auto& FBO : FBOs) {
-        FBO.second->resize(width, height);
-    }
+    // the frame being drawn still uses the old buffers
+    renderThread.invoke([width, height]() {
+        framebufferSize = glm::ivec2(width, height);
+        glViewport(0, 0, width, height);
 
-    if (doPostProcess) {
-        Shaders["postProcess"]->setUniform("resolution", glm::vec2(width, height));
-    }
+        for (const auto& FBO : FBOs) {
+            FBO.second->resize(width, height);
+        }
+
+        if (doPostProcess) {
+            Shaders[postProcessShaderID]->setUniform("resolution", glm::vec2(width, height));
+        }
+    });
 }
 
 // FULLSCREEN
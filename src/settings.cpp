@@ -5,14 +5,20 @@
 #include <paths.hpp>
 
 #include <simpleToml.hpp>
+#include <fileWatcher.hpp>
+#include <scenes.hpp>
 
+#include <fstream>
+#include <mutex>
+#include <sstream>
 #include <string>
 #include <variant>
 #include <unordered_map>
+#include <unordered_set>
 
 
 template <typename T>
-using TomlSetter = void(*)(T*, const char*, const char*, Toml&);
+using TomlSetter = void(*)(T*, const TomlValue&);
 
 template <typename T>
 struct SettingsEntry {
@@ -24,16 +30,12 @@ struct SettingsEntry {
 };
 
 template <typename T>
-void setValue(T* variable, const char* TomlCategory, const char* TomlEntry, Toml& data) {
-    *variable = data[TomlCategory][TomlEntry].get<T>();
+void setValue(T* variable, const TomlValue& value) {
+    *variable = value.get<T>();
 }
 
-void setColor(Color* variable, const char* TomlCategory, const char* TomlEntry, Toml& data) {
-    *variable = Color((std::string)data[TomlCategory][TomlEntry]);
-}
-
-void setNanoseconds(std::chrono::nanoseconds* variable, const char* TomlCategory, const char* TomlEntry, Toml& data) {
-    *variable = std::chrono::nanoseconds(data[TomlCategory][TomlEntry].get<int>());
+void setColor(Color* variable, const TomlValue& value) {
+    *variable = Color(value.get<std::string>());
 }
 
 using SettingsVariant = std::variant<
@@ -42,7 +44,6 @@ using SettingsVariant = std::variant<
     SettingsEntry<float>,
     SettingsEntry<double>,
     SettingsEntry<Color>,
-    SettingsEntry<std::chrono::nanoseconds>,
     SettingsEntry<unsigned char>,
     SettingsEntry<unsigned int>,
     SettingsEntry<simulationType>,
@@ -52,6 +53,7 @@ using SettingsVariant = std::variant<
 std::unordered_map<std::string, std::pair<std::string, SettingsVariant>> settings = {
     {"debugMode",                         {"DEBUG", SettingsEntry(&debugMode, setValue<bool>)}},
     {"prettyOutput",                      {"DEBUG", SettingsEntry(&prettyOutput, setValue<bool>)}},
+    {"hotReload",                         {"DEBUG", SettingsEntry(&hotReload, setValue<bool>)}},
 
     {"defaultWindowWidth",                {"WINDOW", SettingsEntry(&defaultWindowWidth, setValue<int>)}},
     {"defaultWindowHeight",               {"WINDOW", SettingsEntry(&defaultWindowHeight, setValue<int>)}},
@@ -61,15 +63,26 @@ std::unordered_map<std::string, std::pair<std::string, SettingsVariant>> setting
 
     {"maxFrameRate",                      {"RENDER", SettingsEntry(&maxFrameRate, setValue<int>)}},
     {"VSync",                             {"RENDER", SettingsEntry(&VSync, setValue<int>)}},
-    {"StaticFrameDelayFraction",          {"RENDER", SettingsEntry(&staticDelayFraction, setValue<float>)}},
-    {"spinDelayNS",                       {"RENDER", SettingsEntry(&spinDelay, setNanoseconds)}},
+    {"loadingFrameFraction",              {"RENDER", SettingsEntry(&loadingFrameFraction, setValue<float>)}},
+    {"renderOnDemand",                    {"RENDER", SettingsEntry(&renderOnDemand, setValue<bool>)}},
+    {"idleDelayMS",                       {"RENDER", SettingsEntry(&idleDelayMS, setValue<unsigned int>)}},
     {"doPostProcess",                     {"RENDER", SettingsEntry(&doPostProcess, setValue<bool>)}},
     {"doFXAA",                            {"RENDER", SettingsEntry(&doFXAA, setValue<bool>)}},
-    {"lightUpdateFrameSkip",              {"RENDER", SettingsEntry(&lightUpdateFrameSkip, setValue<unsigned char>)}},
     {"inverseColors",                     {"RENDER", SettingsEntry(&inverseColors, setValue<bool>)}},
+    {"useShaderCache",                    {"RENDER", SettingsEntry(&useShaderCache, setValue<bool>)}},
+    {"useModelCache",                     {"RENDER", SettingsEntry(&useModelCache, setValue<bool>)}},
+    {"resourceBudgetMB",                  {"RENDER", SettingsEntry(&resourceBudgetMB, setValue<unsigned int>)}},
+    {"sceneCacheMB",                      {"RENDER", SettingsEntry(&sceneCacheMB, setValue<unsigned int>)}},
     {"fullscreen",                        {"RENDER", SettingsEntry(&fullscreen, setValue<bool>)}},
-    {"starScaleMultiplier",               {"RENEDR", SettingsEntry(&starScaleMultiplier, setValue<unsigned int>)}},
+    {"starScaleMultiplier",               {"RENDER", SettingsEntry(&starScaleMultiplier, setValue<unsigned int>)}},
     {"assumeModleIsScaled",               {"RENDER", SettingsEntry(&assumeModleIsScaled, setValue<bool>)}},
+    {"icosphereSubdivisions",             {"RENDER", SettingsEntry(&icosphereSubdivisions, setValue<unsigned int>)}},
+    {"lodTargetEdgePixels",               {"RENDER", SettingsEntry(&lodTargetEdgePixels, setValue<float>)}},
+    {"lodHysteresis",                     {"RENDER", SettingsEntry(&lodHysteresis, setValue<float>)}},
+    {"useRenderTiers",                    {"RENDER", SettingsEntry(&useRenderTiers, setValue<bool>)}},
+    {"impostorPixelRadius",               {"RENDER", SettingsEntry(&impostorPixelRadius, setValue<float>)}},
+    {"pointPixelRadius",                  {"RENDER", SettingsEntry(&pointPixelRadius, setValue<float>)}},
+    {"lightCutoff",                       {"RENDER", SettingsEntry(&lightCutoff, setValue<float>)}},
 
     {"renderDistance",                    {"CAMERA", SettingsEntry(&renderDistance, setValue<float>)}},
     {"cameraSpeed",                       {"CAMERA", SettingsEntry(&cameraSpeed, setValue<float>)}},
@@ -85,8 +98,11 @@ std::unordered_map<std::string, std::pair<std::string, SettingsVariant>> setting
     {"physicsSubsteps",                   {"PHYSICS", SettingsEntry(&phyiscsSubsteps, setValue<unsigned int>)}},
     {"simulateObjectRotation",            {"PHYSICS", SettingsEntry(&simulateObjectRotation, setValue<bool>)}},
     {"physicsSteps",                      {"PHYSICS", SettingsEntry(&physicsSteps, setValue<float>)}},
+    {"interpolatePhysics",                {"PHYSICS", SettingsEntry(&interpolatePhysics, setValue<bool>)}},
     {"gravityInInitialVel",               {"PHYSICS", SettingsEntry(&gravityInInitialVel, setValue<bool>)}},
     {"trackSimTime",                      {"PHYSICS", SettingsEntry(&trackSimTime, setValue<bool>)}},
+    {"catalogMemoryBudgetMB",             {"PHYSICS", SettingsEntry(&catalogMemoryBudgetMB, setValue<unsigned int>)}},
+    {"catalogTileBodies",                 {"PHYSICS", SettingsEntry(&catalogTileBodies, setValue<unsigned int>)}},
 
     {"fontSize",                          {"GUI", SettingsEntry(&fontSize, setValue<float>)}},
     {"windowRounding",                    {"GUI", SettingsEntry(&windowRounding, setValue<float>)}},
@@ -94,6 +110,74 @@ std::unordered_map<std::string, std::pair<std::string, SettingsVariant>> setting
     {"fontFile",                          {"GUI", SettingsEntry(&fontFile, setValue<std::string>)}}
 };
 
+// text of every setting as it was last applied from the file - a reload only applies what changed, so values set in the GUI stay otherwise
+std::unordered_map<std::string, std::string> appliedSettings;
+
+// only read at startup - changing them needs a restart
+const std::unordered_set<std::string> startupSettings = {
+    "defaultWindowWidth", "defaultWindowHeight", "minWindowWidth", "minWindowHeight", "doPostProcess", "useShaderCache", "useModelCache",
+    "fullscreen", "icosphereSubdivisions", "fontSize", "fontFile", "hotReload",
+    // scale the scene while it's prepared
+    "simulationMode", "simpleMaxScale", "unifiedDistance", "normalizedModelRadius", "renderScaleDistortion"
+};
+
+/**
+ * @brief Parses the settings file and applies it.
+ *
+ * @param changed Filled with the names of the settings whose value differs from the last applied one (every setting on the first load).
+ * @param pendingRestart Given on a reload - changed startup settings are listed here and left as they are, the running program was built from them.
+ * @return Whether the file could be read and parsed - invalid values are reported and skipped.
+ */
+bool applySettingsFile(const std::filesystem::path& path, std::vector<std::string>* changed = nullptr, std::vector<std::string>* pendingRestart = nullptr) {
+    Toml data;
+
+    try {
+        ifstream file(path);
+        if (!file) { throw std::runtime_error("unable to open '" + formatPath(path.string()) + "'"); }
+        file >> data;
+    }
+    catch (const std::exception& e) {
+        cerr << formatError("FAILED") << "\n" << formatError("ERROR") << ": " << formatPath(getFileName(path.string())) << ":" << e.what() << "\n" << endl;
+        return false;
+    }
+
+    std::stringstream errorBuffer;
+
+    for (auto& [name, entry] : settings) {
+        const TomlValue* value = data.find(name);
+        if (!value) { continue; }
+
+        auto applied = appliedSettings.find(name);
+        if (applied != appliedSettings.end() && applied->second == value->text) { continue; }
+
+        // appliedSettings keeps the value in use, so it stays pending until the file matches it again
+        if (pendingRestart && startupSettings.count(name)) {
+            pendingRestart->push_back(name);
+            continue;
+        }
+
+        // the physics thread reads these while it steps
+        std::unique_lock<std::mutex> physicsLock(physicsMutex, std::defer_lock);
+        if (entry.first == "PHYSICS") { physicsLock.lock(); }
+
+        try {
+            // std::visit -> takes a visitor (lambda) and a variant and applies the visitor to the currently active type in variant
+            std::visit([&value](auto&& arg) { arg.setter(arg.variable, *value); }, entry.second);
+        }
+        catch (const TomlError& e) {
+            errorBuffer << formatError("ERROR") << ": " << formatPath(getFileName(path.string())) << ":" << e.what() << " ... " << formatProcess("skipping") << "\n";
+            continue;
+        }
+
+        appliedSettings[name] = value->text;
+        if (changed) { changed->push_back(name); }
+    }
+
+    if (!errorBuffer.str().empty()) { cerr << "\n" << errorBuffer.str(); }
+
+    return true;
+}
+
 void loadSettings(std::filesystem::path path) {
     if (debugMode) {
         cout << formatProcess("Loading") << " settings '" << formatPath(getFileName(path.string())) << "' ... ";
@@ -105,25 +189,39 @@ void loadSettings(std::filesystem::path path) {
         return;
     }
 
-    ifstream file(path);
-    Toml data;
-    file >> data;
-    file.close();
+    if (!applySettingsFile(path)) { return; }
 
-    // avantgarde asshole
-    for (auto& entryValue : settings) { // auto& [x, y] -> unpacks std::pair as references
-        
-        auto name = entryValue.first;
-        auto entry = entryValue.second.second;
-        auto category = entryValue.second.first;
+    if (debugMode) { cout << formatSuccess("Done") << endl; }
 
-        if (data.valueExists(name)) {
-            // std::visit -> takes a visitor (lambda) and a variant and applies the visitor to the currently active type in variant
-            std::visit([& /*captures all variables in scope by reference*/](auto&& arg /*arguments - entry - settings[i].second.setter(...)*/) { // auto&& universal reference -> both r and l values
-                arg.setter(arg.variable, category.c_str(), name.c_str(), data);
-            }, entry);
+    if (hotReload && !fileWatcher) {
+        fileWatcher = new FileWatcher();
+        if (!fileWatcher->watch(path) && debugMode) {
+            cout << formatWarning("WARNING") << ": can't watch '" << formatPath(getFileName(path.string())) << "' - changes apply on restart" << endl;
         }
     }
+}
 
-    if (debugMode) { cout << formatSuccess("Done") << endl; }
-}
\ No newline at end of file
+// applies a saved settings file while running - settings that are only read at startup are left for the next launch
+// called through renderThread.invoke, VSync and the post process variant need the GL context
+void reloadSettings(std::filesystem::path path) {
+    std::vector<std::string> changed, pendingRestart;
+    if (!applySettingsFile(path, &changed, &pendingRestart) || (changed.empty() && pendingRestart.empty())) { return; }
+
+    auto wasChanged = [&changed](const char* name) { return std::find(changed.begin(), changed.end(), name) != changed.end(); };
+
+    if (wasChanged("VSync")) { renderThread.post([vsync = VSync]() { glfwSwapInterval(vsync); }); }
+    if (wasChanged("maxFrameRate") && maxFrameRate > 0) { frameDuration = nanoseconds(1'000'000'000 / maxFrameRate); }
+    if (wasChanged("doFXAA") || wasChanged("inverseColors")) { selectPostProcessVariant(); }
+    if (wasChanged("sceneCacheMB")) { sceneCache.memoryCap = (size_t)sceneCacheMB * 1024 * 1024; }
+    if (wasChanged("resourceBudgetMB") && resources) {
+        resources->memoryBudget = (size_t)resourceBudgetMB * 1024 * 1024;
+        resources->trim();
+    }
+
+    if (debugMode) {
+        cout << formatProcess("Reloaded") << " settings '" << formatPath(getFileName(path.string())) << "' - ";
+        for (size_t i = 0; i < changed.size(); ++i) { cout << (i ? ", " : "") << changed[i]; }
+        for (size_t i = 0; i < pendingRestart.size(); ++i) { cout << (i || !changed.empty() ? ", " : "") << pendingRestart[i] << " (on restart)"; }
+        cout << endl;
+    }
+}
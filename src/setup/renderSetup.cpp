@@ -5,25 +5,64 @@
 #include <debug.hpp>
 #include <FormatConsole.hpp>
 
-#include <UBO.hpp>
+#include <uniformRingBuffer.hpp>
+#include <SSBO.hpp>
 #include <shader.hpp>
+#include <programCache.hpp>
 #include <camera.hpp>
 #include <renderDefinitions.hpp>
+#include <icosphere.hpp>
+#include <meshCache.hpp>
+#include <meshOptimizer.hpp>
+#include <resourceManager.hpp>
 
 void setupShaderMetrices(Shader* shader);
+void reportShaderCache();
 
 // Function to initialize the model data and OpenGL buffers for the main model
 void setupModels() {
-
     std::set<std::string> availableFormats = getSupportedAssimpExtensions();
 
+    // already imported meshes are read straight from the cache, Assimp only sees new or changed files
+    MeshCache* meshCache = useModelCache ? new MeshCache(projectPath(modelCachePath), MODEL_IMPORT_FLAGS) : nullptr;
+    resources = new ResourceManager((size_t)resourceBudgetMB * 1024 * 1024, meshCache);
+    sceneCache.memoryCap = (size_t)sceneCacheMB * 1024 * 1024;
+
+    auto icosphereLevelsResult = workerPool->submit([]() {
+        std::vector<ModelData> levels = generateIcosphereLevels(icosphereSubdivisions, normalizedModelRadius);
+        for (ModelData& level : levels) { optimizeMesh(level); }
+        return levels;
+    });
+
+    // files are only indexed here - a mesh is read when the first scene using it gets activated
     for (const auto& file : std::filesystem::recursive_directory_iterator(projectPath(modelPath))) {
-        
+        if (availableFormats.find(file.path().extension().string()) == availableFormats.end()) { continue; }
 
-        if (availableFormats.find(file.path().extension().string()) != availableFormats.end()) {
-            auto filepath = file.path();
-            Models[filepath.stem().string()] = new Model(loadSTLData(filepath), glm::vec3(1.0f, 1.0f, 1.0f)); // White by default
-        }
+        Model* model = new Model(ModelData(), glm::vec3(1.0f, 1.0f, 1.0f)); // White by default
+        ModelID modelID = Models.add(file.path().stem().string(), model);
+        resources->registerModel(modelID, model, file.path());
+    }
+
+    if (debugMode) { std::cout << '\n' << formatProcess("Indexed") << " " << resources->registeredModels() << " models in '" << formatPath(modelPath.string()) << "'" << std::endl; }
+
+    // procedural sphere - the finest level is the model itself, the rest are its coarser levels of detail
+    std::vector<ModelData> icosphereLevels = icosphereLevelsResult.get();
+
+    Model* icosphere = new Model(icosphereLevels.back(), glm::vec3(1.0f, 1.0f, 1.0f));
+    for (size_t level = 0; level + 1 < icosphereLevels.size(); ++level) {
+        icosphere->detailLevels.push_back(new Model(icosphereLevels[level], glm::vec3(1.0f, 1.0f, 1.0f)));
+    }
+    resources->registerModel(Models.add("icosphere", icosphere), icosphere);
+
+    // generated models are never freed, so they are buffered right away
+    icosphere->sendBufferedVertices();
+
+    if (debugMode) {
+        const ModelData& finest = icosphereLevels.back();
+
+        std::cout << '\n' << formatProcess("Generated") << " icosphere with " << icosphere->levelsOfDetail() << formatRole(" levels of detail") << " ("
+                  << icosphereLevels.front().indices.size() / 3 << " - " << finest.indices.size() / 3 << " triangles, ACMR "
+                  << averageCacheMissRatio(finest.indices, finest.vertices.size() / 3) << ")" << std::endl;
     }
 
     // Create an instance of your Model class
@@ -31,13 +70,18 @@ void setupModels() {
 
     // Initialize the LightBlock UBO
     // The size should be calculated based on the struct LightBlockData
-    lightBlockUBO = new UBO(sizeof(LightBlockData));
+    lightBlockUBO = new UniformRingBuffer(sizeof(LightBlockData), LIGHT_UBO_BINDING_POINT);
 
-    // shaders that do not have a setup for light block will be ignored
-    for (const auto& shader : Shaders) {
-        shader.second->activate();
-        shader.second->setUniformBlockBinding("LightBlock", LIGHT_UBO_BINDING_POINT);
-    }
+    // light storage grows with the amount of lights; cluster ranges have a fixed size
+    lightSSBO = new SSBO(sizeof(ShaderLight));
+    lightClusterSSBO = new SSBO(lightClusters.clusterCount() * sizeof(glm::uvec2));
+    lightIndexSSBO = new SSBO(sizeof(GLuint));
+
+    lightSSBO->bind(LIGHT_SSBO_BINDING_POINT);
+    lightClusterSSBO->bind(LIGHT_CLUSTER_SSBO_BINDING_POINT);
+    lightIndexSSBO->bind(LIGHT_INDEX_SSBO_BINDING_POINT);
+
+    // LightBlock binding is set in shaders/lighting.glsl, so every variant picks it up
 }
 
 void setupShaders() {
@@ -59,20 +103,85 @@ void setupShaders() {
         }
     }
 
+    auto compileStart = steady_clock::now();
+
+    if (useShaderCache) {
+        Shader::binaryCache = new ProgramBinaryCache(projectPath(shaderCachePath));
+        if (!Shader::binaryCache->isSupported() && debugMode) {
+            std::cout << formatError("WARNING") << ": driver can't provide program binaries - shaders will be compiled on every launch" << std::endl;
+        }
+    }
+
     // attempting to make shaders from source files
     TinyInt failed = 0;
 
     for (const auto& shaderSource : shaderSourceFiles) {
         if (!shaderSource.second.vertex.empty() && !shaderSource.second.fragment.empty()) {
-            Shaders[shaderSource.first] = new Shader(shaderSource.second.vertex, shaderSource.second.fragment);
-            setupShaderMetrices(Shaders[shaderSource.first]);
+            Shaders.add(shaderSource.first, new Shader(shaderSource.second.vertex, shaderSource.second.fragment));
         }
         else { failed++; }
     }
 
+    postProcessShaderID = Shaders.find("postProcess");
+    impostorShaderID = Shaders.find("impostor");
+    pointShaderID = Shaders.find("point");
+
     if (debugMode) {
-        std::cout << "\n" << formatProcess("Loaded ") << Shaders.size() << " Shader" << ((Shaders.size() > 1u) ? "s" : "") << ((failed > 0u) ? "; failed " + failed : "") << std::endl;
+        std::cout << "\n" << formatProcess("Submitted ") << Shaders.size() << " Shader" << ((Shaders.size() > 1u) ? "s" : "") << ((failed > 0u) ? "; failed " + std::to_string(failed) : "")
+                  << " in " << duration<double, std::milli>(steady_clock::now() - compileStart).count() << " ms" << std::endl;
+    }
+}
+
+// first use of the shaders submitted by setupShaders - called as late as possible so their compiles overlap with the rest of the setup
+void linkShaders() {
+    for (const auto& [shaderID, shader] : Shaders) {
+        setupShaderMetrices(shader);
+
+        // lit shaders - one variant per small light count, the default (clustered) one covers the rest
+        if (glGetUniformBlockIndex(shader->ID, "LightBlock") != GL_INVALID_INDEX) {
+            for (unsigned int lightCount = 0; lightCount <= MAX_UNROLLED_LIGHTS; ++lightCount) {
+                shader->precompileVariant({{"LIGHT_COUNT", std::to_string(lightCount)}});
+            }
+            litShaders.push_back(shader);
+        }
+    }
+}
+
+// variants compiling in the background get checked once the driver is done with them; returns whether any are left
+bool finishShaderVariants() {
+    bool compiling = false;
+    for (const auto& [shaderID, shader] : Shaders) {
+        if (shader->finishReadyVariants()) { compiling = true; }
+    }
+    return compiling;
+}
+
+// compiles on driver threads where supported
+void enableParallelShaderCompile() {
+    typedef void (APIENTRY *MaxShaderCompilerThreadsFunction)(GLuint count);
+
+    MaxShaderCompilerThreadsFunction maxShaderCompilerThreads = nullptr;
+
+    if (glfwExtensionSupported("GL_KHR_parallel_shader_compile")) {
+        maxShaderCompilerThreads = (MaxShaderCompilerThreadsFunction)glfwGetProcAddress("glMaxShaderCompilerThreadsKHR");
     }
+    else if (glfwExtensionSupported("GL_ARB_parallel_shader_compile")) {
+        maxShaderCompilerThreads = (MaxShaderCompilerThreadsFunction)glfwGetProcAddress("glMaxShaderCompilerThreadsARB");
+    }
+
+    if (!maxShaderCompilerThreads) { return; }
+
+    maxShaderCompilerThreads(0xFFFFFFFF); // as many threads as the driver wants
+    Shader::parallelCompile = true;
+
+    if (debugMode) { std::cout << formatRole("Info") << " parallel shader compilation enabled" << std::endl; }
+}
+
+// cold start - every program compiled, warm start - every program loaded from the cache
+void reportShaderCache() {
+    if (!Shader::binaryCache) { return; }
+
+    std::cout << formatRole("Shader cache") << " " << Shader::binaryCache->hits << " loaded, " << Shader::binaryCache->misses << " compiled" << std::endl;
 }
 
 void setupShaderMetrices(Shader* shader) {
@@ -1,16 +1,16 @@
 #include "glm/ext/matrix_transform.hpp"
 #include "glm/geometric.hpp"
 #include "globals.hpp"
-#include "json.hpp"
 #include "lightObject.hpp"
 #include <algorithm>
 #include <exception>
 #include <filesystem>
 #include <format>
+#include <future>
 #include <iostream>
-#include <optional>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <units.hpp>
 #include <config.hpp>
 #include <types.hpp>
@@ -23,84 +23,82 @@
 #include <debug.hpp>
 #include <FormatConsole.hpp>
 #include <paths.hpp>
-
+#include <simulationData.hpp>
+#include <binaryScene.hpp>
+#include <orbitCatalog.hpp>
+#include <catalogPaging.hpp>
+#include <threadPool.hpp>
+#include <fileWatcher.hpp>
+
+#include <cstring>
+#include <memory>
 #include <unordered_map>
 
 #include <stdexcept>
 #include <functional>
 
 
-using Json = nlohmann::json;
 using errorCode = std::string;
 
 void loadSimObjects(std::filesystem::path path);
 void loadPhysicsScene(std::filesystem::path path);
+void loadBinaryPhysicsScene(std::filesystem::path path);
+bool binaryScenesUpToDate();
 
-void setupSimulation() {
-    loadSimObjects(projectPath(simObjectsConfigPath));
+// read on the worker pool while models import - the objects themselves need the models and shaders to exist first
+std::future<ObjectFile> simObjectsData;
+std::future<SceneFile> physicsScenesData;
 
-    loadPhysicsScene(projectPath(physicsScenesPath));
-}
+// records the simulation was built from - only kept while the files are watched, reloads are diffed against them
+ObjectFile loadedObjects;
+SceneFile loadedScenes;
+bool scenesRecorded = false; // the binary scene file leaves no records, the first reload rebuilds every scene then
 
+void prefetchSimulationData() {
+    simObjectsData = workerPool->submit([path = projectPath(simObjectsConfigPath)]() { return readObjectFile(path); });
+    if (binaryScenesUpToDate()) { return; } // mapped when the scenes load, nothing to parse
 
+    physicsScenesData = workerPool->submit([path = projectPath(physicsScenesPath)]() { return readSceneFile(path, workerPool); });
+}
 
-// attempts to assign a value from json data to given variable / member; if default value is provided it will disregard missing values from json - with custom assignment logic
-template <typename dest, typename src>
-inline void assignValue(const std::string& objectName, dest& objectValue, const Json& jsonData, const std::string& jsonKey, std::function<void(dest& destination, const src& source)> action, const std::optional<src> defaultValue = std::nullopt, std::stringstream* const debugBuffer = nullptr) {    
-    src value;
-    
-    if (!jsonData.contains(jsonKey)) {
-        if (!defaultValue.has_value()) {
-            throw std::invalid_argument( std::format("Could not find property '{}' in loaded configuration for object '{}'", jsonKey, objectName) );
-        }
-        else {
-            if (debugBuffer && debugMode) {
-                *debugBuffer << formatWarning("WARNING") << ": could not find '" << colorText(jsonKey, ANSII_MAGENTA) << "' in the config of '" << colorText(objectName, ANSII_MAGENTA) << "' object ... " << formatProcess("Loading defaults") << "\n";
-            }
-            value = defaultValue.value();
-        }
-    }
-    else {
-        value = jsonData[jsonKey].get<src>();
-    }
-    
-    action(objectValue, value);
+// prefetched data if there is any, reads the file otherwise
+template <typename Data, typename Reader>
+Data takePrefetched(std::future<Data>& prefetched, Reader read) {
+    if (prefetched.valid()) { return prefetched.get(); }
+    return read();
 }
-// attempts to assign a value from json data to given variable / member; if default value is provided it will disregard missing values from json
-template <typename src, typename dest>
-inline void assignValue(const std::string& objectName, dest& objectValue, const Json& jsonData, const std::string& jsonKey, const std::optional<src> defaultValue = std::nullopt, std::stringstream* const debugBuffer = nullptr) {    
-    src value;
-    
-    if (!jsonData.contains(jsonKey)) {
-        if (!defaultValue.has_value()) {
-            throw std::invalid_argument( std::format("Could not find property '{}' in loaded configuration for object '{}'", jsonKey, objectName) );
-        }
-        else {
-            if (debugBuffer && debugMode) {
-                *debugBuffer << formatWarning("WARNING") << ": could not find '" << colorText(jsonKey, ANSII_MAGENTA) << "' in the config of '" << colorText(objectName, ANSII_MAGENTA) << "' object ... " << formatProcess("Loading defaults") << "\n";
-            }
-            value = defaultValue.value();
-        }
-    }
-    else {
-        value = jsonData[jsonKey].get<src>();
-    }
 
-    objectValue = value;
+void setupSimulation() {
+    loadSimObjects(projectPath(simObjectsConfigPath));
+
+    if (binaryScenesUpToDate()) { loadBinaryPhysicsScene(projectPath(physicsScenesBinaryPath)); }
+    else { loadPhysicsScene(projectPath(physicsScenesPath)); }
+
+    if (fileWatcher) {
+        fileWatcher->watch(projectPath(simObjectsConfigPath));
+        fileWatcher->watch(projectPath(physicsScenesPath));
+    }
 }
 
+// the converted scenes are only used while they are newer than both files they were made from
+bool binaryScenesUpToDate() {
+    std::error_code error;
+    auto binaryTime = std::filesystem::last_write_time(projectPath(physicsScenesBinaryPath), error);
+    if (error) { return false; }
 
-Json loadJsonData(std::filesystem::path filePath) {
-    if ( !std::filesystem::exists(filePath) || !std::filesystem::is_regular_file(filePath) ) {
-        throw std::invalid_argument( std::format("Could not open and load Json data from '{}'", formatPath(filePath.string())) );
+    for (const std::filesystem::path& source : { physicsScenesPath, simObjectsConfigPath }) {
+        auto sourceTime = std::filesystem::last_write_time(projectPath(source), error);
+        if (!error && sourceTime > binaryTime) { return false; }
     }
 
-    std::ifstream file(filePath);
-    Json data;
-    file >> data;
-    file.close();
+    return true;
+}
+
 
-    return data;
+// notes a property the file doesn't have, before its default is used
+void warnDefault(std::stringstream& debugBuffer, const std::string& objectName, const std::string& key) {
+    if (!debugMode) { return; }
+    debugBuffer << formatWarning("WARNING") << ": could not find '" << colorText(key, ANSII_MAGENTA) << "' in the config of '" << colorText(objectName, ANSII_MAGENTA) << "' object ... " << formatProcess("Loading defaults") << "\n";
 }
 
 
@@ -128,6 +126,8 @@ simulationObject* getGravityWhell(const std::vector<SimObjectID> objectIDs) {
 
     for (const SimObjectID&  ID : objectIDs) {
         simulationObject* currentObject = SimObjects[ID];
+        if (!currentObject) { continue; }
+
         if (!largestMass.second) {
             largestMass = {currentObject->mass, currentObject};
             continue;
@@ -180,113 +180,227 @@ void assignColor(glm::vec3& dest, const std::string& src) {
 
 
 
-// -----------------===[ Import Handlers ]===-----------------
+// sorts the bodies by distance from origin, farthest first, and makes the scene selectable
+void registerScene(const std::string& sceneID, scene* currentScene) {
+    std::sort(currentScene->objects.begin(), currentScene->objects.end(), 
+        [](simulationObject* a, simulationObject* b){
+            return glm::length(a->position) > glm::length(b->position);
+        }
+    );
 
+    currentScene->pagedObjectsBegin = currentScene->objects.size();
 
+    Scenes::allScenes.add(sceneID, currentScene);
+}
 
-void loadSimObjects(std::filesystem::path path) {
-    Json data;
 
-    try {
-        if (debugMode) { std::cout << formatProcess("\nLoading") << " objects from '" << formatPath(path.filename().string()) << "' ... "; }
-        data = loadJsonData(path);
+
+// bodies of a catalog that wouldn't fit catalogMemoryBudgetMB come in by tiles while the scene is shown (updatePagedCatalogs)
+void addPagedCatalog(scene* currentScene, std::shared_ptr<const CatalogTileFile> tiles, simulationObject* master, simulationObject* attractor) {
+    currentScene->testParticles.push_back({ attractor, {} });
+    currentScene->pagedCatalogs.push_back(std::make_shared<PagedCatalog>(std::move(tiles), master, attractor, currentScene->testParticles.size() - 1));
+}
+
+// adds the bodies of an orbit catalog (res/<file>) as test particles around the attractor - the scene's instance of its gravity well
+void importCatalog(scene* currentScene, simulationObject* attractor, const std::string& file, const std::string& objectName, const std::string& sceneID, std::stringstream& debugBuffer) {
+    simulationObject* master = SimObjects[SimObjects.find(objectName)];
+    if (!master) {
+        debugBuffer << formatError("ERROR") << ": unknown catalog object '" << colorText(objectName, ANSII_MAGENTA) << "' in scene '" << sceneID << "' ... " << formatProcess("skipping") << std::endl;
+        return;
     }
-    catch (std::exception e) {
-        if (debugMode) { std::cerr << formatError("FAILED") << "\n" << formatError("ERROR") << ": " << e.what(); }
+    if (!attractor) {
+        debugBuffer << formatError("ERROR") << ": scene '" << colorText(sceneID, ANSII_MAGENTA) << "' has no body for catalog '" << file << "' to orbit ... " << formatProcess("skipping") << std::endl;
         return;
     }
 
+    auto start = steady_clock::now();
 
-    std::stringstream debugBuffer;
+    const std::filesystem::path catalogPath = projectPath(resourcePath / file);
+    const std::filesystem::path tilesPath = projectPath(catalogTileCachePath / catalogTilesName(file));
+    const size_t memoryBudget = (size_t)catalogMemoryBudgetMB * 1024 * 1024;
 
-    static ModelID fallbackModel = (Models.empty() ? "" : Models.begin()->first);
-    static std::optional<std::string> fallbackColor = "#ff00ff";
-    static std::optional<double> earthFallbackRotationSpeed = 0.003992; //360 * ((earthRotationKmH / (EarthRadius*PI*2)) / 3600) -> approximate Earth's rotation degrees / second
-    static std::optional<std::string> fallbackObjectType = "planet";
+    auto reportPaged = [&](const std::shared_ptr<const CatalogTileFile>& tiles, const char* action) {
+        if (!debugMode) { return; }
+        debugBuffer << formatProcess("Paging") << " " << tiles->bodyCount() << " bodies from '" << formatPath(file) << "' into '" << sceneID << "' (" << action << ", "
+                    << tiles->nodeCount() << " octree nodes) in " << duration<double, std::milli>(steady_clock::now() - start).count() << " ms\n";
+    };
 
+    // tiles made before - the catalog doesn't have to be read at all
+    std::shared_ptr<const CatalogTileFile> tiles = openCatalogTiles(tilesPath, catalogPath, catalogTileBodies);
+    if (tiles && tiles->bodyCount() * catalogBodyMemory > memoryBudget) {
+        addPagedCatalog(currentScene, tiles, master, attractor);
+        reportPaged(tiles, "cached tiles");
+        return;
+    }
 
+    OrbitCatalog catalog;
+    try { catalog = readOrbitCatalog(catalogPath, workerPool); }
+    catch (const std::exception& e) {
+        debugBuffer << formatError("ERROR") << ": " << e.what() << " - catalog of scene '" << sceneID << "' ... " << formatProcess("skipping") << std::endl;
+        return;
+    }
 
-    for (const auto& [objectID, object] : data.items()) {
+    if (catalog.size() * catalogBodyMemory > memoryBudget) {
+        try { tiles = buildCatalogTiles(catalog, tilesPath, catalogTileBodies, workerPool); }
+        catch (const std::exception& e) {
+            debugBuffer << formatError("ERROR") << ": " << e.what() << " - tiles of catalog '" << file << "' ... " << formatProcess("skipping") << std::endl;
+            return;
+        }
 
-        ShaderID shader;
-        ModelID model;
+        addPagedCatalog(currentScene, tiles, master, attractor);
+        reportPaged(tiles, "tiles built");
+        return;
+    }
 
-        // Shader
-        if (object.contains("shader")) {
-            if (Shaders.contains(object["shader"])) {
-                  shader = object["shader"];
-            }
-            else {
-                debugBuffer << formatError("ERROR") << ": cannot load invalid shader '" << colorText(object["shader"], ANSII_MAGENTA) << "' for object '" << objectID << "' ... " << formatProcess("skipping") << std::endl;
-                continue;
-            }
-        }
-        else {
-            debugBuffer << formatError("ERROR") << ": shader '" << colorText(object["shader"], ANSII_MAGENTA) << "' does't exist - in object '" << objectID << "' ... " << formatProcess("skipping") << std::endl;
-            continue;
+    double gravitationalParameter = GRAVITATIONAL_CONSTANT * attractor->mass.get<units::kilograms>() / 1e9; // km³/s²
+
+    std::vector<glm::dvec3> positions(catalog.size()), velocities(catalog.size());
+    catalogStateVectors(catalog.elements(), gravitationalParameter, positions.data(), velocities.data(), workerPool);
+
+    testParticleGroup group = { attractor, {} };
+    group.particles.reserve(catalog.size());
+    currentScene->objects.reserve(currentScene->objects.size() + catalog.size());
+
+    for (size_t i = 0; i < catalog.size(); ++i) {
+        simulationObject* simObject = currentScene->instantiate(*master);
+
+        if (!catalog.names[i].empty()) { simObject->name = std::move(catalog.names[i]); }
+        simObject->position = attractor->position + positions[i];
+        simObject->velocity = attractor->velocity + velocities[i];
+        simObject->testParticle = true;
+        simObject->setCurrentAsOriginal();
+
+        group.particles.push_back(simObject);
+    }
+
+    currentScene->testParticles.push_back(std::move(group));
+
+    if (debugMode) {
+        debugBuffer << formatProcess("Imported") << " " << catalog.size() << " bodies from '" << formatPath(file) << "' into '" << sceneID << "'"
+                    << (catalog.skipped ? std::format(" ({} lines skipped)", catalog.skipped) : "") << " in " << duration<double, std::milli>(steady_clock::now() - start).count() << " ms\n";
+    }
+}
+
+
+
+// -----------------===[ Import Handlers ]===-----------------
+
+
+
+// master object of an objects.json entry - null if it can't be made, the reason goes to the debug buffer
+simulationObject* createSimObject(const ObjectEntry& object, std::stringstream& debugBuffer) {
+    static ModelID fallbackModel = (Models.empty() ? ModelID() : Models.begin()->handle);
+    static const std::string fallbackColor = "#ff00ff";
+    static const double earthFallbackRotationSpeed = 0.003992; //360 * ((earthRotationKmH / (EarthRadius*PI*2)) / 3600) -> approximate Earth's rotation degrees / second
+    static const std::string fallbackObjectType = "planet";
+
+    const std::string& objectID = object.name;
+
+    ShaderID shader;
+    ModelID model;
+
+    // Shader
+    if (object.hasShader) {
+        shader = Shaders.find(object.shader);
+        if (!shader.valid()) {
+            debugBuffer << formatError("ERROR") << ": cannot load invalid shader '" << colorText(object.shader, ANSII_MAGENTA) << "' for object '" << objectID << "' ... " << formatProcess("skipping") << std::endl;
+            return nullptr;
         }
+    }
+    else {
+        debugBuffer << formatError("ERROR") << ": shader does't exist - in object '" << objectID << "' ... " << formatProcess("skipping") << std::endl;
+        return nullptr;
+    }
 
-        // Model
-        if (object.contains("model")) {
-            if (Models.contains(object["model"])) {
-                model = object["model"];
+    // Model
+    if (object.hasModel) {
+        model = Models.find(object.model);
+        if (!model.valid()) {
+            debugBuffer << formatError("ERROR") << ": cannot load invalid model '" << colorText(object.model, ANSII_MAGENTA) << "' ... ";
+            if (fallbackModel.valid()) {
+                model = fallbackModel; debugBuffer << formatSuccess("Done") << std::endl;
             }
             else {
-                debugBuffer << formatError("ERROR") << ": cannot load invalid model '" << colorText(object["model"], ANSII_MAGENTA) << "' ... ";
-                if (fallbackModel != "") {
-                    model = fallbackModel; debugBuffer << formatSuccess("Done") << std::endl;
-                }
-                else {
-                    debugBuffer << formatError("FAILED") << " ... " << formatProcess("skipping") << std::endl;
-                    continue;
-                }
+                debugBuffer << formatError("FAILED") << " ... " << formatProcess("skipping") << std::endl;
+                return nullptr;
             }
         }
+    }
+    else {
+        debugBuffer << formatError("ERROR") << ": model does't exist - in object '" << objectID << "' ... " << formatProcess("Loading defaults") << " ... ";
+        if (fallbackModel.valid()) {
+            model = fallbackModel; debugBuffer << formatSuccess("Done") << std::endl;
+        }
         else {
-            debugBuffer << formatError("ERROR") << ": shader '" << colorText(object["model"], ANSII_MAGENTA) << "' does't exist - in object '" << objectID << "' ... " << formatProcess("Loading defaults") << " ... ";
-            if (fallbackModel != "") {
-                model = fallbackModel; std:: cout << formatSuccess("Done") << std::endl;
-            }
-            else {
-                std::cout << formatError("FAILED") << " ... " << formatProcess("skipping") << std::endl;
-                continue;
-            }
+            debugBuffer << formatError("FAILED") << " ... " << formatProcess("skipping") << std::endl;
+            return nullptr;
         }
-        
+    }
 
-        simulationObject* simObject = new simulationObject(shader, model, true /*derive model*/ );
+    if (!object.hasRadius || !object.hasMass) {
+        debugBuffer << formatError("ERROR") << ": could not find '" << colorText(object.hasRadius ? "mass" : "radius", ANSII_MAGENTA) << "' in object '" << objectID << "' ... " << formatProcess("skipping") << std::endl;
+        return nullptr;
+    }
 
 
-        // process the rest
+    simulationObject* simObject = new simulationObject(shader, model, true /*derive model*/ );
 
-        simObject->name = objectID;
-        assignValue<double>(objectID, simObject->radius, object, "radius");
-        assignValue<double>(objectID, simObject->mass, object, "mass");
-        assignValue<double>(objectID, simObject->radius, object, "radius");
-        assignValue<glm::vec3, std::string>(objectID, simObject->model->color, object, "color", assignColor, fallbackColor, &debugBuffer);
-        assignValue<std::string>(objectID, simObject->objectType, object, "type", fallbackObjectType, &debugBuffer);
-        assignValue<double>(objectID, simObject->rotationSpeed, object, "rotation", earthFallbackRotationSpeed, &debugBuffer);
-        
-        // Light
-        if (simObject->objectType == "star") {
-            if (!object.contains("light")) {
-                simObject->light = new LightObject;
-            }
-            else {
-                assignValue<LightObject*, Json>(objectID, simObject->light, object, "light",
-                    [&](LightObject*& obj, const Json& value) {
-                        obj = new LightObject();
-                        assignValue<float>(objectID, obj->intensity, value, "intensity");
-                        assignValue<glm::vec3, std::string>(objectID, obj->color, value, "color", assignColor, fallbackColor, &debugBuffer);
-                        assignValue<char, Json>(objectID, obj->starType, value, "starType", [&](char& obj, const Json& value) {obj = value.get<std::string>()[0]; });
-                    }
-                );
-            }
+
+    // process the rest
+
+    simObject->name = objectID;
+    simObject->radius = object.radius;
+    simObject->mass = object.mass;
+
+    if (!object.hasColor) { warnDefault(debugBuffer, objectID, "color"); }
+    assignColor(simObject->model->color, object.hasColor ? object.color : fallbackColor);
+
+    if (!object.hasType) { warnDefault(debugBuffer, objectID, "type"); }
+    simObject->objectType = object.hasType ? object.type : fallbackObjectType;
+    simObject->objectTypeID = internedStrings.intern(simObject->objectType);
+
+    if (!object.hasRotation) { warnDefault(debugBuffer, objectID, "rotation"); }
+    simObject->rotationSpeed = object.hasRotation ? object.rotation : earthFallbackRotationSpeed;
+    
+    // Light
+    if (simObject->isEmissive()) {
+        simObject->light = new LightObject;
+
+        if (object.hasLight) {
+            const LightEntry& light = object.light;
+
+            if (light.hasIntensity) { simObject->light->intensity = light.intensity; }
+            if (light.hasStarType) { simObject->light->starType = light.starType; }
+
+            if (!light.hasColor) { warnDefault(debugBuffer, objectID, "light color"); }
+            assignColor(simObject->light->color, light.hasColor ? light.color : fallbackColor);
         }
+    }
+
+    return simObject;
+}
 
-        SimObjects[objectID] = simObject;
+void loadSimObjects(std::filesystem::path path) {
+    ObjectFile data;
+
+    try {
+        if (debugMode) { std::cout << formatProcess("\nLoading") << " objects from '" << formatPath(path.filename().string()) << "' ... "; }
+        data = takePrefetched(simObjectsData, [&path]() { return readObjectFile(path); });
+    }
+    catch (const std::exception& e) {
+        if (debugMode) { std::cerr << formatError("FAILED") << "\n" << formatError("ERROR") << ": " << e.what(); }
+        return;
+    }
+
+
+    std::stringstream debugBuffer;
+
+    for (const ObjectEntry& object : data.objects) {
+        if (simulationObject* simObject = createSimObject(object, debugBuffer)) { SimObjects.add(object.name, simObject); }
     }
 
+    if (fileWatcher) { loadedObjects = std::move(data); }
+
     handleDebugBuffer(debugBuffer);
 }
 
@@ -294,124 +408,522 @@ void loadSimObjects(std::filesystem::path path) {
 
 
 
+// scene of a scenes.json entry, instancing the current SimObjects - null if it can't be made, the reason goes to the debug buffer
+scene* buildScene(const SceneEntry& sceneData, const glm::dvec3& orbitVector, std::stringstream& debugBuffer) {
+    const std::string& sceneID = sceneData.name;
+
+    if (!sceneData.error.empty()) {
+        debugBuffer << formatError("ERROR") << ": could not parse scene '" << colorText(sceneID, ANSII_MAGENTA) << "' - " << sceneData.error << " ... skipping\n";
+        return nullptr;
+    }
+
+    // --- OBJECTS --
+    if (!sceneData.hasObjects) {
+        if (debugMode) { debugBuffer << formatError("ERROR") << ": could not find objects in scene '" << colorText(sceneID, ANSII_MAGENTA) << "' ... skipping\n"; }
+        return nullptr;
+    }
+
+    // every name the scene uses is looked up once, objects refer to them by index
+    std::vector<SimObjectID> masters(sceneData.names.size());
+    for (size_t i = 0; i < sceneData.names.size(); ++i) { masters[i] = SimObjects.find(sceneData.names[i]); }
+
+    simulationObject* gravityWhell = getGravityWhell(masters);
+
+    scene* currentScene = new scene();
+    currentScene->objects.reserve(sceneData.objects.size());
+
+    std::vector<simulationObject*> byName(sceneData.names.size(), nullptr); // groups list their members by name
+
+    for (const SceneObjectEntry& objectData : sceneData.objects) {
+        if (!objectData.hasObject) {
+            debugBuffer << formatError("ERROR") << ": object without 'object' in scene '" << colorText(sceneID, ANSII_MAGENTA) << "' ... " << formatProcess("skipping") << std::endl;
+            continue;
+        }
+
+        const std::string& objectID = sceneData.names[objectData.object];
+
+        simulationObject* master = SimObjects[masters[objectData.object]];
+        if (!master) {
+            debugBuffer << formatError("ERROR") << ": unknown object '" << colorText(objectID, ANSII_MAGENTA) << "' in scene '" << sceneID << "' ... " << formatProcess("skipping") << std::endl;
+            continue;
+        }
+        if (!objectData.hasPosition) {
+            debugBuffer << formatError("ERROR") << ": could not find 'position' of '" << colorText(objectID, ANSII_MAGENTA) << "' in scene '" << sceneID << "' ... " << formatProcess("skipping") << std::endl;
+            continue;
+        }
+
+        simulationObject* simObject = currentScene->instantiate(*master); // creates a derived model
+
+        simObject->position = objectData.position;
+
+        if (objectData.hasVelocity) { simObject->velocity = objectData.velocity; }
+        else {
+            warnDefault(debugBuffer, objectID, "velocity");
+            simObject->velocity = gravityWhell ? calcIdealOrbitVelocity(simObject, gravityWhell, orbitVector) : glm::dvec3(0.0);
+        }
+
+        simObject->setCurrentAsOriginal();
+
+        byName[objectData.object] = simObject;
+    }
+
+
+    // --- GROUPS ---
+    if (!sceneData.hasGroups) {
+        if (debugMode) { debugBuffer << formatError("ERROR") << ": could not find sim groups in scene '" << colorText(sceneID, ANSII_MAGENTA) << "' ... skipping\n"; }
+        delete currentScene;
+        return nullptr;
+    }
+
+    currentScene->groups.reserve(sceneData.groupCount());
+    for (size_t group = 0; group < sceneData.groupCount(); ++group) {
+        sceneGroup currentGroup;
+        currentGroup.reserve(sceneData.groupOffsets[group + 1] - sceneData.groupOffsets[group]);
+
+        for (uint32_t member = sceneData.groupOffsets[group]; member < sceneData.groupOffsets[group + 1]; ++member) {
+            if (simulationObject* object = byName[sceneData.groupMembers[member]]) { currentGroup.push_back(object); }
+        }
+
+        currentScene->groups.push_back(std::move(currentGroup));
+    }
+
+    // --- CATALOGS ---
+    if (!sceneData.catalogs.empty()) {
+        simulationObject* attractor = nullptr; // the scene's instance of the gravity well
+        for (size_t i = 0; i < masters.size() && !attractor; ++i) {
+            if (gravityWhell && SimObjects[masters[i]] == gravityWhell) { attractor = byName[i]; }
+        }
+
+        for (const CatalogEntry& catalog : sceneData.catalogs) {
+            if (!catalog.hasFile || !catalog.hasObject) {
+                debugBuffer << formatError("ERROR") << ": catalog without '" << colorText(catalog.hasFile ? "object" : "file", ANSII_MAGENTA) << "' in scene '" << sceneID << "' ... " << formatProcess("skipping") << std::endl;
+                continue;
+            }
+            importCatalog(currentScene, attractor, catalog.file, catalog.object, sceneID, debugBuffer);
+        }
+    }
+
+    return currentScene;
+}
+
 void loadPhysicsScene(std::filesystem::path path) {
-    Json data;
+    SceneFile data;
 
     try {
         if (debugMode) { std::cout << formatProcess("\nLoading") << " objects from '" << formatPath(path.filename().string()) << "' ... "; }
-        data = loadJsonData(path);
+        data = takePrefetched(physicsScenesData, [&path]() { return readSceneFile(path, workerPool); });
     }
-    catch (std::exception e) {
+    catch (const std::exception& e) {
         if (debugMode) { std::cerr << formatError("FAILED") << "\n" << formatError("ERROR") << ": " << e.what(); }
         return;
     }
 
 
-    glm::vec3 orbitVector(0.0f, 1.0f, 0.0f);
+    const glm::dvec3 orbitVector = data.orbit;
     std::stringstream debugBuffer;
 
-    if (data.contains("ORBIT")) {
-        auto ORBIT = data["ORBIT"];
-        orbitVector = glm::vec3(
-          ORBIT[0].get<float>(),
-          ORBIT[1].get<float>(),
-          ORBIT[2].get<float>()  
-        );
+
+    for (const SceneEntry& sceneData : data.scenes) {
+        if (scene* currentScene = buildScene(sceneData, orbitVector, debugBuffer)) { registerScene(sceneData.name, currentScene); }
     }
 
+    if (fileWatcher) {
+        loadedScenes = std::move(data);
+        scenesRecorded = true;
+    }
 
-    
-    for (const auto& [sceneID, sceneData] : data.items()) {
-        if (sceneID == "ORBIT") { continue; }
+    handleDebugBuffer(debugBuffer);
+}
+
+
+// scenes converted by --convert-scenes - bodies are filled straight from the mapped columns, nothing is parsed
+void loadBinaryPhysicsScene(std::filesystem::path path) {
+    std::unique_ptr<BinarySceneFile> data;
+
+    try {
+        if (debugMode) { std::cout << formatProcess("\nLoading") << " objects from '" << formatPath(path.filename().string()) << "' ... "; }
+        data = std::make_unique<BinarySceneFile>(path);
+    }
+    catch (const std::exception& e) {
+        if (debugMode) { std::cerr << formatError("FAILED") << "\n" << formatError("ERROR") << ": " << e.what() << " ... " << formatProcess("Loading JSON") << std::endl; }
+        loadPhysicsScene(projectPath(physicsScenesPath));
+        return;
+    }
 
-        std::vector<SimObjectID> objectIDs;
-        std::unordered_map<SimObjectID, simulationObject*> objectCache;
-        
+
+    const glm::dvec3 orbitVector = data->orbit();
+    std::stringstream debugBuffer;
+
+    // object names are shared by all scenes of the file, each is looked up once
+    std::vector<SimObjectID> masters(data->stringCount());
+    for (uint32_t i = 0; i < masters.size(); ++i) { masters[i] = SimObjects.find(data->string(i)); }
+
+    for (size_t sceneIndex = 0; sceneIndex < data->sceneCount(); ++sceneIndex) {
+        BinarySceneView sceneData = data->scene(sceneIndex);
+        std::string sceneID(sceneData.name);
+
+        std::vector<SimObjectID> sceneMasters;
+        std::vector<bool> used(masters.size(), false);
+        for (uint32_t body = 0; body < sceneData.bodyCount; ++body) {
+            if (!used[sceneData.objects[body]]) { used[sceneData.objects[body]] = true; sceneMasters.push_back(masters[sceneData.objects[body]]); }
+        }
+
+        simulationObject* gravityWhell = getGravityWhell(sceneMasters);
 
         scene* currentScene = new scene();
+        currentScene->objects.reserve(sceneData.bodyCount);
 
+        std::vector<simulationObject*> bodies(sceneData.bodyCount, nullptr);
 
-        // gather object IDs beforehand for gravity whell calculations
-        for (const auto& simObject: sceneData["objects"]) {
-            if (!simObject.contains("object")) { continue; }
-            objectIDs.push_back(simObject["object"].get<std::string>());
+        for (uint32_t body = 0; body < sceneData.bodyCount; ++body) {
+            simulationObject* master = SimObjects[masters[sceneData.objects[body]]];
+            if (!master) {
+                debugBuffer << formatError("ERROR") << ": unknown object '" << colorText(std::string(data->string(sceneData.objects[body])), ANSII_MAGENTA) << "' in scene '" << sceneID << "' ... " << formatProcess("skipping") << std::endl;
+                continue;
+            }
+
+            simulationObject* simObject = currentScene->instantiate(*master);
+
+            simObject->position = sceneData.positions[body];
+            simObject->mass = sceneData.masses[body];
+            simObject->radius = sceneData.radii[body];
+            simObject->velocity = sceneData.hasVelocity(body) ? sceneData.velocities[body]
+                                : gravityWhell ? calcIdealOrbitVelocity(simObject, gravityWhell, orbitVector) : glm::dvec3(0.0);
+
+            simObject->setCurrentAsOriginal();
+
+            bodies[body] = simObject;
         }
 
-        simulationObject* gravityWhell = getGravityWhell(objectIDs);
+        currentScene->groups.reserve(sceneData.groupCount);
+        for (uint32_t group = 0; group < sceneData.groupCount; ++group) {
+            sceneGroup currentGroup;
+            currentGroup.reserve(sceneData.groupOffsets[group + 1] - sceneData.groupOffsets[group]);
+
+            for (uint32_t member = sceneData.groupOffsets[group]; member < sceneData.groupOffsets[group + 1]; ++member) {
+                if (simulationObject* object = bodies[sceneData.groupMembers[member]]) { currentGroup.push_back(object); }
+            }
+
+            currentScene->groups.push_back(std::move(currentGroup));
+        }
 
+        if (sceneData.catalogCount) {
+            simulationObject* attractor = nullptr; // the scene's instance of the gravity well
+            for (uint32_t body = 0; body < sceneData.bodyCount && !attractor; ++body) {
+                if (gravityWhell && bodies[body] && SimObjects[masters[sceneData.objects[body]]] == gravityWhell) { attractor = bodies[body]; }
+            }
+
+            for (uint32_t catalog = 0; catalog < sceneData.catalogCount; ++catalog) {
+                importCatalog(currentScene, attractor, std::string(data->string(sceneData.catalogs[2 * catalog])), std::string(data->string(sceneData.catalogs[2 * catalog + 1])), sceneID, debugBuffer);
+            }
+        }
+
+        registerScene(sceneID, currentScene);
+    }
+
+    handleDebugBuffer(debugBuffer);
+}
 
-        // --- OBJECTS --
-        if (!sceneData.contains("objects")) {
-            if (debugMode) { debugBuffer << formatError("ERROR") << ": could not find objects in scene '" << colorText(sceneID, ANSII_MAGENTA) << "' ... skipping\n"; }
+
+
+// -----------------===[ Hot Reload ]===-----------------
+
+
+
+// masters replaced by a reload - tile loads of paged catalogs may still read them, so they're only freed at cleanup
+std::vector<simulationObject*> replacedSimObjects;
+
+bool objectsReloadPending = false, scenesReloadPending = false;
+
+void requestSimulationReload(const bool& objects, const bool& scenes) {
+    objectsReloadPending |= objects;
+    scenesReloadPending |= scenes;
+}
+
+// a reload that reloadSimulationFiles would act on right now
+bool simulationReloadPending() {
+    return (objectsReloadPending || scenesReloadPending) && !sceneLoad.active;
+}
+
+// pairs (body in to, body in from) whose start didn't change - reads only names and starting state, so it runs without the physics lock
+std::vector<std::pair<size_t, size_t>> matchSimulatedState(const scene* from, const scene* to) {
+    std::vector<std::pair<size_t, size_t>> matches;
+    std::vector<bool> taken(from->pagedObjectsBegin, false);
+
+    // catalogs loaded into memory put 10^5+ bodies here - matched through a name index, not body against body
+    std::unordered_map<std::string_view, std::vector<size_t>> byName;
+
+    for (size_t i = 0; i < to->pagedObjectsBegin; ++i) {
+        const simulationObject* target = to->objects[i];
+
+        // most bodies keep their place in the file
+        if (i < from->pagedObjectsBegin && !taken[i] && target->startsLike(*from->objects[i])) {
+            matches.emplace_back(i, i);
+            taken[i] = true;
             continue;
         }
-        for (const auto& objectData : sceneData["objects"]) {
 
-            SimObjectID objectID;
-            assignValue<SimObjectID>("", objectID, objectData, "object");
-            
-            simulationObject* simObject = new simulationObject(*SimObjects[objectID], true); // creates a derived model
+        if (byName.empty()) {
+            for (size_t j = 0; j < from->pagedObjectsBegin; ++j) { byName[from->objects[j]->name].push_back(j); }
+        }
 
+        auto candidates = byName.find(target->name);
+        if (candidates == byName.end()) { continue; }
 
-            assignValue<glm::dvec3, Json>(objectID, simObject->position, objectData, "position", 
-                [&](glm::dvec3& dest, const Json& src) {
-                    dest = {
-                        src[0].get<double>(),
-                        src[1].get<double>(),
-                        src[2].get<double>()
-                    };
-                }
-            );
-
-            // ToDO: clean up somehow
-            glm::dvec3 idealVelocity = calcIdealOrbitVelocity(simObject, gravityWhell, orbitVector);
-            assignValue<glm::dvec3, Json>(objectID, simObject->velocity, objectData, "velocity", 
-                [&](glm::dvec3& dest, const Json& src) {
-                    dest = {
-                        src[0].get<double>(),
-                        src[1].get<double>(),
-                        src[2].get<double>()
-                    };
-                },
-                (std::optional<Json>)(Json){idealVelocity.x, idealVelocity.y, idealVelocity.z},
-                &debugBuffer
-            );
+        for (const size_t& j : candidates->second) {
+            if (taken[j] || !target->startsLike(*from->objects[j])) { continue; }
 
-            simObject->setCurrentAsOriginal();
+            matches.emplace_back(i, j);
+            taken[j] = true;
+            break;
+        }
+    }
+
+    return matches;
+}
+
+// bodies whose start didn't change keep the state they were simulated to; everything else starts over - call with physicsMutex locked
+void carrySimulatedState(const scene* from, scene* to, const std::vector<std::pair<size_t, size_t>>& matches) {
+    for (const auto& [i, j] : matches) {
+        simulationObject* target = to->objects[i];
+        const simulationObject* source = from->objects[j];
+
+        target->position = source->position;
+        target->velocity = source->velocity;
+        target->acceleration = source->acceleration;
+        target->firstPass = source->firstPass;
+        target->vertPosition = target->previousVertPosition = target->position / (simulationMode == simulationType::simplified ? target->distanceScale : currentScale);
+    }
+
+    to->simulatedTime = from->simulatedTime;
+}
+
+/**
+ * @brief Puts a rebuilt scene in place of the one registered under its name.
+ *
+ * The handle stays the same. If it's the active scene the new one is prepared right away and swapped in under the
+ * physics lock with the simulated state carried over - the physics thread sees another scene behind the same ID and
+ * snapshots it afresh on its next step, so no step writes into the old objects.
+ */
+void replaceScene(const std::string& sceneID, scene* rebuilt) {
+    scene* previous = Scenes::allScenes[Scenes::allScenes.find(sceneID)];
+
+    registerScene(sceneID, rebuilt);
+    SceneID handle = Scenes::allScenes.find(sceneID);
+    sceneCache.forget(handle);
+
+    if (!previous) { return; }
+
+    if (previous == Scenes::currentScene) {
+        setupSceneObjects(handle);
+
+        // the lock only covers copying the state and the swap
+        std::vector<std::pair<size_t, size_t>> matches = matchSimulatedState(previous, rebuilt);
+
+        std::lock_guard<std::mutex> lock(physicsMutex);
+
+        carrySimulatedState(previous, rebuilt, matches);
+        rebuilt->layoutVersion = previous->layoutVersion + 1;
+        Scenes::switchScene(handle);
+    }
+
+    delete previous;
+}
+
+/**
+ * @brief Applies saved objects.json / scenes.json changes (requested by handleFileChanges) - main thread, called every frame.
+ *
+ * The files are diffed against the records they were loaded from: only objects whose entry changed get a new master,
+ * and only scenes whose entry changed (or that use a changed object) are rebuilt - models and shaders stay as they are.
+ * Waits while a scene switch is running, since the switch may be preparing a scene on a worker.
+ */
+void reloadSimulationFiles() {
+    if ((!objectsReloadPending && !scenesReloadPending) || sceneLoad.active) { return; }
+
+    auto start = steady_clock::now();
+    std::stringstream debugBuffer;
 
-            objectCache[objectID] = simObject;
-            currentScene->objects.push_back(simObject);
+    bool readScenes = scenesReloadPending;
+    if (debugMode) { std::cout << formatProcess("\nReloading") << " simulation files ... "; }
+
+    // --- OBJECTS ---
+    std::vector<std::string> changedObjects; // replaced, added or removed - every scene using one is rebuilt
+
+    if (objectsReloadPending) {
+        objectsReloadPending = false;
+
+        ObjectFile data;
+        try { data = readObjectFile(projectPath(simObjectsConfigPath)); }
+        catch (const std::exception& e) {
+            if (debugMode) { std::cerr << formatError("FAILED") << "\n" << formatError("ERROR") << ": " << e.what() << " - keeping the loaded objects" << std::endl; }
+            data = loadedObjects;
         }
 
+        auto findEntry = [](const ObjectFile& file, const std::string& name) -> const ObjectEntry* {
+            auto found = std::find_if(file.objects.begin(), file.objects.end(), [&name](const ObjectEntry& entry) { return entry.name == name; });
+            return found != file.objects.end() ? &*found : nullptr;
+        };
 
-        // --- GROUPS ---
-        if (!sceneData.contains("groups")) {
-            if (debugMode) { debugBuffer << formatError("ERROR") << ": could not find sim groups in scene '" << colorText(sceneID, ANSII_MAGENTA) << "' ... skipping\n"; }
-            continue;
+        // a replaced master keeps its handle, one that can't be made anymore is removed
+        auto replace = [](const std::string& name, simulationObject* simObject) {
+            SimObjectID handle = SimObjects.find(name);
+            if (simulationObject* previous = SimObjects[handle]) { replacedSimObjects.push_back(previous); }
+
+            if (simObject) { SimObjects.add(name, simObject); }
+            else { SimObjects.erase(handle); }
+        };
+
+        for (const ObjectEntry& object : data.objects) {
+            const ObjectEntry* previous = findEntry(loadedObjects, object.name);
+            if (previous && *previous == object) { continue; }
+
+            replace(object.name, createSimObject(object, debugBuffer));
+            changedObjects.push_back(object.name);
         }
-        for (const auto& group : sceneData["groups"]) {
-            sceneGroup currentGroup;
 
-            for (const auto& member : group) {
-                currentGroup.push_back(objectCache[member.get<std::string>()]);
-            }
+        for (const ObjectEntry& object : loadedObjects.objects) {
+            if (findEntry(data, object.name)) { continue; }
 
-            currentScene->groups.push_back(currentGroup);
+            replace(object.name, nullptr);
+            changedObjects.push_back(object.name);
         }
 
-        // sort by distance from origin
-        std::sort(currentScene->objects.begin(), currentScene->objects.end(), 
-            [](simulationObject* a, simulationObject* b){
-                static glm::dvec3 origin = {0.0, 0.0, 0.0};
-                if (a->position == b->position) { return true; }
-                double distA = glm::distance(origin, a->position), distB = glm::distance(origin, a->position);
+        loadedObjects = std::move(data);
 
-                return distA > distB;
+        if (!changedObjects.empty() && !scenesRecorded) { readScenes = true; } // nothing to rebuild the scenes from otherwise
+    }
+
+    // --- SCENES ---
+    size_t rebuiltScenes = 0, removedScenes = 0;
+
+    if (readScenes || !changedObjects.empty()) {
+        scenesReloadPending = false;
+
+        SceneFile data;
+        bool read = true;
+        if (readScenes) {
+            try { data = readSceneFile(projectPath(physicsScenesPath), workerPool); }
+            catch (const std::exception& e) {
+                debugBuffer << formatError("ERROR") << ": " << e.what() << " - keeping the loaded scenes\n";
+                read = false;
             }
-        );
+        }
+        else { data = loadedScenes; }
+
+        if (read) {
+            auto findEntry = [](const SceneFile& file, const std::string& name) -> const SceneEntry* {
+                auto found = std::find_if(file.scenes.begin(), file.scenes.end(), [&name](const SceneEntry& entry) { return entry.name == name; });
+                return found != file.scenes.end() ? &*found : nullptr;
+            };
 
-        Scenes::allScenes[sceneID] = currentScene;
+            auto usesChanged = [&changedObjects](const SceneEntry& entry) {
+                auto changed = [&changedObjects](const std::string& name) { return std::find(changedObjects.begin(), changedObjects.end(), name) != changedObjects.end(); };
+                return std::any_of(entry.names.begin(), entry.names.end(), changed)
+                    || std::any_of(entry.catalogs.begin(), entry.catalogs.end(), [&changed](const CatalogEntry& catalog) { return changed(catalog.object); });
+            };
+
+            bool orbitChanged = !scenesRecorded || data.orbit != loadedScenes.orbit; // bodies without a velocity are put on orbits along it
+
+            for (const SceneEntry& entry : data.scenes) {
+                const SceneEntry* previous = scenesRecorded ? findEntry(loadedScenes, entry.name) : nullptr;
+                if (previous && *previous == entry && !orbitChanged && !usesChanged(entry)) { continue; }
+
+                scene* rebuilt = buildScene(entry, data.orbit, debugBuffer);
+                if (!rebuilt) {
+                    if (Scenes::allScenes.contains(entry.name)) { debugBuffer << formatWarning("WARNING") << ": keeping the loaded version of scene '" << colorText(entry.name, ANSII_MAGENTA) << "'\n"; }
+                    continue;
+                }
+
+                replaceScene(entry.name, rebuilt);
+                rebuiltScenes++;
+            }
+
+            // scenes gone from the file - the one on screen stays until another is picked and the file is saved again
+            std::vector<std::string> removed;
+            for (const auto& [sceneID, registered] : Scenes::allScenes) {
+                const std::string& name = Scenes::allScenes.name(sceneID);
+                if (!findEntry(data, name) && registered != Scenes::currentScene) { removed.push_back(name); }
+            }
+            for (const std::string& name : removed) {
+                SceneID handle = Scenes::allScenes.find(name);
+                sceneCache.forget(handle);
+                delete Scenes::allScenes[handle];
+                Scenes::allScenes.erase(handle);
+                removedScenes++;
+            }
+
+            loadedScenes = std::move(data);
+            scenesRecorded = true;
+        }
     }
-    
+
     handleDebugBuffer(debugBuffer);
+
+    if (debugMode) {
+        std::cout << formatProcess("Reloaded") << " " << changedObjects.size() << " objects, " << rebuiltScenes << " scenes rebuilt, " << removedScenes << " removed in "
+                  << duration<double, std::milli>(steady_clock::now() - start).count() << " ms" << std::endl;
+    }
+}
+
+
+
+// -----------------===[ Scene Conversion ]===-----------------
+
+
+
+// output path of '--convert-scenes [output]', empty if not converting
+std::filesystem::path sceneConversionOutput;
+
+void parseSceneConversionArguments(int argc, char** argv) {
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--convert-scenes") != 0) { continue; }
+
+        sceneConversionOutput = projectPath(physicsScenesBinaryPath);
+        if (i + 1 < argc && argv[i + 1][0] != '-') { sceneConversionOutput = argv[i + 1]; }
+    }
+}
+
+// writes scenes.json (with objects.json resolved) as a binary scene file, then reads it back and compares - runs before the window opens
+bool convertScenes() {
+    std::filesystem::path scenesPath = projectPath(physicsScenesPath);
+    std::filesystem::path objectsPath = projectPath(simObjectsConfigPath);
+
+    std::cout << formatProcess("Converting") << " '" << formatPath(scenesPath.filename().string()) << "' and '" << formatPath(objectsPath.filename().string())
+              << "' to '" << formatPath(sceneConversionOutput.string()) << "' ... " << std::flush;
+
+    ThreadPool pool;
+    std::vector<std::string> skipped;
+    BinarySceneSet converted;
+
+    try {
+        auto objects = pool.submit([&objectsPath]() { return readObjectFile(objectsPath); });
+        SceneFile scenes = readSceneFile(scenesPath, &pool);
+
+        converted = convertSceneRecords(pool.await(objects), scenes, skipped);
+        writeBinaryScenes(sceneConversionOutput, converted);
+    }
+    catch (const std::exception& e) {
+        std::cerr << formatError("FAILED") << "\n" << formatError("ERROR") << ": " << e.what() << std::endl;
+        return false;
+    }
+
+    // round trip - everything has to read back exactly as it was converted
+    std::string difference;
+    try { difference = compareBinaryScenes(BinarySceneFile(sceneConversionOutput), converted); }
+    catch (const std::exception& e) { difference = e.what(); }
+
+    if (!difference.empty()) {
+        std::cerr << formatError("FAILED") << "\n" << formatError("ERROR") << ": the written file doesn't read back - " << difference << std::endl;
+        return false;
+    }
+
+    size_t bodies = 0;
+    for (const BinarySceneData& scene : converted.scenes) { bodies += scene.objects.size(); }
+
+    std::cout << (skipped.empty() ? formatSuccess("Done") : formatWarning("Done with exceptions")) << "\n";
+    for (const std::string& reason : skipped) { std::cout << formatWarning("WARNING") << ": left out " << reason << "\n"; }
+    std::cout << formatRole("scenes") << " " << converted.scenes.size() << " | " << formatRole("bodies") << " " << bodies
+              << " | " << std::filesystem::file_size(sceneConversionOutput) / 1024 << " KiB" << std::endl;
+
+    return true;
 }
@@ -18,11 +18,16 @@
 #include <scenes.hpp>
 
 #include <physicsThread.hpp>
+#include <threadPool.hpp>
+#include <algorithm>
+#include <future>
 #include <unistd.h>
 #include <vector>
 
 void advanceObjectPosition(SnapObj* simObject, glm::dvec3 newAcceleration);
 glm::dvec3 calcGravVelocity(const SnapObj* currentObject, const std::vector<SnapObj*>& group);
+glm::dvec3 gravityFrom(const SnapObj* currentObject, const SnapObj* source);
+void advanceTestParticles(const SnapTestParticleGroup& group);
 void simulateStep(Snapshot* snapshot);
 
 
@@ -33,14 +38,25 @@ void physicsThreadFunction() {
     using namespace std::chrono;
     bool wasPaused = false;
 
-    physicsDeltaTime = 1.0 / (double)physicsSteps;
-
     auto previousTime = steady_clock::now();
     double accumulator = 0.0;
 
     while (physicsRunning) {
 
-        if (pausePhysicsThread) { std::this_thread::sleep_for(chrono::microseconds(100)); wasPaused = true; continue; }
+        // physicsSteps can change with a settings reload - only this thread writes physicsDeltaTime, the renderer reads it under the lock
+        {
+            std::lock_guard<std::mutex> lock(physicsMutex);
+            if (physicsSteps > 0.0f) { physicsDeltaTime = 1.0 / (double)physicsSteps; }
+        }
+
+        // sleeps while paused - woken by transitionState, the timeout only covers a wake-up that came right before the wait
+        if (pausePhysicsThread) {
+            std::unique_lock<std::mutex> lock(physicsMutex);
+            physicsCV.wait_for(lock, milliseconds(10), []() { return !pausePhysicsThread || !physicsRunning; });
+
+            wasPaused = true;
+            continue;
+        }
         else if (wasPaused) { previousTime = steady_clock::now(); wasPaused = false; }
 
         auto currentTime = steady_clock::now();
@@ -55,6 +71,9 @@ void physicsThreadFunction() {
             simulateStep(snapshot); // advance simulation by one fixed physics step (physicsDeltaTime)
             accumulator -= physicsDeltaTime; // consume one physics step's worth of accumulated time
 
+            // the leftover time is how far past this state we already are - the renderer interpolates from it
+            snapshot->stateTime = currentTime - duration_cast<steady_clock::duration>(duration<double>(accumulator));
+
             snapshot->updateOrigin();
         }
 
@@ -67,6 +86,9 @@ void physicsThreadFunction() {
 // Master Simulation Step Function
 void simulateStep(Snapshot* snapshot) {
 
+    // before the early return - a step that doesn't move anything still publishes a state, which mustn't blend from an older one
+    for (const auto& [snapObj, obj] : snapshot->objects) { snapObj->previousVertPosition = snapObj->vertPosition; }
+
     if (deltaTime == 0.0) { return; }
 
     for (int step = 0; step < phyiscsSubsteps; step++) {
@@ -78,7 +100,33 @@ void simulateStep(Snapshot* snapshot) {
                 advanceObjectPosition(simObject, newAcceleration);
             }
         }
+
+        for (const auto& testGroup : snapshot->testParticles) { advanceTestParticles(testGroup); }
+    }
+
+    snapshot->steppedSeconds += physicsDeltaTime * simulationSpeed;
+}
+
+// every particle only feels its attractor, so large catalogs are split over the worker pool
+void advanceTestParticles(const SnapTestParticleGroup& group) {
+    const size_t chunkSize = 16'384;
+
+    auto advanceRange = [&group](const size_t& begin, const size_t& end) {
+        for (size_t i = begin; i < end; ++i) {
+            SnapObj* particle = group.particles[i];
+            if (!particle->simulate) { continue; }
+
+            advanceObjectPosition(particle, group.attractor->simulate ? gravityFrom(particle, group.attractor) : glm::dvec3(0.0));
+        }
+    };
+
+    if (!workerPool) {
+        advanceRange(0, group.particles.size());
+        return;
     }
+
+    // not submit() + await() - the physics thread would end up running whatever else is queued (scene preparation, tile loads)
+    workerPool->parallelFor(group.particles.size(), chunkSize, advanceRange);
 }
 
 // -----------------===[ Helper Functions ]===-----------------
@@ -116,19 +164,24 @@ glm::dvec3 calcGravVelocity(const SnapObj* currentObject, const std::vector<Snap
         if (!simObject->simulate) { continue; } // remove non-simulated object's influence
 
         if (currentObject == simObject) { continue; } // Skip self-gravity
-        if (currentObject->position == simObject->position) { continue; } // skip distane calculation errors (inf)
-        
-        // Get distance in simulation units and convert to meters
-        units::meters distance = glm::distance(currentObject->position, simObject->position) * 1'000.0;
-        units::kilograms comparisonObjectMass = units::manual_cast<units::kilograms>(simObject->mass, 1'000.0);
-        
-        double gravitationalAcceleration = GRAVITATIONAL_CONSTANT * (comparisonObjectMass) / (double)(distance * distance);
 
-        glm::dvec3 direction = glm::normalize(simObject->position - currentObject->position);
-        
-        glm::dvec3 gravPullAcceleration = direction * (gravitationalAcceleration / 1'000.0);
-        fullGravPullAcceleration += gravPullAcceleration;
+        fullGravPullAcceleration += gravityFrom(currentObject, simObject);
     }
 
     return fullGravPullAcceleration;
 }
+
+// acceleration (km/s²) the source's gravity gives the object
+glm::dvec3 gravityFrom(const SnapObj* currentObject, const SnapObj* source) {
+    if (currentObject->position == source->position) { return glm::dvec3(0.0); } // skip distane calculation errors (inf)
+
+    // Get distance in simulation units and convert to meters
+    units::meters distance = glm::distance(currentObject->position, source->position) * 1'000.0;
+    units::kilograms comparisonObjectMass = units::manual_cast<units::kilograms>(source->mass, 1'000.0);
+
+    double gravitationalAcceleration = GRAVITATIONAL_CONSTANT * (comparisonObjectMass) / (double)(distance * distance);
+
+    glm::dvec3 direction = glm::normalize(source->position - currentObject->position);
+
+    return direction * (gravitationalAcceleration / 1'000.0);
+}